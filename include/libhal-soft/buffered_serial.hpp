@@ -0,0 +1,142 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include <libhal/serial.hpp>
+
+namespace hal::soft {
+/**
+ * @brief A serial wrapper that pulls received bytes into a ring buffer and
+ * lets parsers inspect them in place.
+ *
+ * Bytes are read from the underlying serial port in as few calls as possible,
+ * directly into the caller-provided ring buffer. Parsers can then work on the
+ * buffered bytes through peek(), consume() and read_until() without copying
+ * them out byte by byte. buffered_serial is also a hal::serial, so it can be
+ * handed to code that only knows about the interface.
+ */
+class buffered_serial : public hal::serial
+{
+public:
+  /**
+   * @brief The buffered bytes as at most two contiguous spans
+   *
+   * Bytes in `first` come before bytes in `second`. `second` is only non-empty
+   * when the buffered bytes wrap around the end of the ring buffer.
+   */
+  struct peek_t
+  {
+    std::span<const hal::byte> first;
+    std::span<const hal::byte> second;
+
+    /**
+     * @brief Get the total number of bytes across both spans
+     *
+     * @return std::size_t - total number of bytes
+     */
+    [[nodiscard]] constexpr std::size_t size() const
+    {
+      return first.size() + second.size();
+    }
+  };
+
+  /**
+   * @brief Factory function to create a buffered_serial object
+   *
+   * @param p_serial - serial port to buffer
+   * @param p_buffer - ring buffer storage. Its size must be a power of two. The
+   * buffer must outlive the buffered_serial object.
+   * @return result<buffered_serial> - the constructed buffered_serial object
+   * @throws std::errc::invalid_argument - if the size of p_buffer is not a
+   * power of two
+   */
+  static result<buffered_serial> create(hal::serial& p_serial,
+                                        std::span<hal::byte> p_buffer);
+
+  /**
+   * @brief Pull any bytes the serial port has received into the ring buffer
+   *
+   * @return result<std::size_t> - number of bytes now buffered
+   */
+  result<std::size_t> fill();
+
+  /**
+   * @brief Get the buffered bytes without consuming them
+   *
+   * Calls fill() before returning the buffered bytes.
+   *
+   * @return result<peek_t> - spans over the buffered bytes. The spans are
+   * valid until the next call that consumes bytes.
+   */
+  result<peek_t> peek();
+
+  /**
+   * @brief Discard bytes from the front of the ring buffer
+   *
+   * @param p_count - number of bytes to discard. Values larger than the number
+   * of buffered bytes discard all buffered bytes.
+   */
+  void consume(std::size_t p_count);
+
+  /**
+   * @brief Consume the buffered bytes up to and including a delimiter
+   *
+   * Calls fill() before searching for the delimiter. If the delimiter is not
+   * buffered, nothing is consumed and an empty peek_t is returned.
+   *
+   * @param p_delimiter - byte that terminates the sequence
+   * @return result<peek_t> - spans over the consumed bytes, including the
+   * delimiter. The spans are valid until the next call to fill(), peek(),
+   * read() or read_until().
+   * @throws std::errc::no_buffer_space - if the ring buffer is full and holds
+   * no delimiter, so the sequence is longer than the buffer. Nothing is
+   * consumed; use consume() or flush() to discard the bytes.
+   */
+  result<peek_t> read_until(hal::byte p_delimiter);
+
+  /**
+   * @brief Get the number of buffered bytes without reading the serial port
+   *
+   * @return std::size_t - number of buffered bytes
+   */
+  [[nodiscard]] std::size_t size() const;
+
+  /**
+   * @brief Get the capacity of the ring buffer
+   *
+   * @return std::size_t - capacity in bytes
+   */
+  [[nodiscard]] std::size_t capacity() const;
+
+private:
+  buffered_serial(hal::serial& p_serial, std::span<hal::byte> p_buffer);
+
+  status driver_configure(const settings& p_settings) override;
+  result<write_t> driver_write(std::span<const hal::byte> p_data) override;
+  result<read_t> driver_read(std::span<hal::byte> p_data) override;
+  result<flush_t> driver_flush() override;
+
+  peek_t buffered(std::size_t p_count) const;
+
+  hal::serial* m_serial;
+  std::span<hal::byte> m_buffer;
+  /// Free running counters, masked with m_buffer.size() - 1 to index
+  std::size_t m_head = 0;
+  std::size_t m_tail = 0;
+};
+}  // namespace hal::soft
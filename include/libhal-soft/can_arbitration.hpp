@@ -0,0 +1,47 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include <libhal/can.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Bits of the arbitration field in the order they go on the wire
+ *
+ * A dominant bit is 0, so the frame with the smallest key wins arbitration.
+ * A standard frame sends its 11-bit ID, RTR and IDE = 0. An extended frame
+ * sends the upper 11 bits of its ID as the base ID, SRR = 1 and IDE = 1, then
+ * the lower 18 bits and RTR. A standard frame therefore beats every extended
+ * frame with the same base ID, and a data frame beats a remote frame with the
+ * same ID. IDs above 0x7FF are treated as extended IDs.
+ *
+ * @param p_message - message to rank
+ * @return constexpr std::uint32_t - key that orders messages like the bus
+ */
+constexpr std::uint32_t can_arbitration_key(
+  const hal::can::message_t& p_message)
+{
+  constexpr std::uint32_t max_standard_id = 0x7FF;
+  const std::uint32_t remote = p_message.is_remote_request ? 1 : 0;
+  if (p_message.id <= max_standard_id) {
+    return (p_message.id << 21) | (remote << 20);
+  }
+  const auto base = (p_message.id >> 18) & max_standard_id;
+  const auto extension = p_message.id & 0x3FFFF;
+  return (base << 21) | (1U << 20) | (1U << 19) | (extension << 1) | remote;
+}
+}  // namespace hal::soft
@@ -0,0 +1,297 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include <libhal/can.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Dispatches received CAN messages to per-ID handlers in constant time
+ *
+ * Routes are stored in a fixed size, open addressing hash table keyed by
+ * message ID. An ID/mask route is expanded into one table entry per matching
+ * ID when it is added, so every lookup in the receive interrupt is a multiply,
+ * a shift and a bounded number of probes, no matter how routes were added.
+ * Messages without a route are counted and ignored.
+ *
+ * The router registers itself as the receive handler of the CAN bus it is
+ * created with, and registers itself again whenever it is moved. Destroying
+ * the router replaces its handler with one that ignores every message.
+ *
+ * @tparam RouteCount - maximum number of handlers
+ * @tparam TableSize - number of hash table entries. Must be a power of two.
+ * Every ID covered by a route takes one entry, so mask routes need room for
+ * all of the IDs they match.
+ */
+template<std::size_t RouteCount, std::size_t TableSize = 2 * RouteCount>
+class can_router
+{
+public:
+  static_assert(std::has_single_bit(TableSize),
+                "TableSize must be a power of two");
+  static_assert(RouteCount < std::numeric_limits<std::uint16_t>::max(),
+                "RouteCount is too large");
+
+  /// Largest standard (11-bit) message ID
+  static constexpr hal::can::id_t max_standard_id = 0x7FF;
+  /// Largest extended (29-bit) message ID
+  static constexpr hal::can::id_t max_extended_id = 0x1FFF'FFFF;
+
+  /**
+   * @brief Factory function to create a can_router object
+   *
+   * @param p_can - CAN bus whose received messages should be routed
+   * @return result<can_router> - the constructed can_router object
+   */
+  static result<can_router> create(hal::can& p_can)
+  {
+    return can_router(p_can);
+  }
+
+  can_router(can_router&& p_other) noexcept
+    : m_can(p_other.m_can)
+    , m_table(p_other.m_table)
+    , m_handlers(std::move(p_other.m_handlers))
+    , m_handler_count(p_other.m_handler_count)
+    , m_entry_count(p_other.m_entry_count)
+    , m_max_probe(p_other.m_max_probe)
+    , m_unrouted(p_other.m_unrouted)
+  {
+    p_other.m_attached = false;
+    attach();
+  }
+
+  can_router& operator=(can_router&& p_other) noexcept
+  {
+    detach();
+    p_other.m_attached = false;
+    m_can = p_other.m_can;
+    m_table = p_other.m_table;
+    m_handlers = std::move(p_other.m_handlers);
+    m_handler_count = p_other.m_handler_count;
+    m_entry_count = p_other.m_entry_count;
+    m_max_probe = p_other.m_max_probe;
+    m_unrouted = p_other.m_unrouted;
+    attach();
+    return *this;
+  }
+
+  can_router(const can_router&) = delete;
+  can_router& operator=(const can_router&) = delete;
+
+  ~can_router()
+  {
+    detach();
+  }
+
+  /**
+   * @brief Route messages with a specific ID to a handler
+   *
+   * @param p_id - message ID to route
+   * @param p_handler - handler called from the receive interrupt
+   * @return status - success or an error
+   * @throws std::errc::no_buffer_space - if there are no handler slots or
+   * table entries left
+   * @throws std::errc::device_or_resource_busy - if the ID already has a route
+   */
+  status add_route(hal::can::id_t p_id,
+                   hal::callback<hal::can::handler> p_handler)
+  {
+    return add_route(
+      p_id, std::numeric_limits<hal::can::id_t>::max(), p_handler);
+  }
+
+  /**
+   * @brief Route every message whose ID matches an ID/mask pair to a handler
+   *
+   * A message matches if `(message.id & p_mask) == (p_id & p_mask)`. IDs up to
+   * max_standard_id are treated as standard IDs, so their mask only spans the
+   * 11 standard ID bits. Routes are added all or nothing.
+   *
+   * @param p_id - message ID to match
+   * @param p_mask - bits of the message ID that must match
+   * @param p_handler - handler called from the receive interrupt
+   * @return status - success or an error
+   * @throws std::errc::no_buffer_space - if there are no handler slots left or
+   * too few table entries for every ID the mask matches
+   * @throws std::errc::device_or_resource_busy - if any matching ID already
+   * has a route
+   */
+  status add_route(hal::can::id_t p_id,
+                   hal::can::id_t p_mask,
+                   hal::callback<hal::can::handler> p_handler)
+  {
+    const auto id_space =
+      (p_id <= max_standard_id) ? max_standard_id : max_extended_id;
+    const auto dont_care = ~p_mask & id_space;
+    const auto base = p_id & p_mask & id_space;
+    const auto id_count = std::size_t{ 1 } << std::popcount(dont_care);
+
+    if (m_handler_count == RouteCount ||
+        id_count > TableSize - m_entry_count) {
+      return hal::new_error(std::errc::no_buffer_space);
+    }
+
+    // Walk every subset of the don't care bits: once to check for conflicts,
+    // then again to insert, so a failed route leaves the table untouched.
+    hal::can::id_t subset = 0;
+    do {
+      if (find(base | subset) != nullptr) {
+        return hal::new_error(std::errc::device_or_resource_busy);
+      }
+      subset = (subset - dont_care) & dont_care;
+    } while (subset != 0);
+
+    const auto handler = static_cast<std::uint16_t>(m_handler_count++);
+    m_handlers[handler] = p_handler;
+    do {
+      insert(base | subset, handler);
+      subset = (subset - dont_care) & dont_care;
+    } while (subset != 0);
+
+    return hal::success();
+  }
+
+  /**
+   * @brief Dispatch a message to the handler routed to its ID
+   *
+   * Called automatically for every message received on the bus. It can also
+   * be called directly, for example to route messages from another source.
+   *
+   * @param p_message - message to dispatch
+   */
+  void operator()(const hal::can::message_t& p_message)
+  {
+    const auto* route = find(p_message.id);
+    if (route == nullptr) {
+      m_unrouted++;
+      return;
+    }
+    m_handlers[route->handler](p_message);
+  }
+
+  /**
+   * @brief Get the number of received messages that had no route
+   *
+   * @return std::size_t - number of unrouted messages
+   */
+  [[nodiscard]] std::size_t unrouted_messages() const
+  {
+    return m_unrouted;
+  }
+
+  /**
+   * @brief Get the CAN bus this router receives from
+   *
+   * @return hal::can& - the CAN bus
+   */
+  hal::can& bus()
+  {
+    return *m_can;
+  }
+
+private:
+  static constexpr auto empty_slot = std::numeric_limits<std::uint16_t>::max();
+
+  struct entry
+  {
+    hal::can::id_t id = 0;
+    std::uint16_t handler = empty_slot;
+  };
+
+  explicit can_router(hal::can& p_can)
+    : m_can(&p_can)
+  {
+    attach();
+  }
+
+  void attach()
+  {
+    m_can->on_receive(
+      [this](const hal::can::message_t& p_message) { (*this)(p_message); });
+    m_attached = true;
+  }
+
+  /// Stop the bus from calling this router, unless a move took it over
+  void detach()
+  {
+    if (m_attached) {
+      m_can->on_receive(
+        []([[maybe_unused]] const hal::can::message_t& p_message) {});
+      m_attached = false;
+    }
+  }
+
+  static constexpr std::size_t home_slot(hal::can::id_t p_id)
+  {
+    // Fibonacci hashing: the multiply spreads neighbouring IDs apart and the
+    // top bits of the product select the slot.
+    constexpr auto table_bits = std::countr_zero(TableSize);
+    if constexpr (table_bits == 0) {
+      return 0;
+    } else {
+      const std::uint32_t product = p_id * 0x9E37'79B1U;
+      return product >> (32 - table_bits);
+    }
+  }
+
+  const entry* find(hal::can::id_t p_id) const
+  {
+    const auto home = home_slot(p_id);
+    for (std::size_t probe = 0; probe <= m_max_probe; probe++) {
+      const auto& candidate = m_table[(home + probe) & (TableSize - 1)];
+      if (candidate.handler == empty_slot) {
+        return nullptr;
+      }
+      if (candidate.id == p_id) {
+        return &candidate;
+      }
+    }
+    return nullptr;
+  }
+
+  void insert(hal::can::id_t p_id, std::uint16_t p_handler)
+  {
+    const auto home = home_slot(p_id);
+    for (std::size_t probe = 0; probe < TableSize; probe++) {
+      auto& candidate = m_table[(home + probe) & (TableSize - 1)];
+      if (candidate.handler == empty_slot) {
+        candidate = entry{ .id = p_id, .handler = p_handler };
+        m_entry_count++;
+        m_max_probe = std::max(m_max_probe, probe);
+        return;
+      }
+    }
+  }
+
+  hal::can* m_can;
+  std::array<entry, TableSize> m_table{};
+  std::array<hal::callback<hal::can::handler>, RouteCount> m_handlers{};
+  std::size_t m_handler_count = 0;
+  std::size_t m_entry_count = 0;
+  std::size_t m_max_probe = 0;
+  std::size_t m_unrouted = 0;
+  /// False once moved from, so the destructor leaves the bus alone
+  bool m_attached = false;
+};
+}  // namespace hal::soft
@@ -0,0 +1,145 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include <libhal/can.hpp>
+#include <libhal/timer.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+/**
+ * @brief CAN bus wrapper that queues outgoing messages by priority
+ *
+ * send() places the message in a fixed capacity queue in the order the
+ * messages would win arbitration on the bus, see can_arbitration_key(), then
+ * hands as many queued messages to the wrapped bus as it accepts. A message
+ * the bus rejects, for example because every hardware mailbox is full, stays
+ * queued. It is retried on the next call to transmit(), which can be called
+ * from a transmit complete interrupt, or which a retry timer can call on a
+ * fixed period. Messages with the same arbitration key leave the queue in the
+ * order they were sent.
+ *
+ * send_latest() replaces a still queued message with the same ID instead of
+ * queuing both, so periodic status messages never queue stale values.
+ *
+ * The queue is not protected against concurrent access: send() and
+ * transmit() must not preempt each other. The object must not be moved while
+ * messages are queued with a retry timer. Destroying it cancels the retry
+ * timer.
+ */
+class can_tx_queue : public hal::can
+{
+public:
+  /**
+   * @brief Factory function to create a can_tx_queue object
+   *
+   * Queued messages are only retried when transmit() is called.
+   *
+   * @param p_can - CAN bus to send queued messages on
+   * @param p_storage - storage for queued messages. Its size is the queue
+   * capacity. Must outlive the can_tx_queue object.
+   * @return result<can_tx_queue> - the constructed can_tx_queue object
+   * @throws std::errc::invalid_argument - if p_storage is empty
+   */
+  static result<can_tx_queue> create(hal::can& p_can,
+                                     std::span<message_t> p_storage);
+
+  /**
+   * @brief Factory function to create a can_tx_queue object that retries
+   * queued messages from a timer
+   *
+   * @param p_can - CAN bus to send queued messages on
+   * @param p_storage - storage for queued messages. Its size is the queue
+   * capacity. Must outlive the can_tx_queue object.
+   * @param p_retry_timer - timer scheduled to call transmit() while messages
+   * are queued
+   * @param p_retry_period - time between retries
+   * @return result<can_tx_queue> - the constructed can_tx_queue object
+   * @throws std::errc::invalid_argument - if p_storage is empty
+   */
+  static result<can_tx_queue> create(hal::can& p_can,
+                                     std::span<message_t> p_storage,
+                                     hal::timer& p_retry_timer,
+                                     hal::time_duration p_retry_period);
+
+  can_tx_queue(can_tx_queue&& p_other) noexcept;
+  can_tx_queue& operator=(can_tx_queue&& p_other) = delete;
+  can_tx_queue(const can_tx_queue&) = delete;
+  can_tx_queue& operator=(const can_tx_queue&) = delete;
+  ~can_tx_queue() override;
+
+  /**
+   * @brief Queue a message, replacing any queued message with the same ID
+   *
+   * Use this for periodic messages, where only the newest value matters.
+   *
+   * @param p_message - message to send
+   * @return status - success or an error
+   * @throws std::errc::no_buffer_space - if the queue is full of messages
+   * with the same or higher priority
+   */
+  status send_latest(const message_t& p_message);
+
+  /**
+   * @brief Hand queued messages to the CAN bus, highest priority first
+   *
+   * Stops at the first message the bus does not accept. Call this from a
+   * transmit complete interrupt to keep the hardware mailboxes full.
+   *
+   * @return std::size_t - number of messages the bus accepted
+   */
+  std::size_t transmit();
+
+  /**
+   * @brief Get the number of queued messages
+   *
+   * @return std::size_t - number of messages waiting to be sent
+   */
+  [[nodiscard]] std::size_t size() const;
+
+  /**
+   * @brief Get the number of low priority messages dropped from a full queue
+   * to make room for higher priority ones
+   *
+   * @return std::size_t - number of dropped messages
+   */
+  [[nodiscard]] std::size_t dropped_messages() const;
+
+private:
+  can_tx_queue(hal::can& p_can,
+               std::span<message_t> p_storage,
+               hal::timer* p_retry_timer,
+               hal::time_duration p_retry_period);
+
+  status driver_configure(const settings& p_settings) override;
+  status driver_bus_on() override;
+  result<send_t> driver_send(const message_t& p_message) override;
+  void driver_on_receive(hal::callback<handler> p_handler) override;
+
+  status enqueue(const message_t& p_message);
+  void schedule_retry();
+
+  hal::can* m_can;
+  /// Sorted lowest priority first, so the next message to send is the last
+  std::span<message_t> m_storage;
+  hal::timer* m_retry_timer;
+  hal::time_duration m_retry_period;
+  std::size_t m_size = 0;
+  std::size_t m_dropped = 0;
+};
+}  // namespace hal::soft
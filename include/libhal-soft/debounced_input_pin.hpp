@@ -0,0 +1,169 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include <libhal/input_pin.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+/**
+ * @brief An input_pin that filters out contact bounce of the pin it wraps
+ *
+ * The wrapped pin is sampled once per call to level(), so the debouncer is
+ * meant to be polled at a steady rate. Two filters are available:
+ *
+ * - Integrator: a counter moves one step towards each sample and the level
+ *   only changes once the counter reaches its limit, i.e. after the pin has
+ *   mostly held its new level for `samples` polls. Cheap and immune to
+ *   glitches, at the cost of `samples` polls of latency.
+ * - Lock-out: a change of level is reported immediately, after which the pin
+ *   is ignored for a fixed time so the bounces that follow are not seen.
+ *   No added latency, but a single glitch is reported as a level change.
+ *
+ * To debounce many pins at once, read them with an input_port and filter the
+ * word with a vertical_debouncer instead.
+ */
+class debounced_input_pin : public hal::input_pin
+{
+public:
+  /**
+   * @brief Factory function to create an integrating debounced_input_pin
+   *
+   * @param p_pin - pin to debounce. Must outlive the debouncer.
+   * @param p_samples - number of polls the pin must hold a new level for
+   * before it is reported
+   * @return result<debounced_input_pin> - the constructed debouncer
+   * @throws std::errc::invalid_argument - if p_samples is zero
+   */
+  static result<debounced_input_pin> create(hal::input_pin& p_pin,
+                                            std::uint8_t p_samples);
+
+  /**
+   * @brief Factory function to create a lock-out debounced_input_pin
+   *
+   * @param p_pin - pin to debounce. Must outlive the debouncer.
+   * @param p_clock - clock used to time the lock-out. Must outlive the
+   * debouncer.
+   * @param p_lockout - time to ignore the pin for after its level changes
+   * @return result<debounced_input_pin> - the constructed debouncer
+   * @throws std::errc::invalid_argument - if p_lockout is shorter than one
+   * clock tick
+   */
+  static result<debounced_input_pin> create(hal::input_pin& p_pin,
+                                            hal::steady_clock& p_clock,
+                                            hal::time_duration p_lockout);
+
+private:
+  debounced_input_pin(hal::input_pin& p_pin,
+                      hal::steady_clock* p_clock,
+                      std::uint64_t p_lockout_ticks,
+                      std::uint8_t p_samples);
+
+  status driver_configure(const settings& p_settings) override;
+  result<level_t> driver_level() override;
+
+  result<level_t> integrate();
+  result<level_t> lock_out();
+
+  hal::input_pin* m_pin;
+  /// Null in integrator mode
+  hal::steady_clock* m_clock;
+  std::uint64_t m_lockout_ticks;
+  std::uint64_t m_lockout_end = 0;
+  std::uint8_t m_samples;
+  std::uint8_t m_integrator = 0;
+  bool m_state = false;
+  /// False until the first sample sets the initial level
+  bool m_started = false;
+};
+
+/**
+ * @brief Debounces up to 32 inputs at once with a vertical counter
+ *
+ * Each bit of the word passed to update() is an independent input, typically
+ * the result of input_port::read(). Every bit has a two bit counter, stored
+ * "vertically" across two words, that counts the consecutive samples in which
+ * the input differs from its debounced state and resets whenever they agree.
+ * An input's debounced state changes once it differs for four samples in a
+ * row. All 32 counters are updated with a handful of bitwise operations, so
+ * the cost does not depend on the number of inputs.
+ */
+class vertical_debouncer
+{
+public:
+  /// Number of consecutive samples needed to change the debounced state
+  static constexpr int samples = 4;
+
+  /**
+   * @brief Construct a vertical_debouncer
+   *
+   * @param p_initial - debounced state to start from
+   */
+  constexpr explicit vertical_debouncer(std::uint32_t p_initial = 0)
+    : m_state(p_initial)
+  {
+  }
+
+  /**
+   * @brief Feed the next sample of every input
+   *
+   * @param p_sample - one bit per input
+   * @return std::uint32_t - the debounced state
+   */
+  constexpr std::uint32_t update(std::uint32_t p_sample)
+  {
+    const auto delta = p_sample ^ m_state;
+    // Increment the counters of differing inputs, reset the rest to zero
+    m_count1 = (m_count1 ^ m_count0) & delta;
+    m_count0 = ~m_count0 & delta;
+    // A counter that wrapped back to zero while differing has seen 4 samples
+    m_changed = delta & ~(m_count0 | m_count1);
+    m_state ^= m_changed;
+    return m_state;
+  }
+
+  /**
+   * @brief Get the debounced state
+   *
+   * @return std::uint32_t - one bit per input
+   */
+  [[nodiscard]] constexpr std::uint32_t state() const
+  {
+    return m_state;
+  }
+
+  /**
+   * @brief Get the inputs whose debounced state changed in the last update
+   *
+   * AND with state() for the inputs that were pressed, AND with ~state() for
+   * the ones that were released.
+   *
+   * @return std::uint32_t - one bit per input
+   */
+  [[nodiscard]] constexpr std::uint32_t changed() const
+  {
+    return m_changed;
+  }
+
+private:
+  std::uint32_t m_state;
+  std::uint32_t m_count0 = 0;
+  std::uint32_t m_count1 = 0;
+  std::uint32_t m_changed = 0;
+};
+}  // namespace hal::soft
@@ -0,0 +1,123 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Steady clock wrapper with a 64-bit count and division free time
+ * conversions
+ *
+ * Hardware counters are often 16 or 32 bits wide and wrap. fast_clock
+ * extends such a counter to a monotonic 64-bit count by noticing each wrap,
+ * which works as long as the clock is read at least once per wrap_period().
+ *
+ * The frequency is read once, when the fast_clock is created, and turned
+ * into two fixed-point ratios, each scaled to 62 significant bits. Converting
+ * between ticks and nanoseconds is then a multiply and a shift, built from
+ * 32-bit multiplies, instead of a 64-bit or floating point division.
+ * delay() and deadline() use these conversions in place of hal::delay() and
+ * hal::future_deadline().
+ * Conversions round down and are exact to within one unit of the result.
+ *
+ * The wrap tracking is not protected against concurrent reads: a read from
+ * an interrupt must not preempt a read from the main loop.
+ */
+class fast_clock : public hal::steady_clock
+{
+public:
+  /**
+   * @brief Factory function to create a fast_clock object
+   *
+   * @param p_clock - steady clock to extend
+   * @param p_counter_bits - width of p_clock's counter in bits
+   * @return result<fast_clock> - the constructed fast_clock object
+   * @throws std::errc::invalid_argument - if p_counter_bits is not between 1
+   * and 64, or if p_clock's frequency is below 1Hz
+   */
+  static result<fast_clock> create(hal::steady_clock& p_clock,
+                                   std::uint8_t p_counter_bits = 64);
+
+  /**
+   * @brief Convert a tick count into a duration
+   *
+   * @param p_ticks - number of ticks
+   * @return hal::time_duration - length of p_ticks, rounded down
+   */
+  [[nodiscard]] hal::time_duration to_duration(std::uint64_t p_ticks) const;
+
+  /**
+   * @brief Convert a duration into a tick count
+   *
+   * @param p_duration - length of time. Negative durations are zero ticks.
+   * @return std::uint64_t - number of ticks in p_duration, rounded down
+   */
+  [[nodiscard]] std::uint64_t to_ticks(hal::time_duration p_duration) const;
+
+  /**
+   * @brief Get the uptime as a duration
+   *
+   * @return hal::time_duration - time since the counter started
+   */
+  hal::time_duration now();
+
+  /**
+   * @brief Get the tick count a duration from now
+   *
+   * @param p_duration - time from now
+   * @return std::uint64_t - uptime in ticks once p_duration has passed
+   */
+  std::uint64_t deadline(hal::time_duration p_duration);
+
+  /**
+   * @brief Busy wait for a duration
+   *
+   * @param p_duration - time to wait
+   */
+  void delay(hal::time_duration p_duration);
+
+  /**
+   * @brief Get the longest time allowed between two reads of the clock
+   *
+   * @return hal::time_duration - time it takes the counter to wrap
+   */
+  [[nodiscard]] hal::time_duration wrap_period() const;
+
+private:
+  fast_clock(hal::steady_clock& p_clock,
+             std::uint8_t p_counter_bits,
+             hal::hertz p_frequency);
+
+  frequency_t driver_frequency() override;
+  uptime_t driver_uptime() override;
+
+  hal::steady_clock* m_clock;
+  hal::hertz m_frequency;
+  /// Nanoseconds per tick, scaled by 2^m_ns_per_tick_shift
+  std::uint64_t m_ns_per_tick = 0;
+  /// Ticks per nanosecond, scaled by 2^m_ticks_per_ns_shift
+  std::uint64_t m_ticks_per_ns = 0;
+  std::uint64_t m_counter_mask;
+  std::uint64_t m_last_count = 0;
+  std::uint64_t m_wraps = 0;
+  std::uint8_t m_counter_bits;
+  std::uint8_t m_ns_per_tick_shift = 0;
+  std::uint8_t m_ticks_per_ns_shift = 0;
+};
+}  // namespace hal::soft
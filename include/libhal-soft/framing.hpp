@@ -0,0 +1,223 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include <libhal/serial.hpp>
+
+/**
+ * @defgroup Framing Framing
+ *
+ */
+
+namespace hal::soft {
+/// Longest run of non-zero bytes a single COBS block can hold
+constexpr std::size_t cobs_max_block = 254;
+
+/**
+ * @ingroup Framing
+ * @brief Get the worst case size of a COBS encoded frame
+ *
+ * @param p_length - length of the payload in bytes
+ * @return constexpr std::size_t - encoded size, including the zero delimiter
+ */
+constexpr std::size_t cobs_max_encoded_size(std::size_t p_length)
+{
+  return p_length + (p_length / cobs_max_block) + 2;
+}
+
+/**
+ * @ingroup Framing
+ * @brief Result of feeding bytes to a frame decoder
+ *
+ */
+struct frame_decode_t
+{
+  /// Input bytes that were not processed. Decoding stops as soon as a frame
+  /// completes, so these bytes belong to the next frame and should be passed
+  /// back to decode() once the frame has been handled.
+  std::span<const hal::byte> remaining{};
+  /// The decoded frame within the decoder's buffer. Only valid when `complete`
+  /// is true and until the next call to decode().
+  std::span<hal::byte> frame{};
+  /// True if a complete frame was decoded
+  bool complete = false;
+};
+
+/**
+ * @ingroup Framing
+ * @brief Incremental decoder for Consistent Overhead Byte Stuffing (COBS)
+ * frames delimited by a zero byte.
+ *
+ * The decoder can be fed any number of bytes at a time and resumes exactly
+ * where it left off, so it can be driven straight from whatever a serial read
+ * returns. Frames that do not fit into the frame buffer or that are
+ * malformed are dropped and counted.
+ */
+class cobs_decoder
+{
+public:
+  /**
+   * @brief Factory function to create a cobs_decoder object
+   *
+   * @param p_buffer - storage for the decoded frame. Frames longer than this
+   * buffer are dropped. The buffer must outlive the decoder.
+   * @return result<cobs_decoder> - the constructed cobs_decoder object
+   */
+  static result<cobs_decoder> create(std::span<hal::byte> p_buffer);
+
+  /**
+   * @brief Decode bytes until a frame completes or the input runs out
+   *
+   * @param p_data - encoded bytes, including the zero delimiters
+   * @return frame_decode_t - decoded frame (if any) and the unprocessed input
+   */
+  frame_decode_t decode(std::span<const hal::byte> p_data);
+
+  /**
+   * @brief Discard any partially decoded frame
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Get the number of frames dropped due to overflow or malformed data
+   *
+   * @return std::size_t - number of dropped frames
+   */
+  [[nodiscard]] std::size_t dropped_frames() const;
+
+private:
+  cobs_decoder(std::span<hal::byte> p_buffer);
+
+  std::span<hal::byte> m_buffer;
+  std::size_t m_length = 0;
+  std::size_t m_dropped = 0;
+  /// Bytes left in the current block, zero when a code byte is expected
+  hal::byte m_block_remaining = 0;
+  bool m_started = false;
+  bool m_pending_zero = false;
+  bool m_discarding = false;
+};
+
+/**
+ * @ingroup Framing
+ * @brief Incremental decoder for Serial Line Internet Protocol (SLIP, RFC 1055)
+ * frames.
+ *
+ * The decoder can be fed any number of bytes at a time and resumes exactly
+ * where it left off. Frames that do not fit into the frame buffer or that
+ * contain invalid escape sequences are dropped and counted. Empty frames, such
+ * as those produced by a leading END byte, are ignored.
+ */
+class slip_decoder
+{
+public:
+  /// Byte that terminates a frame
+  static constexpr hal::byte end = 0xC0;
+  /// Byte that starts an escape sequence
+  static constexpr hal::byte escape = 0xDB;
+  /// Escaped form of end
+  static constexpr hal::byte escaped_end = 0xDC;
+  /// Escaped form of escape
+  static constexpr hal::byte escaped_escape = 0xDD;
+
+  /**
+   * @brief Factory function to create a slip_decoder object
+   *
+   * @param p_buffer - storage for the decoded frame. Frames longer than this
+   * buffer are dropped. The buffer must outlive the decoder.
+   * @return result<slip_decoder> - the constructed slip_decoder object
+   */
+  static result<slip_decoder> create(std::span<hal::byte> p_buffer);
+
+  /**
+   * @brief Decode bytes until a frame completes or the input runs out
+   *
+   * @param p_data - encoded bytes, including the end delimiters
+   * @return frame_decode_t - decoded frame (if any) and the unprocessed input
+   */
+  frame_decode_t decode(std::span<const hal::byte> p_data);
+
+  /**
+   * @brief Discard any partially decoded frame
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Get the number of frames dropped due to overflow or malformed data
+   *
+   * @return std::size_t - number of dropped frames
+   */
+  [[nodiscard]] std::size_t dropped_frames() const;
+
+private:
+  slip_decoder(std::span<hal::byte> p_buffer);
+
+  void append(std::span<const hal::byte> p_data);
+
+  std::span<hal::byte> m_buffer;
+  std::size_t m_length = 0;
+  std::size_t m_dropped = 0;
+  bool m_escaped = false;
+  bool m_discarding = false;
+};
+
+/**
+ * @ingroup Framing
+ * @brief COBS encode a frame and write it, followed by a zero delimiter
+ *
+ * The payload is written in place, one block at a time, without being copied
+ * into an intermediate buffer.
+ *
+ * @param p_serial - serial port to write the frame to
+ * @param p_payload - bytes to encode
+ * @return status - success or an error from the serial port
+ */
+status write_cobs_frame(hal::serial& p_serial,
+                        std::span<const hal::byte> p_payload);
+
+/**
+ * @ingroup Framing
+ * @brief COBS encode a frame into a buffer, followed by a zero delimiter
+ *
+ * Useful for batching several frames into a single write.
+ *
+ * @param p_payload - bytes to encode
+ * @param p_output - buffer to encode into
+ * @return result<std::span<hal::byte>> - the encoded frame within p_output
+ * @throws std::errc::no_buffer_space - if p_output is smaller than
+ * cobs_max_encoded_size(p_payload.size())
+ */
+result<std::span<hal::byte>> cobs_encode(std::span<const hal::byte> p_payload,
+                                         std::span<hal::byte> p_output);
+
+/**
+ * @ingroup Framing
+ * @brief SLIP encode a frame and write it, surrounded by end bytes
+ *
+ * Runs of bytes that need no escaping are written in place without being
+ * copied into an intermediate buffer.
+ *
+ * @param p_serial - serial port to write the frame to
+ * @param p_payload - bytes to encode
+ * @return status - success or an error from the serial port
+ */
+status write_slip_frame(hal::serial& p_serial,
+                        std::span<const hal::byte> p_payload);
+}  // namespace hal::soft
@@ -0,0 +1,164 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+
+#include <libhal/interrupt_pin.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Measures the frequency of a signal on an interrupt pin
+ *
+ * The interrupt handler only stores a steady_clock timestamp per rising edge
+ * into a ring buffer. measure() then estimates the frequency two ways and
+ * returns whichever has the smaller quantization error:
+ *
+ * - Reciprocal counting: the number of periods in the ring divided by the
+ *   time between its oldest and newest edge. Its error is one clock tick over
+ *   that time span, so it is precise at low frequencies.
+ * - Gated counting: the number of edges counted during the last gate time
+ *   divided by the gate time. Its error is one edge over the edges counted,
+ *   so it wins at high frequencies, and keeps working when the ring is
+ *   overwritten faster than it can be read.
+ *
+ * The gate is advanced by measure(), so it should be called at least once
+ * per gate time for gated counting to be current.
+ */
+class frequency_counter
+{
+public:
+  /// Method used for a measurement
+  enum class counting_method : std::uint8_t
+  {
+    /// No edges seen within the timeout, the frequency is reported as zero
+    none,
+    reciprocal,
+    gated,
+  };
+
+  struct settings
+  {
+    /// Length of the gated counting window
+    hal::time_duration gate_time = std::chrono::milliseconds(100);
+    /// Signal is considered stopped after this long without an edge
+    hal::time_duration timeout = std::chrono::seconds(1);
+    /// Edges per revolution, used to compute rpm
+    std::uint32_t pulses_per_revolution = 1;
+  };
+
+  struct measurement_t
+  {
+    hal::hertz frequency = 0.0f;
+    /// Period of the signal, zero if the frequency is zero
+    hal::time_duration period{};
+    /// Revolutions per minute, given pulses_per_revolution
+    float rpm = 0.0f;
+    counting_method method = counting_method::none;
+  };
+
+  /**
+   * @brief Factory function to create a frequency_counter object
+   *
+   * The pin is configured to trigger on rising edges, keeping the default
+   * resistor setting.
+   *
+   * @param p_pin - pin carrying the signal. Must outlive the counter.
+   * @param p_clock - clock used to timestamp edges. Must outlive the counter.
+   * @param p_timestamps - ring of edge timestamps. Its size must be a power of
+   * two of at least 4. More timestamps average reciprocal counting over more
+   * periods. Must outlive the counter.
+   * @param p_settings - gate time, timeout and pulses per revolution
+   * @return result<frequency_counter> - the constructed frequency_counter
+   * @throws std::errc::invalid_argument - if p_timestamps has the wrong size,
+   * the gate time or timeout is shorter than one clock tick, or
+   * pulses_per_revolution is zero
+   */
+  static result<frequency_counter> create(hal::interrupt_pin& p_pin,
+                                          hal::steady_clock& p_clock,
+                                          std::span<std::uint64_t> p_timestamps,
+                                          const settings& p_settings);
+
+  /**
+   * @brief Factory function to create a frequency_counter with default
+   * settings
+   *
+   * @param p_pin - pin carrying the signal. Must outlive the counter.
+   * @param p_clock - clock used to timestamp edges. Must outlive the counter.
+   * @param p_timestamps - ring of edge timestamps, see the other overload
+   * @return result<frequency_counter> - the constructed frequency_counter
+   * @throws std::errc::invalid_argument - if p_timestamps has the wrong size
+   */
+  static result<frequency_counter> create(
+    hal::interrupt_pin& p_pin,
+    hal::steady_clock& p_clock,
+    std::span<std::uint64_t> p_timestamps);
+
+  frequency_counter(frequency_counter&& p_other) noexcept;
+  frequency_counter& operator=(frequency_counter&& p_other) = delete;
+  frequency_counter(const frequency_counter&) = delete;
+  frequency_counter& operator=(const frequency_counter&) = delete;
+  ~frequency_counter();
+
+  /**
+   * @brief Estimate the current frequency of the signal
+   *
+   * @return measurement_t - the estimate with the smallest quantization error
+   */
+  measurement_t measure();
+
+  /**
+   * @brief Get the number of edges seen since creation
+   *
+   * @return std::uint32_t - edge count, wraps around at 2^32
+   */
+  [[nodiscard]] std::uint32_t edges() const;
+
+private:
+  frequency_counter(hal::interrupt_pin& p_pin,
+                    hal::steady_clock& p_clock,
+                    std::span<std::uint64_t> p_timestamps,
+                    std::uint64_t p_gate_ticks,
+                    std::uint64_t p_timeout_ticks,
+                    std::uint32_t p_pulses_per_revolution);
+
+  /// Register the edge handler, which refers to this object
+  void attach();
+  /// Replace the edge handler with one that ignores every edge
+  void detach();
+  measurement_t result_of(double p_frequency, counting_method p_method) const;
+
+  hal::interrupt_pin* m_pin;
+  hal::steady_clock* m_clock;
+  std::span<std::uint64_t> m_timestamps;
+  double m_clock_frequency;
+  std::uint64_t m_gate_ticks;
+  std::uint64_t m_timeout_ticks;
+  std::uint32_t m_pulses_per_revolution;
+  /// Number of edges stored, the next timestamp goes to m_head % size
+  std::atomic<std::uint32_t> m_head{ 0 };
+  /// Start of the current gate
+  std::uint64_t m_gate_start = 0;
+  std::uint32_t m_gate_head = 0;
+  /// Result of the last complete gate
+  std::uint64_t m_gated_ticks = 0;
+  std::uint32_t m_gated_edges = 0;
+};
+}  // namespace hal::soft
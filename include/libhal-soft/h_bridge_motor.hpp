@@ -0,0 +1,219 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <libhal/motor.hpp>
+#include <libhal/output_pin.hpp>
+#include <libhal/pwm.hpp>
+#include <libhal/timer.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+/**
+ * @brief A motor driven through an H-bridge
+ *
+ * Three wirings are supported, chosen by the create() overload:
+ *
+ * - Sign-magnitude with an enable PWM and two direction inputs, as on the
+ *   L298. The duty cycle sets the magnitude and the inputs set the direction.
+ *   Braking drives both inputs low with the bridge enabled.
+ * - Sign-magnitude with a PWM on each bridge input, as on the DRV8833. The
+ *   input for the current direction carries the duty cycle while the other
+ *   is held low. Braking drives both inputs high.
+ * - Locked-antiphase with one PWM and an enable output, where the bridge
+ *   switches direction every PWM cycle. A 50% duty cycle is zero power, which
+ *   brakes. Coasting disables the bridge.
+ *
+ * Direction outputs are only written when the sign of the power changes, so
+ * repeated calls in the same direction cost a single duty cycle write. When
+ * the direction does change, the bridge is released before the inputs swap.
+ *
+ * Power outside of -1.0 to 1.0 is clamped.
+ */
+class h_bridge_motor : public hal::motor
+{
+public:
+  struct settings
+  {
+    /// PWM frequency, usually above hearing range
+    hal::hertz frequency = 20'000.0f;
+    /// Short the motor terminals at zero power, rather than letting it coast
+    bool brake = false;
+  };
+
+  /**
+   * @brief Factory function to create a sign-magnitude h_bridge_motor with an
+   * enable PWM and two direction inputs
+   *
+   * @param p_enable - pwm on the bridge enable input. Must outlive the motor.
+   * @param p_forward - input driven high to turn forward. Must outlive the
+   * motor.
+   * @param p_reverse - input driven high to turn in reverse. Must outlive the
+   * motor.
+   * @param p_settings - PWM frequency and zero power behavior
+   * @return result<h_bridge_motor> - the constructed motor, stopped
+   */
+  static result<h_bridge_motor> create(hal::pwm& p_enable,
+                                       hal::output_pin& p_forward,
+                                       hal::output_pin& p_reverse,
+                                       const settings& p_settings);
+
+  /**
+   * @brief Factory function to create a sign-magnitude h_bridge_motor with a
+   * PWM on each bridge input
+   *
+   * @param p_forward - pwm on the input that turns the motor forward. Must
+   * outlive the motor.
+   * @param p_reverse - pwm on the input that turns the motor in reverse. Must
+   * outlive the motor.
+   * @param p_settings - PWM frequency and zero power behavior
+   * @return result<h_bridge_motor> - the constructed motor, stopped
+   */
+  static result<h_bridge_motor> create(hal::pwm& p_forward,
+                                       hal::pwm& p_reverse,
+                                       const settings& p_settings);
+
+  /**
+   * @brief Factory function to create a locked-antiphase h_bridge_motor
+   *
+   * @param p_pwm - pwm driving the bridge in antiphase. Must outlive the
+   * motor.
+   * @param p_enable - bridge enable input, driven high except when coasting.
+   * Must outlive the motor.
+   * @param p_settings - PWM frequency and zero power behavior
+   * @return result<h_bridge_motor> - the constructed motor, stopped
+   */
+  static result<h_bridge_motor> create(hal::pwm& p_pwm,
+                                       hal::output_pin& p_enable,
+                                       const settings& p_settings);
+
+private:
+  enum class wiring : std::uint8_t
+  {
+    enable_and_direction,
+    dual_pwm,
+    locked_antiphase,
+  };
+
+  enum class direction : std::uint8_t
+  {
+    /// Not yet driven, so the first write sets every output
+    unknown,
+    forward,
+    reverse,
+    stopped,
+  };
+
+  h_bridge_motor(wiring p_wiring,
+                 hal::pwm* p_pwm,
+                 hal::pwm* p_reverse_pwm,
+                 hal::output_pin* p_forward,
+                 hal::output_pin* p_reverse,
+                 bool p_brake);
+
+  result<power_t> driver_power(float p_power) override;
+
+  status drive_enable_and_direction(direction p_direction, float p_magnitude);
+  status drive_dual_pwm(direction p_direction, float p_magnitude);
+  status drive_locked_antiphase(direction p_direction, float p_power);
+
+  wiring m_wiring;
+  /// Enable, forward or antiphase pwm, depending on the wiring
+  hal::pwm* m_pwm;
+  /// Reverse pwm, only for dual_pwm
+  hal::pwm* m_reverse_pwm;
+  /// Forward input, or the enable input for locked_antiphase
+  hal::output_pin* m_forward;
+  /// Reverse input, only for enable_and_direction
+  hal::output_pin* m_reverse;
+  bool m_brake;
+  direction m_direction = direction::unknown;
+};
+
+/**
+ * @brief Limits how fast the power of a motor can change
+ *
+ * Each power() call only sets a target. A timer then steps the power of the
+ * wrapped motor towards it at a fixed rate, and stops once it gets there, so
+ * the application can request large changes without ramping them itself.
+ * Reversals pass through zero at the same rate.
+ *
+ * Moving a ramping slew_limited_motor re-arms the timer for the new object,
+ * and destroying it cancels the timer.
+ */
+class slew_limited_motor : public hal::motor
+{
+public:
+  struct settings
+  {
+    /// Largest change in power per second, where 1.0 is full scale
+    float rate = 2.0f;
+    /// Time between power updates while ramping
+    hal::time_duration period = std::chrono::milliseconds(10);
+  };
+
+  /**
+   * @brief Factory function to create a slew_limited_motor object
+   *
+   * @param p_motor - motor to ramp. Must outlive this object.
+   * @param p_timer - timer running the ramp. Must outlive this object and
+   * must not be used for anything else.
+   * @param p_settings - ramp rate and update period
+   * @return result<slew_limited_motor> - the constructed object, starting
+   * from zero power
+   * @throws std::errc::invalid_argument - if the rate or period is not
+   * positive
+   */
+  static result<slew_limited_motor> create(hal::motor& p_motor,
+                                           hal::timer& p_timer,
+                                           const settings& p_settings);
+
+  slew_limited_motor(slew_limited_motor&& p_other) noexcept;
+  slew_limited_motor& operator=(slew_limited_motor&& p_other) = delete;
+  slew_limited_motor(const slew_limited_motor&) = delete;
+  slew_limited_motor& operator=(const slew_limited_motor&) = delete;
+  ~slew_limited_motor() override;
+
+  /**
+   * @brief Get the power most recently applied to the wrapped motor
+   *
+   * @return float - power, from -1.0 to 1.0
+   */
+  [[nodiscard]] float output() const;
+
+private:
+  slew_limited_motor(hal::motor& p_motor,
+                     hal::timer& p_timer,
+                     const settings& p_settings);
+
+  result<power_t> driver_power(float p_power) override;
+
+  /// Apply one step towards the target and reschedule until it is reached
+  status ramp();
+
+  hal::motor* m_motor;
+  hal::timer* m_timer;
+  hal::time_duration m_period;
+  /// Largest change in power per update
+  float m_step;
+  float m_target = 0.0f;
+  float m_output = 0.0f;
+  /// Set while the timer is armed, only cleared when it is not re-armed
+  bool m_ramping = false;
+};
+}  // namespace hal::soft
@@ -0,0 +1,128 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include <libhal/can.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Inert implementation of Controller Area Network (CAN bus) hardware
+ *
+ * Beyond accepting messages and doing nothing, inert_can can deliver each
+ * sent message back to its own receive handler (loopback) or answer each sent
+ * message with the next message from a caller-provided script (replay).
+ * Messages are delivered synchronously from within send(), as if the receive
+ * interrupt fired immediately. Neither mode allocates.
+ */
+class inert_can : public hal::can
+{
+public:
+  /**
+   * @brief Factory function to create inert_can object
+   *
+   * @param p_bus_on - State of inert can bus. Setting this value to true will
+   * return success when bus_on() is called, and setting this value to false
+   * will return an error when bus_on() is caled.
+   * @return result<inert_can> - Constructed inert_can object
+   */
+  static result<inert_can> create(bool p_bus_on)
+  {
+    return inert_can(mode::inert, p_bus_on, {});
+  }
+
+  /**
+   * @brief Factory function to create a loopback inert_can object
+   *
+   * Every message passed to send() is passed to the receive handler.
+   *
+   * @return result<inert_can> - Constructed inert_can object
+   */
+  static result<inert_can> create_loopback()
+  {
+    return inert_can(mode::loopback, true, {});
+  }
+
+  /**
+   * @brief Factory function to create a replaying inert_can object
+   *
+   * Every call to send() passes the next message of p_responses to the
+   * receive handler. Once the script is exhausted, send() still succeeds but
+   * nothing is received.
+   *
+   * @param p_responses - scripted messages to be received. The span must
+   * outlive the inert_can object.
+   * @return result<inert_can> - Constructed inert_can object
+   */
+  static result<inert_can> create_replay(std::span<const message_t> p_responses)
+  {
+    return inert_can(mode::replay, true, p_responses);
+  }
+
+private:
+  enum class mode
+  {
+    inert,
+    loopback,
+    replay,
+  };
+
+  inert_can(mode p_mode,
+            bool p_bus_on,
+            std::span<const message_t> p_responses)
+    : m_responses(p_responses)
+    , m_mode(p_mode)
+    , m_bus_on(p_bus_on)
+  {
+  }
+
+  status driver_configure([[maybe_unused]] const settings& p_settings)
+  {
+
+    return hal::success();
+  };
+
+  status driver_bus_on()
+  {
+    if (m_bus_on) {
+      return hal::success();
+    }
+    return hal::new_error();
+  };
+
+  result<send_t> driver_send(const message_t& p_message)
+  {
+    if (m_mode == mode::loopback) {
+      m_handler(p_message);
+    } else if (m_mode == mode::replay && m_position < m_responses.size()) {
+      m_handler(m_responses[m_position++]);
+    }
+    return send_t{};
+  };
+
+  void driver_on_receive(hal::callback<handler> p_handler)
+  {
+    m_handler = p_handler;
+  };
+
+  hal::callback<handler> m_handler = []([[maybe_unused]] const message_t&) {};
+  std::span<const message_t> m_responses;
+  std::size_t m_position = 0;
+  mode m_mode;
+  bool m_bus_on;
+};
+}  // namespace hal::soft
@@ -0,0 +1,138 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+#include <libhal/i2c.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Inert implementation of Inter-integrated Circuit (I2C) hardware
+ *
+ * Beyond accepting transactions and doing nothing, inert_i2c can echo back
+ * the last bytes written to it (loopback) or return a scripted stream of
+ * bytes from a caller-provided buffer (replay). Neither mode allocates.
+ */
+class inert_i2c : public hal::i2c
+{
+public:
+  /// Value read back for bytes that have no data behind them, matching an idle
+  /// (pulled up) bus.
+  static constexpr hal::byte idle_byte = 0xFF;
+
+  /**
+   * @brief Factory function to create inert_i2c object
+   *
+   * @return result<inert_i2c> - Constructed inert_i2c object
+   */
+  static result<inert_i2c> create()
+  {
+    return inert_i2c(mode::inert, {}, {});
+  }
+
+  /**
+   * @brief Factory function to create a loopback inert_i2c object
+   *
+   * The write portion of each transaction is stored in p_memory, replacing
+   * what was stored before, and the read portion of each transaction returns
+   * the stored bytes. This allows a write followed by a read, either within
+   * the same transaction or across transactions, to return the written data.
+   * Bytes beyond the stored length read back as idle_byte.
+   *
+   * @param p_memory - storage for the last written bytes. The buffer must
+   * outlive the inert_i2c object.
+   * @return result<inert_i2c> - Constructed inert_i2c object
+   */
+  static result<inert_i2c> create_loopback(std::span<hal::byte> p_memory)
+  {
+    return inert_i2c(mode::loopback, p_memory, {});
+  }
+
+  /**
+   * @brief Factory function to create a replaying inert_i2c object
+   *
+   * The read portion of each transaction returns the next bytes of
+   * p_responses, continuing where the previous transaction left off. Once the
+   * script is exhausted the remaining bytes read back as idle_byte.
+   *
+   * @param p_responses - scripted bytes to be read. The span must outlive the
+   * inert_i2c object.
+   * @return result<inert_i2c> - Constructed inert_i2c object
+   */
+  static result<inert_i2c> create_replay(std::span<const hal::byte> p_responses)
+  {
+    return inert_i2c(mode::replay, {}, p_responses);
+  }
+
+private:
+  enum class mode
+  {
+    inert,
+    loopback,
+    replay,
+  };
+
+  constexpr inert_i2c(mode p_mode,
+                      std::span<hal::byte> p_memory,
+                      std::span<const hal::byte> p_responses)
+    : m_memory(p_memory)
+    , m_responses(p_responses)
+    , m_mode(p_mode)
+  {
+  }
+
+  status driver_configure([[maybe_unused]] const settings& p_settings)
+  {
+    return hal::success();
+  };
+
+  result<transaction_t> driver_transaction(
+    [[maybe_unused]] hal::byte p_address,
+    std::span<const hal::byte> p_data_out,
+    std::span<hal::byte> p_data_in,
+    [[maybe_unused]] hal::function_ref<hal::timeout_function> p_timeout)
+  {
+    if (m_mode == mode::inert) {
+      return transaction_t{};
+    }
+
+    std::size_t count = 0;
+    if (m_mode == mode::loopback) {
+      if (!p_data_out.empty()) {
+        m_length = std::min(p_data_out.size(), m_memory.size());
+        std::copy_n(p_data_out.begin(), m_length, m_memory.begin());
+      }
+      count = std::min(p_data_in.size(), m_length);
+      std::copy_n(m_memory.begin(), count, p_data_in.begin());
+    } else {
+      count = std::min(p_data_in.size(), m_responses.size() - m_position);
+      std::copy_n(m_responses.begin() + m_position, count, p_data_in.begin());
+      m_position += count;
+    }
+    std::fill(p_data_in.begin() + count, p_data_in.end(), idle_byte);
+
+    return transaction_t{};
+  };
+
+  std::span<hal::byte> m_memory;
+  std::span<const hal::byte> m_responses;
+  std::size_t m_length = 0;
+  std::size_t m_position = 0;
+  mode m_mode;
+};
+}  // namespace hal::soft
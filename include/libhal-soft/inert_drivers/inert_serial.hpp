@@ -0,0 +1,186 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+#include <libhal/serial.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Inert implementation of serial communication protocol hardware
+ *
+ * Beyond returning fixed values, inert_serial can act as a loopback device,
+ * where written bytes become readable, or replay a scripted stream of bytes
+ * back through read(). Both modes work out of a caller-provided buffer and
+ * never allocate, making it suitable for exercising protocol code at memory
+ * speed on a host machine.
+ */
+class inert_serial : public hal::serial
+{
+public:
+  /**
+   * @brief Factory function to create inert_serial object
+   *
+   * @param p_write_data - write_t object to return when write() is called
+   * @param p_read_data - read_t object to return when read() is called
+   * @return result<inert_serial> - Constructed inert_serial object
+   */
+  static result<inert_serial> create(write_t p_write_data, read_t p_read_data)
+  {
+    return inert_serial(p_write_data, p_read_data);
+  }
+
+  /**
+   * @brief Factory function to create a loopback inert_serial object
+   *
+   * Bytes passed to write() are stored in p_buffer and returned by subsequent
+   * calls to read() in FIFO order. Bytes written while the buffer is full are
+   * dropped, just as a hardware receive buffer would overrun.
+   *
+   * @param p_buffer - storage for bytes written but not yet read. The buffer
+   * must outlive the inert_serial object.
+   * @return result<inert_serial> - Constructed inert_serial object
+   */
+  static result<inert_serial> create_loopback(std::span<hal::byte> p_buffer)
+  {
+    return inert_serial(p_buffer);
+  }
+
+  /**
+   * @brief Factory function to create a replaying inert_serial object
+   *
+   * Each call to read() returns the next bytes of p_responses until the
+   * script is exhausted, after which read() returns no data. Bytes passed to
+   * write() are accepted and discarded.
+   *
+   * @param p_responses - scripted bytes to be received. The span must outlive
+   * the inert_serial object.
+   * @return result<inert_serial> - Constructed inert_serial object
+   */
+  static result<inert_serial> create_replay(
+    std::span<const hal::byte> p_responses)
+  {
+    return inert_serial(p_responses);
+  }
+
+private:
+  enum class mode
+  {
+    fixed,
+    loopback,
+    replay,
+  };
+
+  constexpr inert_serial(write_t p_write_data, read_t p_read_data)
+    : m_write_data(p_write_data)
+    , m_read_data(p_read_data)
+    , m_mode(mode::fixed)
+  {
+  }
+
+  constexpr inert_serial(std::span<hal::byte> p_buffer)
+    : m_buffer(p_buffer)
+    , m_mode(mode::loopback)
+  {
+  }
+
+  constexpr inert_serial(std::span<const hal::byte> p_responses)
+    : m_responses(p_responses)
+    , m_mode(mode::replay)
+  {
+  }
+
+  status driver_configure([[maybe_unused]] const settings& p_settings)
+  {
+    return hal::success();
+  };
+
+  result<write_t> driver_write(std::span<const hal::byte> p_data)
+  {
+    if (m_mode == mode::fixed) {
+      return m_write_data;
+    }
+
+    if (m_mode == mode::loopback) {
+      // Copy in at most two contiguous runs: up to the end of the buffer, then
+      // from the start of the buffer up to the read position.
+      auto remaining = p_data.first(
+        std::min(p_data.size(), m_buffer.size() - m_stored));
+      while (!remaining.empty()) {
+        auto tail = (m_head + m_stored) % m_buffer.size();
+        auto run = std::min(remaining.size(), m_buffer.size() - tail);
+        std::copy_n(remaining.begin(), run, m_buffer.begin() + tail);
+        m_stored += run;
+        remaining = remaining.subspan(run);
+      }
+    }
+
+    return write_t{ .data = p_data };
+  };
+
+  result<read_t> driver_read(std::span<hal::byte> p_data)
+  {
+    if (m_mode == mode::fixed) {
+      return m_read_data;
+    }
+
+    if (m_mode == mode::replay) {
+      auto count = std::min(p_data.size(), m_responses.size() - m_position);
+      std::copy_n(m_responses.begin() + m_position, count, p_data.begin());
+      m_position += count;
+      return read_t{
+        .data = p_data.first(count),
+        .available = m_responses.size() - m_position,
+        .capacity = m_responses.size(),
+      };
+    }
+
+    auto count = std::min(p_data.size(), m_stored);
+    auto filled = p_data.first(count);
+    while (!filled.empty()) {
+      auto run = std::min(filled.size(), m_buffer.size() - m_head);
+      std::copy_n(m_buffer.begin() + m_head, run, filled.begin());
+      m_head = (m_head + run) % m_buffer.size();
+      m_stored -= run;
+      filled = filled.subspan(run);
+    }
+
+    return read_t{
+      .data = p_data.first(count),
+      .available = m_stored,
+      .capacity = m_buffer.size(),
+    };
+  };
+
+  result<flush_t> driver_flush()
+  {
+    m_head = 0;
+    m_stored = 0;
+    return flush_t{};
+  };
+
+  write_t m_write_data{};
+  read_t m_read_data{};
+  std::span<hal::byte> m_buffer{};
+  std::span<const hal::byte> m_responses{};
+  std::size_t m_head = 0;
+  std::size_t m_stored = 0;
+  std::size_t m_position = 0;
+  mode m_mode;
+};
+}  // namespace hal::soft
@@ -0,0 +1,125 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+#include <libhal/spi.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Inert implementation of Serial peripheral interface (SPI)
+ * communication protocol hardware
+ *
+ * Beyond accepting transfers and doing nothing, inert_spi can act as if MOSI
+ * were wired to MISO (loopback) or shift in a scripted stream of bytes from a
+ * caller-provided buffer (replay). Neither mode allocates.
+ */
+class inert_spi : public hal::spi
+{
+public:
+  /**
+   * @brief Factory function to create inert_spi object
+   *
+   * @return result<inert_spi> - Constructed inert_spi object
+   */
+  static result<inert_spi> create()
+  {
+    return inert_spi(mode::inert);
+  }
+
+  /**
+   * @brief Factory function to create a loopback inert_spi object
+   *
+   * Every byte shifted out is shifted back in on the same clock. When the
+   * input buffer is longer than the output buffer, the filler byte is looped
+   * back for the remaining bytes.
+   *
+   * @return result<inert_spi> - Constructed inert_spi object
+   */
+  static result<inert_spi> create_loopback()
+  {
+    return inert_spi(mode::loopback);
+  }
+
+  /**
+   * @brief Factory function to create a replaying inert_spi object
+   *
+   * Each transfer shifts in the next bytes of p_responses, continuing where
+   * the previous transfer left off. Once the script is exhausted the
+   * remaining input bytes are set to the filler byte.
+   *
+   * @param p_responses - scripted bytes to be received. The span must outlive
+   * the inert_spi object.
+   * @return result<inert_spi> - Constructed inert_spi object
+   */
+  static result<inert_spi> create_replay(std::span<const hal::byte> p_responses)
+  {
+    return inert_spi(p_responses);
+  }
+
+private:
+  enum class mode
+  {
+    inert,
+    loopback,
+    replay,
+  };
+
+  constexpr inert_spi(mode p_mode)
+    : m_mode(p_mode)
+  {
+  }
+
+  constexpr inert_spi(std::span<const hal::byte> p_responses)
+    : m_responses(p_responses)
+    , m_mode(mode::replay)
+  {
+  }
+
+  status driver_configure([[maybe_unused]] const settings& p_settings)
+  {
+    return hal::success();
+  };
+
+  result<transfer_t> driver_transfer(std::span<const hal::byte> p_data_out,
+                                     std::span<hal::byte> p_data_in,
+                                     hal::byte p_filler)
+  {
+    if (m_mode == mode::inert) {
+      return transfer_t{};
+    }
+
+    std::size_t count = 0;
+    if (m_mode == mode::loopback) {
+      count = std::min(p_data_out.size(), p_data_in.size());
+      std::copy_n(p_data_out.begin(), count, p_data_in.begin());
+    } else {
+      count = std::min(p_data_in.size(), m_responses.size() - m_position);
+      std::copy_n(m_responses.begin() + m_position, count, p_data_in.begin());
+      m_position += count;
+    }
+    std::fill(p_data_in.begin() + count, p_data_in.end(), p_filler);
+
+    return transfer_t{};
+  };
+
+  std::span<const hal::byte> m_responses{};
+  std::size_t m_position = 0;
+  mode m_mode;
+};
+}  // namespace hal::soft
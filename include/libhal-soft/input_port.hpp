@@ -0,0 +1,149 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <libhal/error.hpp>
+#include <libhal/input_pin.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Samples a group of input pins into a single word
+ *
+ * Bit `i` of a read word is the level of pin `i`. Pins can be individually
+ * inverted, which is applied to the whole word with one XOR, so active low
+ * inputs such as keypad rows or DIP switches read as 1 when asserted without
+ * wrapping each pin in an input_pin_inverter. Pins that share a hardware GPIO
+ * port can be sampled with a single register read by creating the port with a
+ * bulk read function instead of pins.
+ *
+ * @tparam PinCount - number of pins in the port, 1 to 32
+ */
+template<std::size_t PinCount>
+class input_port
+{
+public:
+  static_assert(PinCount >= 1 && PinCount <= 32,
+                "PinCount must be between 1 and 32");
+
+  /// Mask with a bit set for every pin of the port
+  static constexpr std::uint32_t port_mask =
+    static_cast<std::uint32_t>((std::uint64_t{ 1 } << PinCount) - 1);
+
+  /**
+   * @brief Reads several pins at once
+   *
+   * Must return the raw level of pin `i` in bit `i`. Bits above PinCount are
+   * ignored.
+   */
+  using bulk_read = result<std::uint32_t>(void);
+
+  /**
+   * @brief Factory function to create an input_port from pins
+   *
+   * @param p_pins - the pins, least significant bit first. The pins must
+   * outlive the port.
+   * @param p_inverted - pins whose level should be inverted
+   * @return result<input_port> - the constructed input_port
+   * @throws std::errc::invalid_argument - if any pin is null
+   */
+  static result<input_port> create(
+    const std::array<hal::input_pin*, PinCount>& p_pins,
+    std::uint32_t p_inverted = 0)
+  {
+    for (auto* pin : p_pins) {
+      if (pin == nullptr) {
+        return hal::new_error(std::errc::invalid_argument);
+      }
+    }
+    return input_port(p_pins, {}, p_inverted);
+  }
+
+  /**
+   * @brief Factory function to create an input_port sampled by a bulk read
+   *
+   * @param p_bulk_read - called once per read to sample every pin
+   * @param p_inverted - pins whose level should be inverted
+   * @return result<input_port> - the constructed input_port
+   * @throws std::errc::invalid_argument - if p_bulk_read is empty
+   */
+  static result<input_port> create(hal::callback<bulk_read> p_bulk_read,
+                                   std::uint32_t p_inverted = 0)
+  {
+    if (!p_bulk_read) {
+      return hal::new_error(std::errc::invalid_argument);
+    }
+    return input_port({}, p_bulk_read, p_inverted);
+  }
+
+  /**
+   * @brief Sample every pin of the port
+   *
+   * @return result<std::uint32_t> - one bit per pin, with inverted pins
+   * already inverted
+   */
+  result<std::uint32_t> read()
+  {
+    std::uint32_t raw = 0;
+    if (m_bulk_read) {
+      raw = HAL_CHECK(m_bulk_read());
+    } else {
+      for (std::size_t i = 0; i < PinCount; i++) {
+        const auto level = HAL_CHECK(m_pins[i]->level());
+        raw |= static_cast<std::uint32_t>(level.state) << i;
+      }
+    }
+    return (raw ^ m_inverted) & port_mask;
+  }
+
+  /**
+   * @brief Get the pins being inverted
+   *
+   * @return std::uint32_t - one bit per inverted pin
+   */
+  [[nodiscard]] std::uint32_t inverted() const
+  {
+    return m_inverted;
+  }
+
+  /**
+   * @brief Change which pins are inverted
+   *
+   * @param p_inverted - one bit per pin to invert, bits above PinCount are
+   * ignored
+   */
+  void inverted(std::uint32_t p_inverted)
+  {
+    m_inverted = p_inverted & port_mask;
+  }
+
+private:
+  input_port(const std::array<hal::input_pin*, PinCount>& p_pins,
+             hal::callback<bulk_read> p_bulk_read,
+             std::uint32_t p_inverted)
+    : m_pins(p_pins)
+    , m_bulk_read(p_bulk_read)
+    , m_inverted(p_inverted & port_mask)
+  {
+  }
+
+  std::array<hal::input_pin*, PinCount> m_pins;
+  hal::callback<bulk_read> m_bulk_read;
+  std::uint32_t m_inverted;
+};
+}  // namespace hal::soft
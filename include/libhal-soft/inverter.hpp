@@ -13,6 +13,8 @@
 // limitations under the License.
 #pragma once
 
+#include <type_traits>
+
 #include <libhal/input_pin.hpp>
 #include <libhal/output_pin.hpp>
 
@@ -68,4 +70,128 @@ private:
 
   hal::input_pin* m_input_pin;
 };
+
+/**
+ * @ingroup Inverter
+ * @brief An output_pin_inverter bound to a concrete output pin type
+ *
+ * Behaves like output_pin_inverter, but when called through its own type
+ * the inversion is inlined into the call to the wrapped pin and no virtual
+ * call is made to the inverter itself. If OutputPin is `final`, the compiler
+ * can also devirtualize the call into the wrapped pin. Use
+ * output_pin_inverter when the pin is only known as a hal::output_pin.
+ *
+ * @tparam OutputPin - concrete output pin type being inverted
+ */
+template<class OutputPin>
+class static_output_pin_inverter final : public hal::output_pin
+{
+public:
+  static_assert(std::is_base_of_v<hal::output_pin, OutputPin>,
+                "OutputPin must implement hal::output_pin");
+
+  /**
+   * @brief Construct a new static_output_pin_inverter from an output pin
+   *
+   * @param p_output_pin The output pin whose signal should be inverted.
+   */
+  explicit static_output_pin_inverter(OutputPin& p_output_pin)
+    : m_output_pin(&p_output_pin)
+  {
+  }
+
+  /// Configure the wrapped pin, without a virtual call to the inverter
+  status configure(const settings& p_settings)
+  {
+    return m_output_pin->configure(p_settings);
+  }
+
+  /// Set the inverted level, without a virtual call to the inverter
+  result<set_level_t> level(bool p_high)
+  {
+    return m_output_pin->level(!p_high);
+  }
+
+  /// Read the inverted level, without a virtual call to the inverter
+  result<level_t> level()
+  {
+    auto level = HAL_CHECK(m_output_pin->level());
+    level.state = !level.state;
+    return level;
+  }
+
+private:
+  status driver_configure(const settings& p_settings) override
+  {
+    return configure(p_settings);
+  }
+
+  result<set_level_t> driver_level(bool p_high) override
+  {
+    return level(p_high);
+  }
+
+  result<level_t> driver_level() override
+  {
+    return level();
+  }
+
+  OutputPin* m_output_pin;
+};
+
+/**
+ * @ingroup Inverter
+ * @brief An input_pin_inverter bound to a concrete input pin type
+ *
+ * Behaves like input_pin_inverter, but when called through its own type the
+ * inversion is inlined into the call to the wrapped pin and no virtual call
+ * is made to the inverter itself. Use input_pin_inverter when the pin is only
+ * known as a hal::input_pin.
+ *
+ * @tparam InputPin - concrete input pin type being inverted
+ */
+template<class InputPin>
+class static_input_pin_inverter final : public hal::input_pin
+{
+public:
+  static_assert(std::is_base_of_v<hal::input_pin, InputPin>,
+                "InputPin must implement hal::input_pin");
+
+  /**
+   * @brief Construct a new static_input_pin_inverter from an input pin
+   *
+   * @param p_input_pin The input pin whose signal should be inverted.
+   */
+  explicit static_input_pin_inverter(InputPin& p_input_pin)
+    : m_input_pin(&p_input_pin)
+  {
+  }
+
+  /// Configure the wrapped pin, without a virtual call to the inverter
+  status configure(const settings& p_settings)
+  {
+    return m_input_pin->configure(p_settings);
+  }
+
+  /// Read the inverted level, without a virtual call to the inverter
+  result<level_t> level()
+  {
+    auto level = HAL_CHECK(m_input_pin->level());
+    level.state = !level.state;
+    return level;
+  }
+
+private:
+  status driver_configure(const settings& p_settings) override
+  {
+    return configure(p_settings);
+  }
+
+  result<level_t> driver_level() override
+  {
+    return level();
+  }
+
+  InputPin* m_input_pin;
+};
 }  // namespace hal::soft
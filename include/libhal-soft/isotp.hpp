@@ -0,0 +1,213 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <libhal/can.hpp>
+#include <libhal/timer.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+/**
+ * @brief One ISO-TP (ISO 15765-2) connection over a CAN bus
+ *
+ * Carries payloads of up to 4 GiB over classic CAN using normal addressing:
+ * single frames for payloads of up to 7 bytes, otherwise a first frame
+ * followed by consecutive frames, paced by the receiver's flow control
+ * frames.
+ *
+ * No data is copied into intermediate buffers. Outgoing consecutive frames
+ * are built straight from the span passed to send(), and received first and
+ * consecutive frames are written straight into the receive buffer at their
+ * final offset. Each session uses a fixed amount of memory, so several
+ * sessions can run at the same time on one bus, each with its own pair of
+ * IDs. Route received messages to a session by passing them to its call
+ * operator, for example from a can_router.
+ *
+ * Sending and receiving are independent and can happen at the same time.
+ * The session must not be moved while a transfer is in flight. Destroying it
+ * cancels the timer of a send in progress.
+ */
+class isotp_session
+{
+public:
+  /// Handler for a completely received payload. The span is only valid until
+  /// the next first frame arrives.
+  using receive_handler = void(std::span<const hal::byte> p_payload);
+
+  /// Delay before retrying a frame that the CAN bus refused
+  static constexpr hal::time_duration retry_delay =
+    std::chrono::microseconds(100);
+
+  /// Largest payload that fits in a 12-bit first frame length
+  static constexpr std::size_t max_short_length = 0xFFF;
+
+  struct settings
+  {
+    /// ID of frames sent by this session
+    hal::can::id_t transmit_id;
+    /// ID of frames sent by the other side of the connection
+    hal::can::id_t receive_id;
+    /// Consecutive frames the other side may send before waiting for the next
+    /// flow control frame. Zero means the whole payload.
+    hal::byte block_size = 0;
+    /// Minimum separation time between consecutive frames requested from the
+    /// other side, in ISO 15765-2 STmin encoding.
+    hal::byte separation_time = 0;
+    /// Byte used to fill unused bytes of each frame up to 8 bytes
+    hal::byte padding = 0xCC;
+    /// Longest wait for a flow control frame while sending, N_Bs
+    hal::time_duration flow_control_timeout = std::chrono::milliseconds(1000);
+    /// Wait flow control frames accepted in a row before giving up, N_WFTmax
+    std::uint8_t max_wait_frames = 10;
+  };
+
+  /**
+   * @brief Factory function to create an isotp_session object
+   *
+   * @param p_can - CAN bus frames are sent on
+   * @param p_timer - timer used to pace consecutive frames and to time out
+   * flow control
+   * @param p_receive_buffer - storage for received payloads. Its size is the
+   * largest payload that can be received. Must outlive the session.
+   * @param p_settings - IDs and flow control parameters of the session
+   * @return result<isotp_session> - the constructed isotp_session object
+   */
+  static result<isotp_session> create(hal::can& p_can,
+                                      hal::timer& p_timer,
+                                      std::span<hal::byte> p_receive_buffer,
+                                      const settings& p_settings);
+
+  isotp_session(isotp_session&& p_other) noexcept;
+  isotp_session& operator=(isotp_session&& p_other) = delete;
+  isotp_session(const isotp_session&) = delete;
+  isotp_session& operator=(const isotp_session&) = delete;
+  ~isotp_session();
+
+  /**
+   * @brief Start sending a payload
+   *
+   * Returns once the first frame has been handed to the CAN bus. The rest of
+   * the payload is sent in the background, as flow control allows. The
+   * transfer is aborted if the receiver does not answer within the flow
+   * control timeout, or asks to wait more than max_wait_frames times in a
+   * row.
+   *
+   * @param p_payload - payload to send. Must stay valid until transmitting()
+   * returns false.
+   * @return status - success or an error
+   * @throws std::errc::device_or_resource_busy - if a payload is still being
+   * sent
+   * @throws std::errc::invalid_argument - if p_payload is empty
+   */
+  status send(std::span<const hal::byte> p_payload);
+
+  /**
+   * @brief Abandon the payload being sent, if any
+   *
+   * The receiver is not told, and times out on its own. Counts as an aborted
+   * transfer if a payload was being sent.
+   */
+  void abort();
+
+  /**
+   * @brief Set the handler called with each completely received payload
+   *
+   * @param p_handler - handler called from the CAN receive context
+   */
+  void on_receive(hal::callback<receive_handler> p_handler);
+
+  /**
+   * @brief Process a frame from the other side of the connection
+   *
+   * Frames with any ID other than the session's receive ID are ignored.
+   *
+   * @param p_message - received CAN message
+   */
+  void operator()(const hal::can::message_t& p_message);
+
+  /**
+   * @brief Check if a payload is still being sent
+   *
+   * @return true - if a transfer is in flight
+   */
+  [[nodiscard]] bool transmitting() const;
+
+  /**
+   * @brief Get the number of transfers aborted by either side
+   *
+   * Counts sends refused by the receiver with an overflow flow control frame,
+   * sends that timed out waiting for flow control or could not be paced,
+   * sends stopped by abort(), and receptions abandoned due to a missing
+   * consecutive frame.
+   *
+   * @return std::size_t - number of aborted transfers
+   */
+  [[nodiscard]] std::size_t aborted_transfers() const;
+
+private:
+  enum class transmit_state : std::uint8_t
+  {
+    idle,
+    waiting_for_flow_control,
+    sending,
+  };
+
+  isotp_session(hal::can& p_can,
+                hal::timer& p_timer,
+                std::span<hal::byte> p_receive_buffer,
+                const settings& p_settings);
+
+  bool send_frame(std::span<const hal::byte> p_header,
+                  std::span<const hal::byte> p_data);
+  void send_flow_control(hal::byte p_flow_status);
+  void send_consecutive_frames();
+  /// Time out the wait for the next flow control frame, N_Bs
+  void await_flow_control();
+  void receive_single_frame(const hal::can::message_t& p_message);
+  void receive_first_frame(const hal::can::message_t& p_message);
+  void receive_consecutive_frame(const hal::can::message_t& p_message);
+  void receive_flow_control(const hal::can::message_t& p_message);
+
+  hal::can* m_can;
+  hal::timer* m_timer;
+  std::span<hal::byte> m_receive_buffer;
+  settings m_settings;
+  hal::callback<receive_handler> m_receive_handler =
+    []([[maybe_unused]] std::span<const hal::byte> p_payload) {};
+
+  // Transmit state
+  std::span<const hal::byte> m_transmit_data{};
+  std::size_t m_transmit_offset = 0;
+  hal::time_duration m_separation_time{};
+  transmit_state m_transmit_state = transmit_state::idle;
+  std::uint8_t m_transmit_sequence = 0;
+  std::uint8_t m_peer_block_size = 0;
+  std::uint8_t m_transmit_block_left = 0;
+  std::uint8_t m_wait_frames = 0;
+
+  // Receive state
+  std::size_t m_receive_length = 0;
+  std::size_t m_receive_offset = 0;
+  std::size_t m_aborted = 0;
+  bool m_receiving = false;
+  std::uint8_t m_receive_sequence = 0;
+  std::uint8_t m_receive_block_left = 0;
+};
+}  // namespace hal::soft
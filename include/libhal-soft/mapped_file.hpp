@@ -0,0 +1,65 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include <libhal/error.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+#if defined(__linux__)
+/**
+ * @brief Read only memory mapping of a whole file
+ *
+ * Only available when building for Linux. Lets large recordings, such as
+ * replay traces, be used as a span without reading them into memory first;
+ * pages are loaded by the kernel as they are touched.
+ */
+class mapped_file
+{
+public:
+  /**
+   * @brief Factory function to map a file into memory
+   *
+   * @param p_path - path to the file
+   * @return result<mapped_file> - the mapping
+   * @throws std::errc - the errno reported by open, fstat or mmap
+   */
+  static result<mapped_file> create(const char* p_path);
+
+  mapped_file(mapped_file&& p_other) noexcept;
+  mapped_file& operator=(mapped_file&& p_other) = delete;
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+  ~mapped_file();
+
+  /**
+   * @brief Get the contents of the file
+   *
+   * @return std::span<const hal::byte> - the mapped bytes, valid for the
+   * lifetime of this object
+   */
+  [[nodiscard]] std::span<const hal::byte> data() const;
+
+private:
+  mapped_file(const hal::byte* p_data, std::size_t p_size);
+
+  const hal::byte* m_data;
+  std::size_t m_size;
+};
+#endif
+}  // namespace hal::soft
@@ -0,0 +1,178 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include <libhal/error.hpp>
+#include <libhal/output_pin.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Drives a group of output pins as a single word
+ *
+ * Bit `i` of a written word sets the level of pin `i`. The port remembers the
+ * last level written to each pin and only writes the pins whose level
+ * changes, so counting up a binary bus touches two pins on average instead of
+ * all of them. Pins that share a hardware GPIO port can be driven with a
+ * single register write by creating the port with a bulk write function
+ * instead of pins.
+ *
+ * Every pin is written on the first write, since its level is unknown until
+ * then.
+ *
+ * @tparam PinCount - number of pins in the port, 1 to 32
+ */
+template<std::size_t PinCount>
+class output_port
+{
+public:
+  static_assert(PinCount >= 1 && PinCount <= 32,
+                "PinCount must be between 1 and 32");
+
+  /// Mask with a bit set for every pin of the port
+  static constexpr std::uint32_t port_mask =
+    static_cast<std::uint32_t>((std::uint64_t{ 1 } << PinCount) - 1);
+
+  /**
+   * @brief Writes several pins at once
+   *
+   * Must set each pin with a bit set in p_mask to the level of the matching
+   * bit of p_value, and leave every other pin alone.
+   */
+  using bulk_write = status(std::uint32_t p_mask, std::uint32_t p_value);
+
+  /**
+   * @brief Factory function to create an output_port from pins
+   *
+   * @param p_pins - the pins, least significant bit first. The pins must
+   * outlive the port.
+   * @return result<output_port> - the constructed output_port
+   * @throws std::errc::invalid_argument - if any pin is null
+   */
+  static result<output_port> create(
+    const std::array<hal::output_pin*, PinCount>& p_pins)
+  {
+    for (auto* pin : p_pins) {
+      if (pin == nullptr) {
+        return hal::new_error(std::errc::invalid_argument);
+      }
+    }
+    return output_port(p_pins, {});
+  }
+
+  /**
+   * @brief Factory function to create an output_port driven by a bulk write
+   *
+   * @param p_bulk_write - called once per write with the changed pins
+   * @return result<output_port> - the constructed output_port
+   * @throws std::errc::invalid_argument - if p_bulk_write is empty
+   */
+  static result<output_port> create(hal::callback<bulk_write> p_bulk_write)
+  {
+    if (!p_bulk_write) {
+      return hal::new_error(std::errc::invalid_argument);
+    }
+    return output_port({}, p_bulk_write);
+  }
+
+  /**
+   * @brief Set every pin of the port
+   *
+   * @param p_value - levels to set, bits above PinCount are ignored
+   * @return status - success or the first error returned by a pin. Pins
+   * written before the error keep their new level and are not written again.
+   */
+  status write(std::uint32_t p_value)
+  {
+    return write(p_value, port_mask);
+  }
+
+  /**
+   * @brief Set some of the pins of the port
+   *
+   * @param p_value - levels to set
+   * @param p_mask - pins to set, every other pin is left alone
+   * @return status - success or the first error returned by a pin. Pins
+   * written before the error keep their new level and are not written again.
+   */
+  status write(std::uint32_t p_value, std::uint32_t p_mask)
+  {
+    auto changed = ((p_value ^ m_value) | ~m_known) & p_mask & port_mask;
+    if (changed == 0) {
+      return hal::success();
+    }
+
+    if (m_bulk_write) {
+      HAL_CHECK(m_bulk_write(changed, p_value & changed));
+      update(changed, p_value);
+      return hal::success();
+    }
+
+    while (changed != 0) {
+      const auto pin = std::countr_zero(changed);
+      const auto bit = std::uint32_t{ 1 } << pin;
+      HAL_CHECK(m_pins[pin]->level((p_value & bit) != 0));
+      update(bit, p_value);
+      changed &= ~bit;
+    }
+    return hal::success();
+  }
+
+  /**
+   * @brief Get the levels last written to the pins
+   *
+   * @return std::uint32_t - one bit per pin, zero for pins never written
+   */
+  [[nodiscard]] std::uint32_t value() const
+  {
+    return m_value;
+  }
+
+  /**
+   * @brief Forget the cached levels so the next write sets every pin
+   *
+   * Use after the pins were driven by something other than this port.
+   */
+  void invalidate()
+  {
+    m_known = 0;
+  }
+
+private:
+  output_port(const std::array<hal::output_pin*, PinCount>& p_pins,
+              hal::callback<bulk_write> p_bulk_write)
+    : m_pins(p_pins)
+    , m_bulk_write(p_bulk_write)
+  {
+  }
+
+  void update(std::uint32_t p_mask, std::uint32_t p_value)
+  {
+    m_value = (m_value & ~p_mask) | (p_value & p_mask);
+    m_known |= p_mask;
+  }
+
+  std::array<hal::output_pin*, PinCount> m_pins;
+  hal::callback<bulk_write> m_bulk_write;
+  /// Last level written to each pin
+  std::uint32_t m_value = 0;
+  /// Pins whose level in m_value is known to be on the pin
+  std::uint32_t m_known = 0;
+};
+}  // namespace hal::soft
@@ -0,0 +1,145 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <libhal/input_pin.hpp>
+#include <libhal/interrupt_pin.hpp>
+#include <libhal/timer.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Samples a group of input pins from a timer and detects their edges
+ *
+ * Provides the polling pass shared by polled_interrupt_pin objects. On every
+ * timer tick each attached pin is read once and the levels are packed into a
+ * word, so the edges of all pins are found with a few bitwise operations and
+ * only the pins with a matching edge cost a handler call. Edges shorter than
+ * the polling period can be missed.
+ *
+ * The poller schedules its timer as soon as one of its pins is configured or
+ * given a handler, and stops once no pins are attached. It must not be moved
+ * while its timer is scheduled.
+ */
+class pin_poller
+{
+public:
+  /// Maximum number of pins per poller
+  static constexpr std::size_t max_pins = 32;
+
+  /**
+   * @brief Factory function to create a pin_poller object
+   *
+   * @param p_timer - timer driving the polling. Must outlive the poller and
+   * must not be used for anything else.
+   * @param p_period - time between polls
+   * @return result<pin_poller> - the constructed pin_poller object
+   * @throws std::errc::invalid_argument - if p_period is not positive
+   */
+  static result<pin_poller> create(hal::timer& p_timer,
+                                   hal::time_duration p_period);
+
+  /**
+   * @brief Sample every attached pin and run the handlers of matching edges
+   *
+   * Called from the timer callback. Can also be called directly, for example
+   * to poll from a main loop.
+   */
+  void poll();
+
+  /**
+   * @brief Get the number of pin reads that returned an error
+   *
+   * A pin whose read fails keeps its previous level for that poll.
+   *
+   * @return std::uint32_t - failed reads
+   */
+  [[nodiscard]] std::uint32_t read_errors() const;
+
+private:
+  friend class polled_interrupt_pin;
+
+  pin_poller(hal::timer& p_timer, hal::time_duration p_period);
+
+  result<std::size_t> attach(hal::input_pin& p_pin);
+  void detach(std::size_t p_index);
+  status configure(std::size_t p_index,
+                   const hal::interrupt_pin::settings& p_settings);
+  void on_trigger(std::size_t p_index,
+                  hal::callback<hal::interrupt_pin::handler> p_handler);
+  void arm();
+
+  hal::timer* m_timer;
+  hal::time_duration m_period;
+  std::array<hal::input_pin*, max_pins> m_pins{};
+  std::array<hal::callback<hal::interrupt_pin::handler>, max_pins> m_handlers{};
+  /// Pins attached to the poller
+  std::uint32_t m_attached = 0;
+  /// Level of each pin as of the last poll
+  std::uint32_t m_levels = 0;
+  /// Pins whose handler runs on a rising edge
+  std::uint32_t m_rising = 0;
+  /// Pins whose handler runs on a falling edge
+  std::uint32_t m_falling = 0;
+  std::uint32_t m_read_errors = 0;
+  bool m_armed = false;
+};
+
+/**
+ * @brief An interrupt_pin for pins without interrupt support
+ *
+ * Built on an input_pin that is sampled by a pin_poller. The handler runs
+ * from the poller's timer callback when the sampled level changes in the
+ * direction chosen by the trigger setting, and is passed the new level.
+ */
+class polled_interrupt_pin : public hal::interrupt_pin
+{
+public:
+  /**
+   * @brief Factory function to create a polled_interrupt_pin object
+   *
+   * The pin starts out triggering on rising edges, the interrupt_pin
+   * default, and its current level is sampled so the first poll does not
+   * report a spurious edge.
+   *
+   * @param p_poller - poller sampling the pin. Must outlive the pin.
+   * @param p_pin - input pin to watch. Must outlive this object.
+   * @return result<polled_interrupt_pin> - the constructed object
+   * @throws std::errc::no_buffer_space - if the poller already has max_pins
+   * pins attached
+   */
+  static result<polled_interrupt_pin> create(pin_poller& p_poller,
+                                             hal::input_pin& p_pin);
+
+  polled_interrupt_pin(polled_interrupt_pin&& p_other) noexcept;
+  polled_interrupt_pin& operator=(polled_interrupt_pin&& p_other) = delete;
+  polled_interrupt_pin(const polled_interrupt_pin&) = delete;
+  polled_interrupt_pin& operator=(const polled_interrupt_pin&) = delete;
+  ~polled_interrupt_pin() override;
+
+private:
+  polled_interrupt_pin(pin_poller& p_poller, std::size_t p_index);
+
+  status driver_configure(const settings& p_settings) override;
+  void driver_on_trigger(hal::callback<handler> p_handler) override;
+
+  pin_poller* m_poller;
+  std::size_t m_index;
+};
+}  // namespace hal::soft
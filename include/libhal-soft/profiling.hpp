@@ -0,0 +1,312 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include <libhal/steady_clock.hpp>
+
+/**
+ * @brief Set to 0 to compile every profiling utility down to nothing
+ *
+ * With profiling disabled, latency_histogram holds no storage, record() does
+ * nothing, every summary value is zero and scoped_timer never reads its
+ * clock, so instrumentation can stay in the code at no cost.
+ */
+#if !defined(HAL_SOFT_PROFILING)
+#define HAL_SOFT_PROFILING 1
+#endif
+
+namespace hal::soft {
+/// Summary of the values recorded in a latency_histogram, in clock ticks
+struct latency_summary
+{
+  std::uint64_t count = 0;
+  std::uint64_t minimum = 0;
+  std::uint64_t maximum = 0;
+  std::uint64_t mean = 0;
+  std::uint64_t p50 = 0;
+  std::uint64_t p90 = 0;
+  std::uint64_t p99 = 0;
+};
+
+/**
+ * @brief Bucket layout of a latency_histogram
+ *
+ * Values below 2^SubBucketBits each get their own bucket. Above that, every
+ * power of two range is split into 2^SubBucketBits equal buckets, so a bucket
+ * is never wider than 1 / 2^SubBucketBits of the values it holds. The layout
+ * is the same whether or not profiling is enabled.
+ *
+ * @tparam SubBucketBits - log2 of the number of buckets per power of two
+ * @tparam ValueBits - values of 2^ValueBits and above are counted as
+ * 2^ValueBits - 1
+ */
+template<std::size_t SubBucketBits, std::size_t ValueBits>
+class latency_buckets
+{
+public:
+  static_assert(SubBucketBits < ValueBits && ValueBits <= 64);
+
+  /// Number of buckets in the histogram
+  static constexpr std::size_t bucket_count = (ValueBits - SubBucketBits + 1)
+                                              << SubBucketBits;
+
+  /**
+   * @brief Get the bucket a value is counted in
+   *
+   * @param p_value - value to look up
+   * @return std::size_t - index of the value's bucket
+   */
+  static constexpr std::size_t bucket_of(std::uint64_t p_value)
+  {
+    constexpr std::uint64_t max_value =
+      (ValueBits == 64) ? std::numeric_limits<std::uint64_t>::max()
+                        : (std::uint64_t{ 1 } << ValueBits) - 1;
+    const auto value = std::min(p_value, max_value);
+    if (value < sub_bucket_count) {
+      return static_cast<std::size_t>(value);
+    }
+    const auto shift = std::bit_width(value) - 1 - SubBucketBits;
+    const auto group = shift + 1;
+    const auto sub_bucket = (value >> shift) - sub_bucket_count;
+    return static_cast<std::size_t>((group << SubBucketBits) + sub_bucket);
+  }
+
+  /**
+   * @brief Get the largest value counted in a bucket
+   *
+   * @param p_bucket - bucket index, below bucket_count
+   * @return std::uint64_t - largest value of the bucket
+   */
+  static constexpr std::uint64_t upper_bound(std::size_t p_bucket)
+  {
+    const std::uint64_t group = p_bucket >> SubBucketBits;
+    const std::uint64_t sub_bucket = p_bucket & (sub_bucket_count - 1);
+    if (group == 0) {
+      return sub_bucket;
+    }
+    const auto shift = group - 1;
+    return ((sub_bucket_count + sub_bucket + 1) << shift) - 1;
+  }
+
+private:
+  static constexpr std::uint64_t sub_bucket_count = std::uint64_t{ 1 }
+                                                    << SubBucketBits;
+};
+
+#if HAL_SOFT_PROFILING
+
+/**
+ * @brief Fixed memory histogram with log-linear buckets
+ *
+ * Buckets are laid out as described by latency_buckets. Recording a value
+ * finds its bucket with a bit width count and two shifts.
+ *
+ * Percentiles are reported as the largest value of the bucket they fall in,
+ * capped at the largest recorded value, so they are never under-reported.
+ *
+ * @tparam SubBucketBits - log2 of the number of buckets per power of two
+ * @tparam ValueBits - values of 2^ValueBits and above are counted as
+ * 2^ValueBits - 1
+ */
+template<std::size_t SubBucketBits = 3, std::size_t ValueBits = 32>
+class latency_histogram
+  : public latency_buckets<SubBucketBits, ValueBits>
+{
+public:
+  using latency_buckets<SubBucketBits, ValueBits>::bucket_count;
+  using latency_buckets<SubBucketBits, ValueBits>::bucket_of;
+  using latency_buckets<SubBucketBits, ValueBits>::upper_bound;
+
+  /**
+   * @brief Count a value
+   *
+   * @param p_value - value to count, usually a duration in clock ticks
+   */
+  void record(std::uint64_t p_value)
+  {
+    m_buckets[bucket_of(p_value)]++;
+    m_count++;
+    m_sum += p_value;
+    m_minimum = std::min(m_minimum, p_value);
+    m_maximum = std::max(m_maximum, p_value);
+  }
+
+  /**
+   * @brief Forget every recorded value
+   */
+  void reset()
+  {
+    *this = latency_histogram{};
+  }
+
+  /**
+   * @brief Get the value below which a share of the recorded values fall
+   *
+   * @param p_percentile - share of values between 0.0 and 100.0
+   * @return std::uint64_t - the percentile value, 0 if nothing was recorded
+   */
+  [[nodiscard]] std::uint64_t percentile(float p_percentile) const
+  {
+    if (m_count == 0) {
+      return 0;
+    }
+    const auto share = std::clamp(p_percentile, 0.0f, 100.0f) / 100.0;
+    const auto rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(share * m_count + 0.5));
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; i++) {
+      seen += m_buckets[i];
+      if (seen >= rank) {
+        return std::min(upper_bound(i), m_maximum);
+      }
+    }
+    return m_maximum;
+  }
+
+  /**
+   * @brief Summarize the recorded values
+   *
+   * @return latency_summary - count, extremes, mean and common percentiles
+   */
+  [[nodiscard]] latency_summary summary() const
+  {
+    if (m_count == 0) {
+      return latency_summary{};
+    }
+    return latency_summary{
+      .count = m_count,
+      .minimum = m_minimum,
+      .maximum = m_maximum,
+      .mean = m_sum / m_count,
+      .p50 = percentile(50.0f),
+      .p90 = percentile(90.0f),
+      .p99 = percentile(99.0f),
+    };
+  }
+
+  /**
+   * @brief Get the number of values counted in a bucket
+   *
+   * @param p_bucket - bucket index, below bucket_count
+   * @return std::uint32_t - number of values in the bucket
+   */
+  [[nodiscard]] std::uint32_t bucket(std::size_t p_bucket) const
+  {
+    return m_buckets[p_bucket];
+  }
+
+private:
+  std::array<std::uint32_t, bucket_count> m_buckets{};
+  std::uint64_t m_count = 0;
+  std::uint64_t m_sum = 0;
+  std::uint64_t m_minimum = std::numeric_limits<std::uint64_t>::max();
+  std::uint64_t m_maximum = 0;
+};
+
+/**
+ * @brief Records the time spent in a scope into a histogram
+ *
+ * Reads the clock when constructed and again when destroyed, and records the
+ * difference in clock ticks.
+ *
+ * @tparam Histogram - histogram type with a record(std::uint64_t) function
+ */
+template<class Histogram>
+class scoped_timer
+{
+public:
+  /**
+   * @brief Start timing a scope
+   *
+   * @param p_clock - clock to measure the scope with
+   * @param p_histogram - histogram that receives the measured ticks
+   */
+  scoped_timer(hal::steady_clock& p_clock, Histogram& p_histogram)
+    : m_clock(&p_clock)
+    , m_histogram(&p_histogram)
+    , m_start(p_clock.uptime().ticks)
+  {
+  }
+
+  scoped_timer(const scoped_timer&) = delete;
+  scoped_timer& operator=(const scoped_timer&) = delete;
+
+  ~scoped_timer()
+  {
+    m_histogram->record(m_clock->uptime().ticks - m_start);
+  }
+
+private:
+  hal::steady_clock* m_clock;
+  Histogram* m_histogram;
+  std::uint64_t m_start;
+};
+
+#else
+
+template<std::size_t SubBucketBits = 3, std::size_t ValueBits = 32>
+class latency_histogram
+  : public latency_buckets<SubBucketBits, ValueBits>
+{
+public:
+  void record([[maybe_unused]] std::uint64_t p_value)
+  {
+  }
+
+  void reset()
+  {
+  }
+
+  [[nodiscard]] std::uint64_t percentile(
+    [[maybe_unused]] float p_percentile) const
+  {
+    return 0;
+  }
+
+  [[nodiscard]] latency_summary summary() const
+  {
+    return latency_summary{};
+  }
+
+  [[nodiscard]] std::uint32_t bucket(
+    [[maybe_unused]] std::size_t p_bucket) const
+  {
+    return 0;
+  }
+};
+
+template<class Histogram>
+class scoped_timer
+{
+public:
+  scoped_timer([[maybe_unused]] hal::steady_clock& p_clock,
+               [[maybe_unused]] Histogram& p_histogram)
+  {
+  }
+
+  scoped_timer(const scoped_timer&) = delete;
+  scoped_timer& operator=(const scoped_timer&) = delete;
+};
+
+#endif
+}  // namespace hal::soft
@@ -0,0 +1,130 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <libhal/dac.hpp>
+#include <libhal/pwm.hpp>
+#include <libhal/timer.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+/**
+ * @brief A dac made from a pwm channel, for use with an RC low pass filter
+ *
+ * Output percentages map linearly onto a duty cycle range, with the mapping
+ * precomputed so each write costs one multiply-add.
+ *
+ * In dither mode, a timer periodically nudges the duty cycle between the two
+ * hardware steps surrounding the requested value, using a first order
+ * sigma-delta modulator. Averaged by the output filter, the result resolves
+ * values up to 65536 times finer than the PWM's native step. The percentage
+ * is mapped onto steps in fixed point with 24 bits of resolution, so the full
+ * 16-bit fraction is only reached with up to 256 steps. Finer PWMs resolve
+ * 2^24 levels across the whole range. The timer stops whenever the requested
+ * value falls exactly on a hardware step.
+ *
+ * Moving a dithering pwm_dac re-arms the timer for the new object, and
+ * destroying it cancels the timer.
+ */
+class pwm_dac : public hal::dac
+{
+public:
+  struct settings
+  {
+    /// PWM frequency, well above the cutoff of the output filter
+    hal::hertz frequency = 20'000.0f;
+    /// Duty cycle output for 0%
+    float minimum_duty_cycle = 0.0f;
+    /// Duty cycle output for 100%
+    float maximum_duty_cycle = 1.0f;
+  };
+
+  struct dither_settings
+  {
+    /// Number of duty cycle steps the PWM hardware can produce, at most 65535
+    std::uint32_t steps = 256;
+    /// Time between dither updates, typically one or a few PWM periods
+    hal::time_duration period = std::chrono::microseconds(100);
+  };
+
+  /**
+   * @brief Factory function to create a pwm_dac object
+   *
+   * @param p_pwm - pwm channel driving the output. Must outlive the dac.
+   * @param p_settings - PWM frequency and duty cycle range
+   * @return result<pwm_dac> - the constructed pwm_dac object
+   * @throws std::errc::invalid_argument - if a duty cycle limit is outside of
+   * 0.0 to 1.0
+   */
+  static result<pwm_dac> create(hal::pwm& p_pwm, const settings& p_settings);
+
+  /**
+   * @brief Factory function to create a dithering pwm_dac object
+   *
+   * @param p_pwm - pwm channel driving the output. Must outlive the dac.
+   * @param p_timer - timer running the dither updates. Must outlive the dac
+   * and must not be used for anything else.
+   * @param p_settings - PWM frequency and duty cycle range
+   * @param p_dither - PWM resolution and dither update period
+   * @return result<pwm_dac> - the constructed pwm_dac object
+   * @throws std::errc::invalid_argument - if a duty cycle limit is outside of
+   * 0.0 to 1.0, steps is zero or above 65535, or the period is not positive
+   */
+  static result<pwm_dac> create(hal::pwm& p_pwm,
+                                hal::timer& p_timer,
+                                const settings& p_settings,
+                                const dither_settings& p_dither);
+
+  pwm_dac(pwm_dac&& p_other) noexcept;
+  pwm_dac& operator=(pwm_dac&& p_other) = delete;
+  pwm_dac(const pwm_dac&) = delete;
+  pwm_dac& operator=(const pwm_dac&) = delete;
+  ~pwm_dac() override;
+
+private:
+  pwm_dac(hal::pwm& p_pwm,
+          hal::timer* p_timer,
+          const settings& p_settings,
+          const dither_settings& p_dither);
+
+  result<write_t> driver_write(float p_percentage) override;
+
+  /// Output the next dithered step and reschedule while there is a fraction
+  status dither();
+
+  hal::pwm* m_pwm;
+  /// Null unless dithering
+  hal::timer* m_timer;
+  hal::time_duration m_period;
+  /// duty cycle = m_offset + percentage * m_scale
+  float m_offset;
+  float m_scale;
+  /// Duty cycle of one hardware step
+  float m_step_size;
+  /// Requested output in hardware steps, 16.16 fixed point, is
+  /// m_fixed_offset + ((percentage in 0.24 fixed point * m_fixed_scale) >> 24)
+  std::uint32_t m_fixed_offset;
+  std::int64_t m_fixed_scale;
+  /// Requested output in hardware steps, 16.16 fixed point
+  std::uint32_t m_target = 0;
+  /// Sigma-delta error accumulator, 16 bit fraction
+  std::uint32_t m_accumulator = 0;
+  /// Set while the timer is armed, only cleared when it is not re-armed
+  bool m_dithering = false;
+};
+}  // namespace hal::soft
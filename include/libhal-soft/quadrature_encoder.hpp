@@ -0,0 +1,131 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include <libhal/interrupt_pin.hpp>
+#include <libhal/rotation_sensor.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Decodes a quadrature encoder into a rotation_sensor
+ *
+ * Each edge on channel A or B is decoded with a 16 entry lookup table indexed
+ * by the previous and the new channel state, giving -1, 0 or +1 counts with
+ * no branches, and added to a 64-bit count that cannot overflow in practice.
+ * Transitions that skip a state, which happen when an edge was missed, count
+ * as zero. Channel A leading channel B counts up.
+ *
+ * Edges can come from two interrupt pins, or from samples fed to update(),
+ * for example from an input_port read on a timer. The pin handlers follow
+ * the encoder when it is moved, and are replaced with no-ops when it is
+ * destroyed.
+ *
+ * Both channels are assumed to be low when the encoder is created.
+ */
+class quadrature_encoder : public hal::rotation_sensor
+{
+public:
+  /**
+   * @brief Factory function to create a quadrature_encoder fed by update()
+   *
+   * @param p_counts_per_revolution - counts per turn of the shaft, which is
+   * four times the line count of the encoder
+   * @return result<quadrature_encoder> - the constructed encoder
+   * @throws std::errc::invalid_argument - if p_counts_per_revolution is zero
+   */
+  static result<quadrature_encoder> create(
+    std::uint32_t p_counts_per_revolution);
+
+  /**
+   * @brief Factory function to create a quadrature_encoder on interrupt pins
+   *
+   * Both pins are configured to trigger on both edges, keeping their
+   * resistor settings at the interrupt_pin default.
+   *
+   * @param p_channel_a - interrupt pin of channel A. Must outlive the
+   * encoder.
+   * @param p_channel_b - interrupt pin of channel B. Must outlive the
+   * encoder.
+   * @param p_counts_per_revolution - counts per turn of the shaft, which is
+   * four times the line count of the encoder
+   * @return result<quadrature_encoder> - the constructed encoder
+   * @throws std::errc::invalid_argument - if p_counts_per_revolution is zero
+   */
+  static result<quadrature_encoder> create(
+    hal::interrupt_pin& p_channel_a,
+    hal::interrupt_pin& p_channel_b,
+    std::uint32_t p_counts_per_revolution);
+
+  quadrature_encoder(quadrature_encoder&& p_other) noexcept;
+  quadrature_encoder& operator=(quadrature_encoder&& p_other) = delete;
+  quadrature_encoder(const quadrature_encoder&) = delete;
+  quadrature_encoder& operator=(const quadrature_encoder&) = delete;
+  ~quadrature_encoder() override;
+
+  /**
+   * @brief Feed a new sample of both channels
+   *
+   * Safe to call from an interrupt while count() or read() run in the main
+   * context.
+   *
+   * @param p_channel_a - level of channel A
+   * @param p_channel_b - level of channel B
+   */
+  void update(bool p_channel_a, bool p_channel_b);
+
+  /**
+   * @brief Get the number of counts moved since creation or reset
+   *
+   * @return std::int64_t - counts, negative when turned backwards
+   */
+  [[nodiscard]] std::int64_t count() const;
+
+  /**
+   * @brief Set the count, for example to zero it at a home position
+   *
+   * Must not run concurrently with update().
+   *
+   * @param p_count - new count
+   */
+  void reset(std::int64_t p_count = 0);
+
+private:
+  quadrature_encoder(hal::interrupt_pin* p_channel_a,
+                     hal::interrupt_pin* p_channel_b,
+                     std::uint32_t p_counts_per_revolution);
+
+  result<read_t> driver_read() override;
+
+  /// Register the edge handlers, which refer to this object
+  void attach();
+  /// Replace the edge handlers with ones that ignore every edge
+  void detach();
+  void decode(std::uint8_t p_state);
+
+  /// Both null when fed by update() or once moved from
+  hal::interrupt_pin* m_channel_a;
+  hal::interrupt_pin* m_channel_b;
+  double m_degrees_per_count;
+  std::int64_t m_count = 0;
+  /// Odd while m_count is being written, so readers can retry torn reads
+  std::atomic<std::uint32_t> m_updates{ 0 };
+  /// A in bit 1, B in bit 0
+  std::uint8_t m_state = 0;
+};
+}  // namespace hal::soft
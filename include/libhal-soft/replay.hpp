@@ -0,0 +1,898 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <libhal-soft/trace_ring.hpp>
+#include <libhal/accelerometer.hpp>
+#include <libhal/adc.hpp>
+#include <libhal/distance_sensor.hpp>
+#include <libhal/error.hpp>
+#include <libhal/gyroscope.hpp>
+#include <libhal/i2c.hpp>
+#include <libhal/input_pin.hpp>
+#include <libhal/magnetometer.hpp>
+#include <libhal/rotation_sensor.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/spi.hpp>
+#include <libhal/temperature_sensor.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Writes driver responses into a compact binary replay trace
+ *
+ * A replay trace starts with an 8 byte header: the magic "HRPL" followed by
+ * the little endian format version and 2 reserved bytes. After that comes a
+ * sequence of entries, each with a 6 byte header followed by its payload:
+ *
+ *     u16 source | u8 call | u8 failed | u16 payload length | payload...
+ *
+ * All values are little endian. `call` is a trace_call, `failed` is 1 when
+ * the recorded driver returned an error, and the payload holds the response,
+ * for example the bytes read by an i2c transaction.
+ *
+ * Entries are written into a caller supplied buffer and can be streamed out
+ * with flush(). Once an entry does not fit, the trace is truncated: that entry
+ * and every later one are counted as dropped rather than recorded, so a
+ * replay never sees a trace with holes in it.
+ */
+class trace_recorder
+{
+public:
+  /// Size of the trace header in bytes
+  static constexpr std::size_t header_size = 8;
+  /// Size of an entry header in bytes
+  static constexpr std::size_t entry_header_size = 6;
+  /// Version of the trace format
+  static constexpr std::uint16_t format_version = 1;
+
+  /**
+   * @brief Factory function to create a trace_recorder object
+   *
+   * @param p_buffer - storage for the trace. Must be at least header_size
+   * bytes and must outlive the recorder.
+   * @return result<trace_recorder> - the constructed trace_recorder
+   * @throws std::errc::invalid_argument - if p_buffer cannot hold the header
+   */
+  static result<trace_recorder> create(std::span<hal::byte> p_buffer);
+
+  /**
+   * @brief Append an entry to the trace
+   *
+   * @param p_source - ID of the recorded driver
+   * @param p_call - call that produced the response
+   * @param p_failed - true if the call returned an error
+   * @param p_payload - the response, at most 65535 bytes
+   * @return true if the entry was recorded, false if it was dropped
+   */
+  bool append(std::uint16_t p_source,
+              trace_call p_call,
+              bool p_failed,
+              std::span<const hal::byte> p_payload);
+
+  /**
+   * @brief Get the bytes recorded since creation or the last flush
+   *
+   * @return std::span<const hal::byte> - recorded bytes
+   */
+  [[nodiscard]] std::span<const hal::byte> recorded() const;
+
+  /**
+   * @brief Get the free space left in the buffer
+   *
+   * Callers streaming a long recording should flush before this drops below
+   * the size of the entries they are about to record.
+   *
+   * @return std::size_t - free bytes, including room for entry headers
+   */
+  [[nodiscard]] std::size_t available() const;
+
+  /**
+   * @brief Write the recorded bytes to a serial port and empty the buffer
+   *
+   * The header is part of the first flush, so concatenating everything
+   * written to the port produces a complete trace.
+   *
+   * @param p_port - port to write the trace to
+   * @return status - success or the error returned by the port
+   */
+  status flush(hal::serial& p_port);
+
+  /**
+   * @brief Get the number of entries dropped because the buffer was full
+   *
+   * @return std::uint32_t - dropped entries
+   */
+  [[nodiscard]] std::uint32_t dropped() const;
+
+private:
+  explicit trace_recorder(std::span<hal::byte> p_buffer);
+
+  std::span<hal::byte> m_buffer;
+  std::size_t m_size = 0;
+  std::uint32_t m_dropped = 0;
+};
+
+/// One entry of a replay trace
+struct trace_entry
+{
+  std::uint16_t source = 0;
+  trace_call call{};
+  bool failed = false;
+  /// Points into the trace passed to trace_player
+  std::span<const hal::byte> payload{};
+};
+
+/**
+ * @brief Reads entries back out of a replay trace
+ *
+ * The player never copies or allocates, entries point straight into the
+ * trace. Every replay driver keeps its own cursor into the trace, so drivers
+ * with different sources consume their entries independently of each other.
+ */
+class trace_player
+{
+public:
+  /**
+   * @brief Factory function to create a trace_player object
+   *
+   * @param p_trace - a complete trace, such as a mapped_file. Must outlive
+   * the player and every replay driver using it.
+   * @return result<trace_player> - the constructed trace_player
+   * @throws std::errc::illegal_byte_sequence - if the header is missing or
+   * its magic does not match
+   * @throws std::errc::not_supported - if the format version is unknown
+   */
+  static result<trace_player> create(std::span<const hal::byte> p_trace);
+
+  /**
+   * @brief Find the next entry of a source
+   *
+   * @param p_source - ID of the driver to find entries for
+   * @param p_call - call the entry is expected to be for
+   * @param p_cursor - offset to search from, advanced past the found entry.
+   * Start with zero.
+   * @return result<trace_entry> - the entry
+   * @throws std::errc::no_message - if the source has no entries left
+   * @throws std::errc::invalid_argument - if the entry was recorded for a
+   * different call, meaning the replayed code diverged from the recording
+   * @throws std::errc::illegal_byte_sequence - if the trace is truncated
+   */
+  result<trace_entry> next(std::uint16_t p_source,
+                           trace_call p_call,
+                           std::size_t& p_cursor) const;
+
+private:
+  explicit trace_player(std::span<const hal::byte> p_trace);
+
+  std::span<const hal::byte> m_trace;
+};
+
+/**
+ * @brief Payload made of a fixed number of little endian floats
+ *
+ * @tparam Count - number of floats in the payload
+ */
+template<std::size_t Count>
+struct float_payload
+{
+  /// Size of the payload in bytes
+  static constexpr std::size_t payload_size = Count * sizeof(float);
+
+  static void encode(const std::array<float, Count>& p_values,
+                     std::span<hal::byte, payload_size> p_bytes)
+  {
+    for (std::size_t i = 0; i < Count; i++) {
+      const auto bits = std::bit_cast<std::uint32_t>(p_values[i]);
+      for (std::size_t b = 0; b < sizeof(float); b++) {
+        p_bytes[i * sizeof(float) + b] =
+          static_cast<hal::byte>(bits >> (8 * b));
+      }
+    }
+  }
+
+  static std::array<float, Count> decode(
+    std::span<const hal::byte, payload_size> p_bytes)
+  {
+    std::array<float, Count> values{};
+    for (std::size_t i = 0; i < Count; i++) {
+      std::uint32_t bits = 0;
+      for (std::size_t b = 0; b < sizeof(float); b++) {
+        bits |= std::uint32_t{ p_bytes[i * sizeof(float) + b] } << (8 * b);
+      }
+      values[i] = std::bit_cast<float>(bits);
+    }
+    return values;
+  }
+};
+
+/**
+ * @brief Describes how a sensor's read_t is stored in a replay trace
+ *
+ * Specialized for each interface with a single read() call. Provides the
+ * trace_call of the read and conversions between read_t and an array of
+ * floats.
+ *
+ * @tparam Interface - libhal sensor interface
+ */
+template<class Interface>
+struct replay_traits;
+
+template<>
+struct replay_traits<hal::adc> : float_payload<1>
+{
+  static constexpr auto call = trace_call::adc_read;
+  static std::array<float, 1> values(const hal::adc::read_t& p_read)
+  {
+    return { p_read.sample };
+  }
+  static hal::adc::read_t from(const std::array<float, 1>& p_values)
+  {
+    return { .sample = p_values[0] };
+  }
+};
+
+template<>
+struct replay_traits<hal::rotation_sensor> : float_payload<1>
+{
+  static constexpr auto call = trace_call::rotation_sensor_read;
+  static std::array<float, 1> values(const hal::rotation_sensor::read_t& p_read)
+  {
+    return { p_read.angle };
+  }
+  static hal::rotation_sensor::read_t from(const std::array<float, 1>& p_values)
+  {
+    return { .angle = p_values[0] };
+  }
+};
+
+template<>
+struct replay_traits<hal::temperature_sensor> : float_payload<1>
+{
+  static constexpr auto call = trace_call::temperature_sensor_read;
+  static std::array<float, 1> values(
+    const hal::temperature_sensor::read_t& p_read)
+  {
+    return { p_read.temperature };
+  }
+  static hal::temperature_sensor::read_t from(
+    const std::array<float, 1>& p_values)
+  {
+    return { .temperature = p_values[0] };
+  }
+};
+
+template<>
+struct replay_traits<hal::distance_sensor> : float_payload<1>
+{
+  static constexpr auto call = trace_call::distance_sensor_read;
+  static std::array<float, 1> values(const hal::distance_sensor::read_t& p_read)
+  {
+    return { p_read.distance };
+  }
+  static hal::distance_sensor::read_t from(const std::array<float, 1>& p_values)
+  {
+    return { .distance = p_values[0] };
+  }
+};
+
+template<>
+struct replay_traits<hal::accelerometer> : float_payload<3>
+{
+  static constexpr auto call = trace_call::accelerometer_read;
+  static std::array<float, 3> values(const hal::accelerometer::read_t& p_read)
+  {
+    return { p_read.x, p_read.y, p_read.z };
+  }
+  static hal::accelerometer::read_t from(const std::array<float, 3>& p_values)
+  {
+    return { .x = p_values[0], .y = p_values[1], .z = p_values[2] };
+  }
+};
+
+template<>
+struct replay_traits<hal::gyroscope> : float_payload<3>
+{
+  static constexpr auto call = trace_call::gyroscope_read;
+  static std::array<float, 3> values(const hal::gyroscope::read_t& p_read)
+  {
+    return { p_read.x, p_read.y, p_read.z };
+  }
+  static hal::gyroscope::read_t from(const std::array<float, 3>& p_values)
+  {
+    return { .x = p_values[0], .y = p_values[1], .z = p_values[2] };
+  }
+};
+
+template<>
+struct replay_traits<hal::magnetometer> : float_payload<3>
+{
+  static constexpr auto call = trace_call::magnetometer_read;
+  static std::array<float, 3> values(const hal::magnetometer::read_t& p_read)
+  {
+    return { p_read.x, p_read.y, p_read.z };
+  }
+  static hal::magnetometer::read_t from(const std::array<float, 3>& p_values)
+  {
+    return { .x = p_values[0], .y = p_values[1], .z = p_values[2] };
+  }
+};
+
+/**
+ * @brief Decorator that records a driver's responses into a replay trace
+ *
+ * The primary template handles sensors described by replay_traits, the
+ * specializations handle input_pin, i2c, spi and serial. Every call is
+ * forwarded to the wrapped driver and its result is returned unchanged.
+ *
+ * @tparam Interface - libhal interface to record
+ */
+template<class Interface>
+class recording : public Interface
+{
+public:
+  using traits = replay_traits<Interface>;
+  using read_t = typename Interface::read_t;
+
+  /**
+   * @brief Factory function to create a recording driver
+   *
+   * @param p_driver - driver to record
+   * @param p_recorder - recorder receiving the responses
+   * @param p_source - ID the entries are recorded under
+   * @return result<recording> - the constructed decorator
+   */
+  static result<recording> create(Interface& p_driver,
+                                  trace_recorder& p_recorder,
+                                  std::uint16_t p_source)
+  {
+    return recording(p_driver, p_recorder, p_source);
+  }
+
+private:
+  recording(Interface& p_driver,
+            trace_recorder& p_recorder,
+            std::uint16_t p_source)
+    : m_driver(&p_driver)
+    , m_recorder(&p_recorder)
+    , m_source(p_source)
+  {
+  }
+
+  result<read_t> driver_read() override
+  {
+    auto result = m_driver->read();
+    std::array<hal::byte, traits::payload_size> payload{};
+    if (result) {
+      traits::encode(traits::values(result.value()), payload);
+    }
+    m_recorder->append(m_source,
+                       traits::call,
+                       !result,
+                       std::span<const hal::byte>(payload).first(
+                         result ? payload.size() : 0));
+    return result;
+  }
+
+  Interface* m_driver;
+  trace_recorder* m_recorder;
+  std::uint16_t m_source;
+};
+
+template<>
+class recording<hal::input_pin> : public hal::input_pin
+{
+public:
+  /**
+   * @brief Factory function to create a recording input_pin
+   *
+   * @param p_driver - input pin to record
+   * @param p_recorder - recorder receiving the levels read
+   * @param p_source - ID the entries are recorded under
+   * @return result<recording> - the constructed decorator
+   */
+  static result<recording> create(hal::input_pin& p_driver,
+                                  trace_recorder& p_recorder,
+                                  std::uint16_t p_source)
+  {
+    return recording(p_driver, p_recorder, p_source);
+  }
+
+private:
+  recording(hal::input_pin& p_driver,
+            trace_recorder& p_recorder,
+            std::uint16_t p_source)
+    : m_driver(&p_driver)
+    , m_recorder(&p_recorder)
+    , m_source(p_source)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    return m_driver->configure(p_settings);
+  }
+
+  result<level_t> driver_level() override
+  {
+    auto result = m_driver->level();
+    const std::array<hal::byte, 1> payload{ static_cast<hal::byte>(
+      result && result.value().state) };
+    m_recorder->append(m_source,
+                       trace_call::input_pin_level,
+                       !result,
+                       std::span(payload).first(result ? 1 : 0));
+    return result;
+  }
+
+  hal::input_pin* m_driver;
+  trace_recorder* m_recorder;
+  std::uint16_t m_source;
+};
+
+template<>
+class recording<hal::i2c> : public hal::i2c
+{
+public:
+  /**
+   * @brief Factory function to create a recording i2c
+   *
+   * @param p_driver - i2c to record
+   * @param p_recorder - recorder receiving the bytes read by transactions
+   * @param p_source - ID the entries are recorded under
+   * @return result<recording> - the constructed decorator
+   */
+  static result<recording> create(hal::i2c& p_driver,
+                                  trace_recorder& p_recorder,
+                                  std::uint16_t p_source)
+  {
+    return recording(p_driver, p_recorder, p_source);
+  }
+
+private:
+  recording(hal::i2c& p_driver,
+            trace_recorder& p_recorder,
+            std::uint16_t p_source)
+    : m_driver(&p_driver)
+    , m_recorder(&p_recorder)
+    , m_source(p_source)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    return m_driver->configure(p_settings);
+  }
+
+  result<transaction_t> driver_transaction(
+    hal::byte p_address,
+    std::span<const hal::byte> p_data_out,
+    std::span<hal::byte> p_data_in,
+    hal::function_ref<hal::timeout_function> p_timeout) override
+  {
+    auto result =
+      m_driver->transaction(p_address, p_data_out, p_data_in, p_timeout);
+    m_recorder->append(m_source,
+                       trace_call::i2c_transaction,
+                       !result,
+                       p_data_in.first(result ? p_data_in.size() : 0));
+    return result;
+  }
+
+  hal::i2c* m_driver;
+  trace_recorder* m_recorder;
+  std::uint16_t m_source;
+};
+
+template<>
+class recording<hal::spi> : public hal::spi
+{
+public:
+  /**
+   * @brief Factory function to create a recording spi
+   *
+   * @param p_driver - spi to record
+   * @param p_recorder - recorder receiving the bytes read by transfers
+   * @param p_source - ID the entries are recorded under
+   * @return result<recording> - the constructed decorator
+   */
+  static result<recording> create(hal::spi& p_driver,
+                                  trace_recorder& p_recorder,
+                                  std::uint16_t p_source)
+  {
+    return recording(p_driver, p_recorder, p_source);
+  }
+
+private:
+  recording(hal::spi& p_driver,
+            trace_recorder& p_recorder,
+            std::uint16_t p_source)
+    : m_driver(&p_driver)
+    , m_recorder(&p_recorder)
+    , m_source(p_source)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    return m_driver->configure(p_settings);
+  }
+
+  result<transfer_t> driver_transfer(std::span<const hal::byte> p_data_out,
+                                     std::span<hal::byte> p_data_in,
+                                     hal::byte p_filler) override
+  {
+    auto result = m_driver->transfer(p_data_out, p_data_in, p_filler);
+    m_recorder->append(m_source,
+                       trace_call::spi_transfer,
+                       !result,
+                       p_data_in.first(result ? p_data_in.size() : 0));
+    return result;
+  }
+
+  hal::spi* m_driver;
+  trace_recorder* m_recorder;
+  std::uint16_t m_source;
+};
+
+template<>
+class recording<hal::serial> : public hal::serial
+{
+public:
+  /**
+   * @brief Factory function to create a recording serial
+   *
+   * Only reads are recorded, everything else is forwarded untouched.
+   *
+   * @param p_driver - serial port to record
+   * @param p_recorder - recorder receiving the bytes read
+   * @param p_source - ID the entries are recorded under
+   * @return result<recording> - the constructed decorator
+   */
+  static result<recording> create(hal::serial& p_driver,
+                                  trace_recorder& p_recorder,
+                                  std::uint16_t p_source)
+  {
+    return recording(p_driver, p_recorder, p_source);
+  }
+
+private:
+  recording(hal::serial& p_driver,
+            trace_recorder& p_recorder,
+            std::uint16_t p_source)
+    : m_driver(&p_driver)
+    , m_recorder(&p_recorder)
+    , m_source(p_source)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    return m_driver->configure(p_settings);
+  }
+
+  result<write_t> driver_write(std::span<const hal::byte> p_data) override
+  {
+    return m_driver->write(p_data);
+  }
+
+  result<read_t> driver_read(std::span<hal::byte> p_data) override
+  {
+    auto result = m_driver->read(p_data);
+    m_recorder->append(
+      m_source,
+      trace_call::serial_read,
+      !result,
+      result ? std::span<const hal::byte>(result.value().data)
+             : std::span<const hal::byte>{});
+    return result;
+  }
+
+  result<flush_t> driver_flush() override
+  {
+    return m_driver->flush();
+  }
+
+  hal::serial* m_driver;
+  trace_recorder* m_recorder;
+  std::uint16_t m_source;
+};
+
+/**
+ * @brief Driver that plays back responses from a replay trace
+ *
+ * Implements the same interface as the recorded driver, so code under test
+ * cannot tell the two apart, and runs as fast as the host allows. Entries
+ * recorded as failed are replayed as std::errc::io_error. Once the source's
+ * entries run out, calls fail with std::errc::no_message.
+ *
+ * The primary template handles sensors described by replay_traits, the
+ * specializations handle input_pin, i2c, spi and serial.
+ *
+ * @tparam Interface - libhal interface to replay
+ */
+template<class Interface>
+class replay : public Interface
+{
+public:
+  using traits = replay_traits<Interface>;
+  using read_t = typename Interface::read_t;
+
+  /**
+   * @brief Factory function to create a replay driver
+   *
+   * @param p_player - trace to replay. Must outlive the driver.
+   * @param p_source - ID the entries were recorded under
+   * @return result<replay> - the constructed driver
+   */
+  static result<replay> create(const trace_player& p_player,
+                               std::uint16_t p_source)
+  {
+    return replay(p_player, p_source);
+  }
+
+private:
+  replay(const trace_player& p_player, std::uint16_t p_source)
+    : m_player(&p_player)
+    , m_source(p_source)
+  {
+  }
+
+  result<read_t> driver_read() override
+  {
+    auto entry = HAL_CHECK(m_player->next(m_source, traits::call, m_cursor));
+    if (entry.failed) {
+      return hal::new_error(std::errc::io_error);
+    }
+    if (entry.payload.size() != traits::payload_size) {
+      return hal::new_error(std::errc::message_size);
+    }
+    return traits::from(
+      traits::decode(entry.payload.template first<traits::payload_size>()));
+  }
+
+  const trace_player* m_player;
+  std::size_t m_cursor = 0;
+  std::uint16_t m_source;
+};
+
+template<>
+class replay<hal::input_pin> : public hal::input_pin
+{
+public:
+  /**
+   * @brief Factory function to create a replay input_pin
+   *
+   * @param p_player - trace to replay. Must outlive the driver.
+   * @param p_source - ID the entries were recorded under
+   * @return result<replay> - the constructed driver
+   */
+  static result<replay> create(const trace_player& p_player,
+                               std::uint16_t p_source)
+  {
+    return replay(p_player, p_source);
+  }
+
+private:
+  replay(const trace_player& p_player, std::uint16_t p_source)
+    : m_player(&p_player)
+    , m_source(p_source)
+  {
+  }
+
+  status driver_configure([[maybe_unused]] const settings& p_settings) override
+  {
+    return hal::success();
+  }
+
+  result<level_t> driver_level() override
+  {
+    auto entry = HAL_CHECK(
+      m_player->next(m_source, trace_call::input_pin_level, m_cursor));
+    if (entry.failed) {
+      return hal::new_error(std::errc::io_error);
+    }
+    if (entry.payload.size() != 1) {
+      return hal::new_error(std::errc::message_size);
+    }
+    return level_t{ .state = entry.payload[0] != 0 };
+  }
+
+  const trace_player* m_player;
+  std::size_t m_cursor = 0;
+  std::uint16_t m_source;
+};
+
+template<>
+class replay<hal::i2c> : public hal::i2c
+{
+public:
+  /**
+   * @brief Factory function to create a replay i2c
+   *
+   * Transactions fill p_data_in with the recorded bytes. The address and the
+   * bytes written are not checked.
+   *
+   * @param p_player - trace to replay. Must outlive the driver.
+   * @param p_source - ID the entries were recorded under
+   * @return result<replay> - the constructed driver
+   */
+  static result<replay> create(const trace_player& p_player,
+                               std::uint16_t p_source)
+  {
+    return replay(p_player, p_source);
+  }
+
+private:
+  replay(const trace_player& p_player, std::uint16_t p_source)
+    : m_player(&p_player)
+    , m_source(p_source)
+  {
+  }
+
+  status driver_configure([[maybe_unused]] const settings& p_settings) override
+  {
+    return hal::success();
+  }
+
+  result<transaction_t> driver_transaction(
+    [[maybe_unused]] hal::byte p_address,
+    [[maybe_unused]] std::span<const hal::byte> p_data_out,
+    std::span<hal::byte> p_data_in,
+    [[maybe_unused]] hal::function_ref<hal::timeout_function> p_timeout)
+    override
+  {
+    auto entry = HAL_CHECK(
+      m_player->next(m_source, trace_call::i2c_transaction, m_cursor));
+    if (entry.failed) {
+      return hal::new_error(std::errc::io_error);
+    }
+    if (entry.payload.size() != p_data_in.size()) {
+      return hal::new_error(std::errc::message_size);
+    }
+    std::copy(entry.payload.begin(), entry.payload.end(), p_data_in.begin());
+    return transaction_t{};
+  }
+
+  const trace_player* m_player;
+  std::size_t m_cursor = 0;
+  std::uint16_t m_source;
+};
+
+template<>
+class replay<hal::spi> : public hal::spi
+{
+public:
+  /**
+   * @brief Factory function to create a replay spi
+   *
+   * Transfers fill p_data_in with the recorded bytes. The bytes written are
+   * not checked.
+   *
+   * @param p_player - trace to replay. Must outlive the driver.
+   * @param p_source - ID the entries were recorded under
+   * @return result<replay> - the constructed driver
+   */
+  static result<replay> create(const trace_player& p_player,
+                               std::uint16_t p_source)
+  {
+    return replay(p_player, p_source);
+  }
+
+private:
+  replay(const trace_player& p_player, std::uint16_t p_source)
+    : m_player(&p_player)
+    , m_source(p_source)
+  {
+  }
+
+  status driver_configure([[maybe_unused]] const settings& p_settings) override
+  {
+    return hal::success();
+  }
+
+  result<transfer_t> driver_transfer(
+    [[maybe_unused]] std::span<const hal::byte> p_data_out,
+    std::span<hal::byte> p_data_in,
+    [[maybe_unused]] hal::byte p_filler) override
+  {
+    auto entry =
+      HAL_CHECK(m_player->next(m_source, trace_call::spi_transfer, m_cursor));
+    if (entry.failed) {
+      return hal::new_error(std::errc::io_error);
+    }
+    if (entry.payload.size() != p_data_in.size()) {
+      return hal::new_error(std::errc::message_size);
+    }
+    std::copy(entry.payload.begin(), entry.payload.end(), p_data_in.begin());
+    return transfer_t{};
+  }
+
+  const trace_player* m_player;
+  std::size_t m_cursor = 0;
+  std::uint16_t m_source;
+};
+
+template<>
+class replay<hal::serial> : public hal::serial
+{
+public:
+  /**
+   * @brief Factory function to create a replay serial
+   *
+   * Each read returns the bytes of the next recorded read. Writes and flushes
+   * succeed without doing anything.
+   *
+   * @param p_player - trace to replay. Must outlive the driver.
+   * @param p_source - ID the entries were recorded under
+   * @return result<replay> - the constructed driver
+   */
+  static result<replay> create(const trace_player& p_player,
+                               std::uint16_t p_source)
+  {
+    return replay(p_player, p_source);
+  }
+
+private:
+  replay(const trace_player& p_player, std::uint16_t p_source)
+    : m_player(&p_player)
+    , m_source(p_source)
+  {
+  }
+
+  status driver_configure([[maybe_unused]] const settings& p_settings) override
+  {
+    return hal::success();
+  }
+
+  result<write_t> driver_write(std::span<const hal::byte> p_data) override
+  {
+    return write_t{ .data = p_data };
+  }
+
+  result<read_t> driver_read(std::span<hal::byte> p_data) override
+  {
+    auto entry =
+      HAL_CHECK(m_player->next(m_source, trace_call::serial_read, m_cursor));
+    if (entry.failed) {
+      return hal::new_error(std::errc::io_error);
+    }
+    if (entry.payload.size() > p_data.size()) {
+      return hal::new_error(std::errc::message_size);
+    }
+    std::copy(entry.payload.begin(), entry.payload.end(), p_data.begin());
+    return read_t{
+      .data = p_data.first(entry.payload.size()),
+      .available = 0,
+      .capacity = p_data.size(),
+    };
+  }
+
+  result<flush_t> driver_flush() override
+  {
+    return flush_t{};
+  }
+
+  const trace_player* m_player;
+  std::size_t m_cursor = 0;
+  std::uint16_t m_source;
+};
+}  // namespace hal::soft
@@ -0,0 +1,188 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <libhal-soft/framing.hpp>
+#include <libhal/serial.hpp>
+
+/**
+ * @defgroup SerialMux Serial Mux
+ *
+ */
+
+namespace hal::soft {
+class serial_mux_channel;
+
+/**
+ * @ingroup SerialMux
+ * @brief Multiplexes several logical serial channels over one serial port
+ *
+ * Each frame on the wire is COBS encoded and starts with a one byte channel
+ * number, followed by the channel's payload. Writes to a channel are staged in
+ * that channel's transmit buffer, so that many small writes go out as one
+ * frame. transmit() sends every channel's staged bytes, visiting the channels
+ * round robin with a rotating starting point, and batches the encoded frames
+ * into as few writes to the port as the transmit buffer allows. Received
+ * frames are routed into per-channel receive buffers, so a channel that is not
+ * being read does not block the others.
+ */
+class serial_mux
+{
+public:
+  /// Maximum number of logical channels per mux
+  static constexpr std::size_t max_channels = 8;
+
+  /**
+   * @brief Factory function to create a serial_mux object
+   *
+   * @param p_port - serial port carrying the multiplexed channels
+   * @param p_transmit_buffer - storage used to batch encoded frames before
+   * writing them to the port. Must outlive the mux.
+   * @param p_frame_buffer - storage used to decode received frames. Must be at
+   * least one byte larger than the largest payload the other side will send
+   * and must outlive the mux.
+   * @return result<serial_mux> - the constructed serial_mux object
+   */
+  static result<serial_mux> create(hal::serial& p_port,
+                                   std::span<hal::byte> p_transmit_buffer,
+                                   std::span<hal::byte> p_frame_buffer);
+
+  /**
+   * @brief Send the bytes staged by every channel
+   *
+   * @return status - success or an error from the serial port
+   */
+  status transmit();
+
+  /**
+   * @brief Read the serial port and route received frames to their channels
+   *
+   * Channels call this automatically when they are read.
+   *
+   * @return status - success or an error from the serial port
+   */
+  status receive();
+
+  /**
+   * @brief Get the number of received frames that were not delivered in full
+   *
+   * Frames are dropped if they are malformed, are too large for the frame
+   * buffer, name a channel that does not exist, or do not fit into the
+   * channel's receive buffer.
+   *
+   * @return std::size_t - number of dropped frames
+   */
+  [[nodiscard]] std::size_t dropped_frames() const;
+
+private:
+  friend class serial_mux_channel;
+
+  struct channel_state
+  {
+    std::span<hal::byte> receive_buffer{};
+    std::size_t receive_head = 0;
+    std::size_t receive_stored = 0;
+    /// The first byte holds the channel number so that the staged bytes are
+    /// already laid out as a frame payload.
+    std::span<hal::byte> transmit_buffer{};
+    std::size_t transmit_length = 0;
+    bool in_use = false;
+  };
+
+  serial_mux(hal::serial& p_port,
+             std::span<hal::byte> p_transmit_buffer,
+             cobs_decoder p_decoder);
+
+  status stage(std::uint8_t p_channel, std::span<const hal::byte> p_data);
+  std::span<hal::byte> unstage(std::uint8_t p_channel,
+                               std::span<hal::byte> p_data);
+  void deliver(std::span<const hal::byte> p_frame);
+  status write_batch();
+
+  hal::serial* m_port;
+  std::span<hal::byte> m_transmit_buffer;
+  std::size_t m_batch_length = 0;
+  cobs_decoder m_decoder;
+  std::array<channel_state, max_channels> m_channels{};
+  std::size_t m_next_channel = 0;
+  std::size_t m_dropped = 0;
+};
+
+/**
+ * @ingroup SerialMux
+ * @brief A logical serial channel of a serial_mux
+ *
+ * Writes are staged until serial_mux::transmit() is called, or until the
+ * channel's transmit buffer fills, at which point the mux transmits for all
+ * channels. Reads first let the mux receive from the port. Line settings
+ * belong to the underlying port, so configure() is accepted and ignored.
+ *
+ * Destroying a channel frees its channel number for reuse, and frames
+ * received for it are dropped from then on. Bytes it staged but did not
+ * transmit are discarded.
+ */
+class serial_mux_channel : public hal::serial
+{
+public:
+  /**
+   * @brief Factory function to create a logical serial channel on a
+   * serial_mux
+   *
+   * @param p_mux - the mux carrying the channel. Must outlive the channel.
+   * @param p_channel - channel number, less than serial_mux::max_channels.
+   * Both sides of the link must agree on channel numbers.
+   * @param p_receive_buffer - storage for received bytes that have not been
+   * read yet. Must outlive the channel.
+   * @param p_transmit_buffer - storage for staged bytes. One byte is reserved
+   * for the channel number. Must outlive the channel.
+   * @return result<serial_mux_channel> - the constructed channel
+   * @throws std::errc::result_out_of_range - if p_channel is not less than
+   * serial_mux::max_channels
+   * @throws std::errc::device_or_resource_busy - if p_channel is already in
+   * use
+   * @throws std::errc::invalid_argument - if p_transmit_buffer is too small
+   * to hold any data or too large for its frames to fit into the mux's
+   * transmit buffer
+   */
+  static result<serial_mux_channel> create(
+    serial_mux& p_mux,
+    std::uint8_t p_channel,
+    std::span<hal::byte> p_receive_buffer,
+    std::span<hal::byte> p_transmit_buffer);
+
+  serial_mux_channel(serial_mux_channel&& p_other) noexcept;
+  serial_mux_channel& operator=(serial_mux_channel&& p_other) = delete;
+  serial_mux_channel(const serial_mux_channel&) = delete;
+  serial_mux_channel& operator=(const serial_mux_channel&) = delete;
+  ~serial_mux_channel();
+
+private:
+  serial_mux_channel(serial_mux& p_mux, std::uint8_t p_channel);
+
+  status driver_configure(const settings& p_settings) override;
+  result<write_t> driver_write(std::span<const hal::byte> p_data) override;
+  result<read_t> driver_read(std::span<hal::byte> p_data) override;
+  result<flush_t> driver_flush() override;
+
+  /// Null once the channel has been moved from
+  serial_mux* m_mux;
+  std::uint8_t m_channel;
+};
+}  // namespace hal::soft
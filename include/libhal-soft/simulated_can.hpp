@@ -0,0 +1,171 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <libhal/can.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+class simulated_can_node;
+
+/**
+ * @brief In-process CAN bus shared by several simulated_can_node objects
+ *
+ * Nodes queue frames in their transmit mailboxes. Each call to step()
+ * arbitrates between every queued frame on the bus the way the bus does, bit
+ * by bit over the arbitration field, and delivers the winner to the receive
+ * handler of every other node. IDs above 0x7FF are extended. A standard frame
+ * beats every extended frame that shares its 11-bit base ID, and a data frame
+ * beats a remote frame with the same ID. Nothing is transmitted until the bus
+ * is stepped, so tests decide exactly when frames move and handlers can
+ * safely send replies.
+ *
+ * If the bus is created with a bitrate it also keeps a virtual clock, which
+ * advances by the length of every transmitted frame. That makes it possible
+ * to measure how many frames a CAN stack moves in a span of bus time, as fast
+ * as the host can run it. Frame lengths do not include stuff bits.
+ *
+ * Nodes join the bus when they are configured or turned on, and must not be
+ * moved or destroyed while the bus is in use.
+ */
+class simulated_can_bus
+{
+public:
+  /// Maximum number of nodes on one bus
+  static constexpr std::size_t max_nodes = 16;
+
+  /**
+   * @brief Factory function to create a simulated_can_bus object
+   *
+   * @param p_bitrate - bitrate used to time frames. Zero disables timing.
+   * @return result<simulated_can_bus> - the constructed simulated_can_bus
+   * @throws std::errc::invalid_argument - if p_bitrate is negative
+   */
+  static result<simulated_can_bus> create(hal::hertz p_bitrate = 0.0f);
+
+  /**
+   * @brief Arbitrate and transmit one frame
+   *
+   * @return true - if a frame was transmitted
+   * @return false - if no node has a frame queued
+   */
+  bool step();
+
+  /**
+   * @brief Transmit frames until no node has a frame queued
+   *
+   * Frames queued by receive handlers are transmitted too.
+   *
+   * @return std::size_t - number of frames transmitted
+   */
+  std::size_t run();
+
+  /**
+   * @brief Transmit every frame that finishes within a span of bus time
+   *
+   * The bus clock then advances to the end of the span, even if the bus went
+   * idle. Without a bitrate, this is the same as run().
+   *
+   * @param p_duration - span of bus time to run for
+   * @return std::size_t - number of frames transmitted
+   */
+  std::size_t run_for(hal::time_duration p_duration);
+
+  /**
+   * @brief Get the virtual bus time
+   *
+   * @return hal::time_duration - bus time since creation. Always zero without a
+   * bitrate.
+   */
+  [[nodiscard]] hal::time_duration now() const;
+
+  /**
+   * @brief Get the number of frames transmitted on the bus
+   *
+   * @return std::size_t - number of frames transmitted since creation
+   */
+  [[nodiscard]] std::size_t frames_transmitted() const;
+
+private:
+  friend class simulated_can_node;
+
+  explicit simulated_can_bus(hal::hertz p_bitrate);
+
+  status join(simulated_can_node& p_node);
+  simulated_can_node* arbitrate();
+  [[nodiscard]] std::uint64_t to_bits(hal::time_duration p_duration) const;
+
+  std::array<simulated_can_node*, max_nodes> m_nodes{};
+  std::size_t m_node_count = 0;
+  std::size_t m_frames = 0;
+  /// Bus time in bit periods
+  std::uint64_t m_bit_time = 0;
+  std::uint32_t m_bitrate;
+};
+
+/**
+ * @brief A CAN controller attached to a simulated_can_bus
+ *
+ * send() places the message in one of the node's transmit mailboxes and fails
+ * when every mailbox is full, like most CAN controllers. Messages leave the
+ * mailboxes when the bus transmits them.
+ */
+class simulated_can_node : public hal::can
+{
+public:
+  /// Number of transmit mailboxes per node
+  static constexpr std::size_t mailbox_count = 3;
+
+  /**
+   * @brief Factory function to create a simulated_can_node object
+   *
+   * @param p_bus - bus the node joins once configured or turned on
+   * @return result<simulated_can_node> - the constructed simulated_can_node
+   */
+  static result<simulated_can_node> create(simulated_can_bus& p_bus);
+
+  /**
+   * @brief Get the number of frames waiting in the transmit mailboxes
+   *
+   * @return std::size_t - number of queued frames
+   */
+  [[nodiscard]] std::size_t pending() const;
+
+private:
+  friend class simulated_can_bus;
+
+  explicit simulated_can_node(simulated_can_bus& p_bus);
+
+  status driver_configure(const settings& p_settings) override;
+  status driver_bus_on() override;
+  result<send_t> driver_send(const message_t& p_message) override;
+  void driver_on_receive(hal::callback<handler> p_handler) override;
+
+  /// Index of the queued frame that wins arbitration, only valid if pending
+  [[nodiscard]] std::size_t next_mailbox() const;
+  message_t pop(std::size_t p_mailbox);
+
+  simulated_can_bus* m_bus;
+  hal::callback<handler> m_handler =
+    []([[maybe_unused]] const message_t& p_message) {};
+  std::array<message_t, mailbox_count> m_mailboxes{};
+  std::size_t m_pending = 0;
+  bool m_joined = false;
+};
+}  // namespace hal::soft
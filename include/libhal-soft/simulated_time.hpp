@@ -0,0 +1,178 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <libhal/steady_clock.hpp>
+#include <libhal/timer.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+class simulated_timer;
+
+/**
+ * @brief Deterministic virtual time shared by simulated clocks and timers
+ *
+ * Time only moves when asked to. advance() and run_next() move it straight
+ * to each scheduled timer's deadline in turn and run its callback, so a test
+ * covering seconds of virtual time takes microseconds of wall time. Timers
+ * with equal deadlines fire in the order they were scheduled.
+ *
+ * Every read of a simulated_steady_clock also advances time by a poll step,
+ * firing any timer that falls within it, so code that busy waits on the clock
+ * with hal::delay() finishes after a handful of reads. A coarse poll step
+ * makes those waits cheaper but overshoot by up to one step.
+ *
+ * Clocks and timers keep a pointer to their simulated_time, which must not be
+ * moved once they have been created.
+ */
+class simulated_time
+{
+public:
+  /// Maximum number of simulated timers scheduled at the same time
+  static constexpr std::size_t max_timers = 16;
+
+  /**
+   * @brief Factory function to create a simulated_time object
+   *
+   * @param p_frequency - tick frequency of the simulated clocks
+   * @param p_poll_step - time that passes with each read of a clock. Rounded
+   * up to at least one tick.
+   * @return result<simulated_time> - the constructed simulated_time object
+   * @throws std::errc::invalid_argument - if p_frequency is not positive
+   */
+  static result<simulated_time> create(
+    hal::hertz p_frequency = 1'000'000.0f,
+    hal::time_duration p_poll_step = std::chrono::microseconds(1));
+
+  /**
+   * @brief Let time pass, firing every timer due along the way
+   *
+   * @param p_duration - amount of virtual time to pass
+   */
+  void advance(hal::time_duration p_duration);
+
+  /**
+   * @brief Jump to the earliest timer deadline and fire that timer
+   *
+   * @return true - if a timer fired
+   * @return false - if no timer is scheduled
+   */
+  bool run_next();
+
+  /**
+   * @brief Get the virtual time
+   *
+   * @return hal::time_duration - time since creation
+   */
+  [[nodiscard]] hal::time_duration now() const;
+
+  /**
+   * @brief Get the number of scheduled timers
+   *
+   * @return std::size_t - number of timers waiting to fire
+   */
+  [[nodiscard]] std::size_t pending() const;
+
+private:
+  friend class simulated_steady_clock;
+  friend class simulated_timer;
+
+  simulated_time(hal::hertz p_frequency, hal::time_duration p_poll_step);
+
+  [[nodiscard]] std::uint64_t to_ticks(hal::time_duration p_duration) const;
+  void advance_to(std::uint64_t p_ticks);
+  simulated_timer* earliest() const;
+  status attach(simulated_timer& p_timer);
+  void detach(simulated_timer& p_timer);
+  void replace(simulated_timer& p_old, simulated_timer& p_new);
+
+  std::array<simulated_timer*, max_timers> m_timers{};
+  std::size_t m_timer_count = 0;
+  hal::hertz m_frequency;
+  double m_ticks_per_ns;
+  double m_ns_per_tick;
+  std::uint64_t m_ticks = 0;
+  std::uint64_t m_poll_ticks;
+  std::uint64_t m_sequence = 0;
+};
+
+/**
+ * @brief Steady clock reading a simulated_time
+ */
+class simulated_steady_clock : public hal::steady_clock
+{
+public:
+  /**
+   * @brief Factory function to create a simulated_steady_clock object
+   *
+   * @param p_time - virtual time the clock reads
+   * @return result<simulated_steady_clock> - the constructed clock
+   */
+  static result<simulated_steady_clock> create(simulated_time& p_time);
+
+private:
+  explicit simulated_steady_clock(simulated_time& p_time);
+
+  frequency_t driver_frequency() override;
+  uptime_t driver_uptime() override;
+
+  simulated_time* m_time;
+};
+
+/**
+ * @brief Timer firing at deadlines in a simulated_time
+ *
+ * Moving a scheduled timer keeps it scheduled, and destroying a scheduled
+ * timer cancels it.
+ */
+class simulated_timer : public hal::timer
+{
+public:
+  /**
+   * @brief Factory function to create a simulated_timer object
+   *
+   * @param p_time - virtual time the timer runs in
+   * @return result<simulated_timer> - the constructed timer
+   */
+  static result<simulated_timer> create(simulated_time& p_time);
+
+  simulated_timer(simulated_timer&& p_other) noexcept;
+  simulated_timer& operator=(simulated_timer&& p_other) = delete;
+  simulated_timer(const simulated_timer&) = delete;
+  simulated_timer& operator=(const simulated_timer&) = delete;
+  ~simulated_timer() override;
+
+private:
+  friend class simulated_time;
+
+  explicit simulated_timer(simulated_time& p_time);
+
+  result<is_running_t> driver_is_running() override;
+  result<cancel_t> driver_cancel() override;
+  result<schedule_t> driver_schedule(hal::callback<void(void)> p_callback,
+                                     hal::time_duration p_delay) override;
+
+  simulated_time* m_time;
+  hal::callback<void(void)> m_callback{};
+  std::uint64_t m_deadline = 0;
+  std::uint64_t m_sequence = 0;
+  bool m_scheduled = false;
+};
+}  // namespace hal::soft
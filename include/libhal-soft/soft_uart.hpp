@@ -0,0 +1,139 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <libhal/input_pin.hpp>
+#include <libhal/interrupt_pin.hpp>
+#include <libhal/output_pin.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/timer.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Bit-banged UART built from pins and timers
+ *
+ * Transmission shifts bits out of a pre-built frame word, one per timer
+ * callback. Reception starts on the falling edge of the start bit and samples
+ * each bit in its middle. All bit timings are computed once in configure(), so
+ * each bit only costs a pin access, a shift and a timer reschedule.
+ *
+ * Separate timers are used for transmit and receive so both directions can
+ * run at the same time. Writes are queued in a transmit buffer and sent in the
+ * background. Received bytes are queued in a receive buffer until read. The
+ * soft_uart is idle until configure() is called, which sets up the pins and
+ * arms the receiver. The object must not be moved after configure().
+ * Destroying it cancels both timers and stops listening for start bits.
+ */
+class soft_uart : public hal::serial
+{
+public:
+  /**
+   * @brief Factory function to create a soft_uart object
+   *
+   * @param p_transmit_pin - pin driving the TX line
+   * @param p_receive_edge - interrupt pin on the RX line, used to detect start
+   * bits
+   * @param p_receive_pin - input pin on the RX line, used to sample bits
+   * @param p_transmit_timer - timer that paces transmitted bits
+   * @param p_receive_timer - timer that paces received bit samples
+   * @param p_transmit_buffer - storage for bytes waiting to be sent. Must
+   * outlive the soft_uart object.
+   * @param p_receive_buffer - storage for received bytes waiting to be read.
+   * Must outlive the soft_uart object.
+   * @return result<soft_uart> - the constructed soft_uart object
+   */
+  static result<soft_uart> create(hal::output_pin& p_transmit_pin,
+                                  hal::interrupt_pin& p_receive_edge,
+                                  hal::input_pin& p_receive_pin,
+                                  hal::timer& p_transmit_timer,
+                                  hal::timer& p_receive_timer,
+                                  std::span<hal::byte> p_transmit_buffer,
+                                  std::span<hal::byte> p_receive_buffer);
+
+  soft_uart(soft_uart&& p_other) noexcept;
+  soft_uart& operator=(soft_uart&& p_other) = delete;
+  soft_uart(const soft_uart&) = delete;
+  soft_uart& operator=(const soft_uart&) = delete;
+  ~soft_uart() override;
+
+  /**
+   * @brief Get the number of received bytes dropped due to framing or parity
+   * errors or due to a full receive buffer.
+   *
+   * @return std::size_t - number of dropped bytes
+   */
+  [[nodiscard]] std::size_t receive_errors() const;
+
+private:
+  soft_uart(hal::output_pin& p_transmit_pin,
+            hal::interrupt_pin& p_receive_edge,
+            hal::input_pin& p_receive_pin,
+            hal::timer& p_transmit_timer,
+            hal::timer& p_receive_timer,
+            std::span<hal::byte> p_transmit_buffer,
+            std::span<hal::byte> p_receive_buffer);
+
+  status driver_configure(const settings& p_settings) override;
+  result<write_t> driver_write(std::span<const hal::byte> p_data) override;
+  result<read_t> driver_read(std::span<hal::byte> p_data) override;
+  result<flush_t> driver_flush() override;
+
+  std::uint16_t make_frame(hal::byte p_byte) const;
+  /// Take ownership of the idle transmitter, false if it is already running
+  bool claim_transmitter();
+  void transmit_bit();
+  void start_receive();
+  void receive_bit();
+
+  hal::output_pin* m_transmit_pin;
+  hal::interrupt_pin* m_receive_edge;
+  hal::input_pin* m_receive_pin;
+  hal::timer* m_transmit_timer;
+  hal::timer* m_receive_timer;
+  std::span<hal::byte> m_transmit_buffer;
+  std::span<hal::byte> m_receive_buffer;
+
+  // Computed by configure()
+  hal::time_duration m_bit_period{};
+  hal::time_duration m_half_bit_period{};
+  std::uint16_t m_stop_pattern = 0;
+  std::uint8_t m_frame_bits = 0;
+  /// Parity bit is (data parity & m_parity_data_mask) ^ m_parity_invert
+  std::uint8_t m_parity_data_mask = 0;
+  std::uint8_t m_parity_invert = 0;
+  bool m_has_parity = false;
+
+  // Shared with timer and interrupt callbacks. Indices are free running and
+  // each has a single writer.
+  volatile std::size_t m_transmit_head = 0;
+  volatile std::size_t m_transmit_tail = 0;
+  volatile std::size_t m_receive_head = 0;
+  volatile std::size_t m_receive_tail = 0;
+  volatile std::size_t m_receive_errors = 0;
+  /// Claimed by whichever context starts the transmitter, so a write racing
+  /// with the last timer callback cannot leave queued bytes unsent
+  std::atomic<bool> m_transmitting = false;
+  volatile bool m_receiving = false;
+  std::uint16_t m_transmit_frame = 0;
+  std::uint16_t m_receive_frame = 0;
+  std::uint8_t m_transmit_bits_left = 0;
+  std::uint8_t m_receive_bit = 0;
+};
+}  // namespace hal::soft
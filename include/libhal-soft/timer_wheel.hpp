@@ -0,0 +1,155 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include <libhal/steady_clock.hpp>
+#include <libhal/timer.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+class wheel_timer;
+
+/**
+ * @brief Hierarchical timer wheel serving many wheel_timer objects from one
+ * hardware timer
+ *
+ * Deadlines are counted in steps of a fixed resolution, measured by a steady
+ * clock. Each timer sits in a doubly linked list in one slot of a four level
+ * wheel with 64 slots per level, chosen by how far away its deadline is.
+ * Scheduling and cancelling a timer are constant time list operations. A
+ * bitmap of occupied slots per level finds the nearest event with one bit
+ * scan per level, and the hardware timer is only ever armed for that event.
+ * As time passes, timers cascade from the coarse levels down to the finest
+ * one, where they expire.
+ *
+ * Timers fire at or up to one resolution step after their deadline. The
+ * longest delay is 2^24 steps.
+ *
+ * Timer callbacks run from the hardware timer's callback. wheel_timer
+ * objects may be scheduled and cancelled from those callbacks, or from
+ * elsewhere while the hardware timer's interrupt is masked. The wheel must
+ * not be moved once a timer has been scheduled.
+ */
+class timer_wheel
+{
+public:
+  /// Number of levels in the wheel
+  static constexpr std::size_t levels = 4;
+  /// Number of slots in each level
+  static constexpr std::size_t slots_per_level = 64;
+
+  /**
+   * @brief Factory function to create a timer_wheel object
+   *
+   * @param p_timer - hardware timer, used exclusively by the wheel
+   * @param p_clock - steady clock used to measure time
+   * @param p_resolution - length of one wheel step
+   * @return result<timer_wheel> - the constructed timer_wheel object
+   * @throws std::errc::invalid_argument - if p_resolution is shorter than one
+   * tick of p_clock
+   */
+  static result<timer_wheel> create(hal::timer& p_timer,
+                                    hal::steady_clock& p_clock,
+                                    hal::time_duration p_resolution);
+
+  /**
+   * @brief Get the longest delay a wheel_timer can be scheduled with
+   *
+   * @return hal::time_duration - the maximum delay
+   */
+  [[nodiscard]] hal::time_duration max_delay() const;
+
+private:
+  friend class wheel_timer;
+
+  static constexpr auto never = std::numeric_limits<std::uint64_t>::max();
+
+  timer_wheel(hal::timer& p_timer,
+              hal::steady_clock& p_clock,
+              std::uint64_t p_clock_ticks_per_step,
+              float p_clock_frequency);
+
+  [[nodiscard]] std::uint64_t elapsed_clock_ticks();
+  [[nodiscard]] std::uint64_t next_event() const;
+  void link(wheel_timer& p_timer);
+  void unlink(wheel_timer& p_timer);
+  void replace(wheel_timer& p_old, wheel_timer& p_new);
+  wheel_timer* detach(std::size_t p_level, std::size_t p_slot);
+  void advance(std::uint64_t p_target);
+  void arm();
+  void service();
+
+  hal::timer* m_timer;
+  hal::steady_clock* m_clock;
+  std::array<std::array<wheel_timer*, slots_per_level>, levels> m_slots{};
+  std::array<std::uint64_t, levels> m_occupied{};
+  std::uint64_t m_origin;
+  std::uint64_t m_clock_ticks_per_step;
+  double m_clock_ticks_per_ns;
+  double m_ns_per_clock_tick;
+  /// Step up to which every event has been processed
+  std::uint64_t m_now = 0;
+  /// Step the hardware timer is armed for
+  std::uint64_t m_armed = never;
+};
+
+/**
+ * @brief Virtual timer driven by a timer_wheel
+ *
+ * Moving a scheduled timer moves its place in the wheel along with it, and
+ * destroying a scheduled timer cancels it.
+ */
+class wheel_timer : public hal::timer
+{
+public:
+  /**
+   * @brief Factory function to create a wheel_timer object
+   *
+   * @param p_wheel - wheel that drives the timer
+   * @return result<wheel_timer> - the constructed wheel_timer object
+   */
+  static result<wheel_timer> create(timer_wheel& p_wheel);
+
+  wheel_timer(wheel_timer&& p_other) noexcept;
+  wheel_timer& operator=(wheel_timer&& p_other) = delete;
+  wheel_timer(const wheel_timer&) = delete;
+  wheel_timer& operator=(const wheel_timer&) = delete;
+  ~wheel_timer() override;
+
+private:
+  friend class timer_wheel;
+
+  explicit wheel_timer(timer_wheel& p_wheel);
+
+  result<is_running_t> driver_is_running() override;
+  result<cancel_t> driver_cancel() override;
+  result<schedule_t> driver_schedule(hal::callback<void(void)> p_callback,
+                                     hal::time_duration p_delay) override;
+
+  timer_wheel* m_wheel;
+  hal::callback<void(void)> m_callback{};
+  std::uint64_t m_deadline = 0;
+  wheel_timer* m_previous = nullptr;
+  wheel_timer* m_next = nullptr;
+  std::uint8_t m_level = 0;
+  std::uint8_t m_slot = 0;
+  bool m_scheduled = false;
+};
+}  // namespace hal::soft
@@ -0,0 +1,220 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <libhal/serial.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Driver call recorded in a trace_record
+ *
+ * Values are part of the dump format and never change. The comment on each
+ * value describes what the record's argument holds. "float" means the IEEE
+ * 754 bits of a float value.
+ */
+enum class trace_call : std::uint8_t
+{
+  adc_read = 0x01,                 ///< float sample read
+  dac_write = 0x02,                ///< float value written
+  pwm_frequency = 0x03,            ///< float frequency in hertz
+  pwm_duty_cycle = 0x04,           ///< float duty cycle
+  i2c_configure = 0x05,            ///< float clock rate in hertz
+  i2c_transaction = 0x06,          ///< address << 16 | out << 8 | in lengths
+  spi_configure = 0x07,            ///< float clock rate in hertz
+  spi_transfer = 0x08,             ///< out << 16 | in lengths
+  serial_configure = 0x09,         ///< float baud rate
+  serial_write = 0x0A,             ///< bytes written
+  serial_read = 0x0B,              ///< bytes read
+  serial_flush = 0x0C,             ///< zero
+  socket_write = 0x0D,             ///< bytes written
+  socket_read = 0x0E,              ///< bytes read
+  can_configure = 0x0F,            ///< float baud rate
+  can_bus_on = 0x10,               ///< zero
+  can_send = 0x11,                 ///< message ID
+  can_receive = 0x12,              ///< message ID, spans the receive handler
+  input_pin_configure = 0x13,      ///< resistor setting
+  input_pin_level = 0x14,          ///< level read
+  output_pin_configure = 0x15,     ///< open drain << 8 | resistor setting
+  output_pin_set_level = 0x16,     ///< level written
+  output_pin_level = 0x17,         ///< level read
+  interrupt_pin_configure = 0x18,  ///< trigger << 8 | resistor setting
+  interrupt_pin_trigger = 0x19,    ///< pin level, spans the trigger handler
+  timer_is_running = 0x1A,         ///< running state read
+  timer_cancel = 0x1B,             ///< zero
+  timer_schedule = 0x1C,           ///< delay in microseconds
+  timer_callback = 0x1D,           ///< zero, spans the timer callback
+  motor_power = 0x1E,              ///< float power
+  servo_position = 0x1F,           ///< float position in degrees
+  rotation_sensor_read = 0x20,     ///< float angle in degrees
+  temperature_sensor_read = 0x21,  ///< float temperature in celsius
+  distance_sensor_read = 0x22,     ///< float distance in meters
+  accelerometer_read = 0x23,       ///< float x axis
+  gyroscope_read = 0x24,           ///< float x axis
+  magnetometer_read = 0x25,        ///< float x axis
+};
+
+/// One traced driver call
+struct trace_record
+{
+  /// Clock ticks when the call started
+  std::uint64_t start = 0;
+  /// Length of the call in clock ticks, saturated at 2^32 - 1
+  std::uint32_t duration = 0;
+  /// Position of the record in the trace, starting from 1. Zero while the
+  /// record is being written.
+  std::uint32_t sequence = 0;
+  /// Summary of the call's arguments or result, see trace_call
+  std::uint32_t argument = 0;
+  /// Caller chosen ID of the traced driver
+  std::uint16_t source = 0;
+  trace_call call{};
+  /// Zero if the call succeeded, one if it returned an error
+  std::uint8_t status = 0;
+};
+
+/// Header at the start of a trace dump, decoded
+struct trace_dump_header
+{
+  std::uint16_t version = 0;
+  std::uint16_t record_size = 0;
+  /// Frequency of the clock that timed the records
+  hal::hertz frequency = 0.0f;
+  /// Number of records following the header
+  std::uint32_t record_count = 0;
+};
+
+/**
+ * @brief Fixed size, lock-free ring of trace records
+ *
+ * Any number of writers, including interrupts, can push records at the same
+ * time: each claims a slot with a single atomic increment, and the newest
+ * records overwrite the oldest. A record's sequence number is written last,
+ * so readers can tell complete records from ones still being written.
+ *
+ * dump() writes the trace in a compact binary format, all integers little
+ * endian:
+ *
+ *     header, 16 bytes:
+ *       "HTRC", version (u16), record size (u16),
+ *       clock frequency (float bits, u32), record count (u32)
+ *     record, 24 bytes each, oldest first:
+ *       start (u64), duration (u32), sequence (u32), argument (u32),
+ *       source (u16), call (u8), status (u8)
+ *
+ * A record overwritten while the dump was being written is dumped with a
+ * sequence number of zero and should be skipped. decode_header() and
+ * decode() read the format back.
+ */
+class trace_ring
+{
+public:
+  /// Size of an encoded dump header in bytes
+  static constexpr std::size_t header_size = 16;
+  /// Size of an encoded record in bytes
+  static constexpr std::size_t record_size = 24;
+  /// Version of the dump format
+  static constexpr std::uint16_t format_version = 1;
+
+  /**
+   * @brief Factory function to create a trace_ring object
+   *
+   * @param p_storage - storage for records. Its size must be a power of two.
+   * Must outlive the trace_ring object.
+   * @return result<trace_ring> - the constructed trace_ring object
+   * @throws std::errc::invalid_argument - if the size of p_storage is not a
+   * power of two
+   */
+  static result<trace_ring> create(std::span<trace_record> p_storage);
+
+  trace_ring(trace_ring&& p_other) noexcept;
+  trace_ring& operator=(trace_ring&& p_other) = delete;
+  trace_ring(const trace_ring&) = delete;
+  trace_ring& operator=(const trace_ring&) = delete;
+
+  /**
+   * @brief Add a record, overwriting the oldest if the ring is full
+   *
+   * @param p_record - record to add. Its sequence number is assigned.
+   */
+  void push(const trace_record& p_record);
+
+  /**
+   * @brief Get the number of records pushed since creation or clear()
+   *
+   * @return std::uint32_t - number of records pushed, including overwritten
+   * ones
+   */
+  [[nodiscard]] std::uint32_t pushed() const;
+
+  /**
+   * @brief Copy out the complete records, oldest first
+   *
+   * @param p_output - destination for records
+   * @return std::span<trace_record> - the part of p_output that was filled
+   */
+  std::span<trace_record> snapshot(std::span<trace_record> p_output) const;
+
+  /**
+   * @brief Forget every record
+   *
+   * Must not be called while records are being pushed.
+   */
+  void clear();
+
+  /**
+   * @brief Write the complete records to a serial port in the dump format
+   *
+   * @param p_port - port to write the dump to
+   * @param p_frequency - frequency of the clock that timed the records
+   * @return status - success or an error from the port
+   */
+  status dump(hal::serial& p_port, hal::hertz p_frequency) const;
+
+  /**
+   * @brief Decode the header of a dump
+   *
+   * @param p_bytes - first header_size bytes of the dump
+   * @return result<trace_dump_header> - the decoded header
+   * @throws std::errc::illegal_byte_sequence - if p_bytes is not a trace dump
+   * header
+   */
+  static result<trace_dump_header> decode_header(
+    std::span<const hal::byte, header_size> p_bytes);
+
+  /**
+   * @brief Decode one record of a dump
+   *
+   * @param p_bytes - record_size bytes of an encoded record
+   * @return trace_record - the decoded record
+   */
+  static trace_record decode(std::span<const hal::byte, record_size> p_bytes);
+
+private:
+  explicit trace_ring(std::span<trace_record> p_storage);
+
+  /// Copy a complete record out of its slot, if it is still there
+  bool read(std::uint32_t p_sequence, trace_record& p_record) const;
+
+  std::span<trace_record> m_storage;
+  std::atomic<std::uint32_t> m_head{ 0 };
+};
+}  // namespace hal::soft
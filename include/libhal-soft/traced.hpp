@@ -0,0 +1,1035 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#include <libhal-soft/trace_ring.hpp>
+#include <libhal/accelerometer.hpp>
+#include <libhal/adc.hpp>
+#include <libhal/can.hpp>
+#include <libhal/dac.hpp>
+#include <libhal/distance_sensor.hpp>
+#include <libhal/gyroscope.hpp>
+#include <libhal/i2c.hpp>
+#include <libhal/input_pin.hpp>
+#include <libhal/interrupt_pin.hpp>
+#include <libhal/magnetometer.hpp>
+#include <libhal/motor.hpp>
+#include <libhal/output_pin.hpp>
+#include <libhal/pwm.hpp>
+#include <libhal/rotation_sensor.hpp>
+#include <libhal/serial.hpp>
+#include <libhal/servo.hpp>
+#include <libhal/socket.hpp>
+#include <libhal/spi.hpp>
+#include <libhal/steady_clock.hpp>
+#include <libhal/temperature_sensor.hpp>
+#include <libhal/timer.hpp>
+
+namespace hal::soft {
+/**
+ * @brief Times calls and pushes a trace_record for each into a trace_ring
+ *
+ * Shared by every traced decorator. A tracer is a small value, so each
+ * decorator holds its own copy.
+ */
+class tracer
+{
+public:
+  /**
+   * @brief Construct a tracer
+   *
+   * @param p_ring - ring receiving the records. Must outlive the tracer.
+   * @param p_clock - clock used to time calls. Must outlive the tracer.
+   * @param p_source - ID stored in every record, to tell drivers apart
+   */
+  tracer(trace_ring& p_ring, hal::steady_clock& p_clock, std::uint16_t p_source)
+    : m_ring(&p_ring)
+    , m_clock(&p_clock)
+    , m_source(p_source)
+  {
+  }
+
+  /**
+   * @brief Trace a call whose argument summary is known up front
+   *
+   * @param p_call - call being traced
+   * @param p_argument - summary of the call's arguments
+   * @param p_callable - performs the call and returns its result
+   * @return the result of p_callable
+   */
+  template<class Callable>
+  auto operator()(trace_call p_call,
+                  std::uint32_t p_argument,
+                  Callable&& p_callable) const
+  {
+    const auto start = m_clock->uptime().ticks;
+    auto result = p_callable();
+    record(p_call, p_argument, start, static_cast<bool>(result));
+    return result;
+  }
+
+  /**
+   * @brief Trace a call whose summary is taken from its result
+   *
+   * @param p_call - call being traced
+   * @param p_callable - performs the call and returns its result
+   * @param p_summarize - turns a successful result's value into the record's
+   * argument
+   * @return the result of p_callable
+   */
+  template<class Callable, class Summarize>
+  auto read(trace_call p_call,
+            Callable&& p_callable,
+            Summarize&& p_summarize) const
+  {
+    const auto start = m_clock->uptime().ticks;
+    auto result = p_callable();
+    const std::uint32_t argument = result ? p_summarize(result.value()) : 0;
+    record(p_call, argument, start, static_cast<bool>(result));
+    return result;
+  }
+
+  /**
+   * @brief Trace a callback, such as a receive handler, that cannot fail
+   *
+   * @param p_call - event being traced
+   * @param p_argument - summary of the event
+   * @param p_callable - runs the callback
+   */
+  template<class Callable>
+  void event(trace_call p_call,
+             std::uint32_t p_argument,
+             Callable&& p_callable) const
+  {
+    const auto start = m_clock->uptime().ticks;
+    p_callable();
+    record(p_call, p_argument, start, true);
+  }
+
+  /// Summarize a float value as its IEEE 754 bits
+  static std::uint32_t bits(float p_value)
+  {
+    return std::bit_cast<std::uint32_t>(p_value);
+  }
+
+  /// Summarize a length, saturated to fit in p_bits bits
+  static std::uint32_t length(std::size_t p_length, unsigned p_bits = 32)
+  {
+    const std::uint64_t max = (std::uint64_t{ 1 } << p_bits) - 1;
+    return static_cast<std::uint32_t>(
+      std::min<std::uint64_t>(p_length, max));
+  }
+
+private:
+  void record(trace_call p_call,
+              std::uint32_t p_argument,
+              std::uint64_t p_start,
+              bool p_success) const
+  {
+    const auto elapsed = m_clock->uptime().ticks - p_start;
+    m_ring->push(trace_record{
+      .start = p_start,
+      .duration = length(elapsed),
+      .argument = p_argument,
+      .source = m_source,
+      .call = p_call,
+      .status = static_cast<std::uint8_t>(p_success ? 0 : 1),
+    });
+  }
+
+  trace_ring* m_ring;
+  hal::steady_clock* m_clock;
+  std::uint16_t m_source;
+};
+
+/**
+ * @brief Decorator that traces every call made to a driver
+ *
+ * Specialized for each libhal interface. Every call is forwarded to the
+ * wrapped driver, timed, and recorded into a trace_ring along with a summary
+ * of its arguments or result and whether it failed. Receive handlers,
+ * interrupt handlers and timer callbacks passed through the decorator are
+ * traced too, so their latency shows up in the same trace. Those are stored
+ * in the decorator, so a traced can, interrupt_pin or timer must not be moved
+ * once a handler or callback has been passed through it.
+ *
+ * @tparam Interface - libhal interface to trace
+ */
+template<class Interface>
+class traced;
+
+template<>
+class traced<hal::adc> : public hal::adc
+{
+public:
+  /**
+   * @brief Factory function to create a traced adc
+   *
+   * @param p_driver - adc to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::adc& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::adc& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<read_t> driver_read() override
+  {
+    return m_tracer.read(
+      trace_call::adc_read,
+      [this]() { return m_driver->read(); },
+      [](const read_t& p_read) { return tracer::bits(p_read.sample); });
+  }
+
+  hal::adc* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::dac> : public hal::dac
+{
+public:
+  /**
+   * @brief Factory function to create a traced dac
+   *
+   * @param p_driver - dac to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::dac& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::dac& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<write_t> driver_write(float p_percentage) override
+  {
+    return m_tracer(trace_call::dac_write,
+                    tracer::bits(p_percentage),
+                    [&]() { return m_driver->write(p_percentage); });
+  }
+
+  hal::dac* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::pwm> : public hal::pwm
+{
+public:
+  /**
+   * @brief Factory function to create a traced pwm
+   *
+   * @param p_driver - pwm to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::pwm& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::pwm& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<frequency_t> driver_frequency(hal::hertz p_frequency) override
+  {
+    return m_tracer(trace_call::pwm_frequency,
+                    tracer::bits(p_frequency),
+                    [&]() { return m_driver->frequency(p_frequency); });
+  }
+
+  result<duty_cycle_t> driver_duty_cycle(float p_duty_cycle) override
+  {
+    return m_tracer(trace_call::pwm_duty_cycle,
+                    tracer::bits(p_duty_cycle),
+                    [&]() { return m_driver->duty_cycle(p_duty_cycle); });
+  }
+
+  hal::pwm* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::i2c> : public hal::i2c
+{
+public:
+  /**
+   * @brief Factory function to create a traced i2c
+   *
+   * @param p_driver - i2c to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::i2c& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::i2c& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    return m_tracer(trace_call::i2c_configure,
+                    tracer::bits(p_settings.clock_rate),
+                    [&]() { return m_driver->configure(p_settings); });
+  }
+
+  result<transaction_t> driver_transaction(
+    hal::byte p_address,
+    std::span<const hal::byte> p_data_out,
+    std::span<hal::byte> p_data_in,
+    hal::function_ref<hal::timeout_function> p_timeout) override
+  {
+    const auto argument = (std::uint32_t{ p_address } << 16) |
+                          (tracer::length(p_data_out.size(), 8) << 8) |
+                          tracer::length(p_data_in.size(), 8);
+    return m_tracer(trace_call::i2c_transaction, argument, [&]() {
+      return m_driver->transaction(p_address, p_data_out, p_data_in, p_timeout);
+    });
+  }
+
+  hal::i2c* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::spi> : public hal::spi
+{
+public:
+  /**
+   * @brief Factory function to create a traced spi
+   *
+   * @param p_driver - spi to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::spi& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::spi& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    return m_tracer(trace_call::spi_configure,
+                    tracer::bits(p_settings.clock_rate),
+                    [&]() { return m_driver->configure(p_settings); });
+  }
+
+  result<transfer_t> driver_transfer(std::span<const hal::byte> p_data_out,
+                                     std::span<hal::byte> p_data_in,
+                                     hal::byte p_filler) override
+  {
+    const auto argument = (tracer::length(p_data_out.size(), 16) << 16) |
+                          tracer::length(p_data_in.size(), 16);
+    return m_tracer(trace_call::spi_transfer, argument, [&]() {
+      return m_driver->transfer(p_data_out, p_data_in, p_filler);
+    });
+  }
+
+  hal::spi* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::serial> : public hal::serial
+{
+public:
+  /**
+   * @brief Factory function to create a traced serial
+   *
+   * @param p_driver - serial port to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::serial& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::serial& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    return m_tracer(trace_call::serial_configure,
+                    tracer::bits(p_settings.baud_rate),
+                    [&]() { return m_driver->configure(p_settings); });
+  }
+
+  result<write_t> driver_write(std::span<const hal::byte> p_data) override
+  {
+    return m_tracer(trace_call::serial_write,
+                    tracer::length(p_data.size()),
+                    [&]() { return m_driver->write(p_data); });
+  }
+
+  result<read_t> driver_read(std::span<hal::byte> p_data) override
+  {
+    return m_tracer.read(
+      trace_call::serial_read,
+      [&]() { return m_driver->read(p_data); },
+      [](const read_t& p_read) { return tracer::length(p_read.data.size()); });
+  }
+
+  result<flush_t> driver_flush() override
+  {
+    return m_tracer(
+      trace_call::serial_flush, 0, [this]() { return m_driver->flush(); });
+  }
+
+  hal::serial* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::socket> : public hal::socket
+{
+public:
+  /**
+   * @brief Factory function to create a traced socket
+   *
+   * @param p_driver - socket to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::socket& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::socket& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<write_t> driver_write(
+    std::span<const hal::byte> p_data,
+    hal::function_ref<hal::timeout_function> p_timeout) override
+  {
+    return m_tracer(trace_call::socket_write,
+                    tracer::length(p_data.size()),
+                    [&]() { return m_driver->write(p_data, p_timeout); });
+  }
+
+  result<read_t> driver_read(std::span<hal::byte> p_data) override
+  {
+    return m_tracer.read(
+      trace_call::socket_read,
+      [&]() { return m_driver->read(p_data); },
+      [](const read_t& p_read) { return tracer::length(p_read.data.size()); });
+  }
+
+  hal::socket* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::can> : public hal::can
+{
+public:
+  /**
+   * @brief Factory function to create a traced can
+   *
+   * @param p_driver - CAN bus to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::can& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::can& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    return m_tracer(trace_call::can_configure,
+                    tracer::bits(p_settings.baud_rate),
+                    [&]() { return m_driver->configure(p_settings); });
+  }
+
+  status driver_bus_on() override
+  {
+    return m_tracer(
+      trace_call::can_bus_on, 0, [this]() { return m_driver->bus_on(); });
+  }
+
+  result<send_t> driver_send(const message_t& p_message) override
+  {
+    return m_tracer(trace_call::can_send, p_message.id, [&]() {
+      return m_driver->send(p_message);
+    });
+  }
+
+  void driver_on_receive(hal::callback<handler> p_handler) override
+  {
+    m_handler = p_handler;
+    m_driver->on_receive([this](const message_t& p_message) {
+      m_tracer.event(trace_call::can_receive, p_message.id, [&]() {
+        m_handler(p_message);
+      });
+    });
+  }
+
+  hal::can* m_driver;
+  tracer m_tracer;
+  hal::callback<handler> m_handler =
+    []([[maybe_unused]] const message_t& p_message) {};
+};
+
+template<>
+class traced<hal::input_pin> : public hal::input_pin
+{
+public:
+  /**
+   * @brief Factory function to create a traced input_pin
+   *
+   * @param p_driver - input pin to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::input_pin& p_driver,
+                               const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::input_pin& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    return m_tracer(trace_call::input_pin_configure,
+                    static_cast<std::uint32_t>(p_settings.resistor),
+                    [&]() { return m_driver->configure(p_settings); });
+  }
+
+  result<level_t> driver_level() override
+  {
+    return m_tracer.read(
+      trace_call::input_pin_level,
+      [this]() { return m_driver->level(); },
+      [](const level_t& p_level) {
+        return static_cast<std::uint32_t>(p_level.state);
+      });
+  }
+
+  hal::input_pin* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::output_pin> : public hal::output_pin
+{
+public:
+  /**
+   * @brief Factory function to create a traced output_pin
+   *
+   * @param p_driver - output pin to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::output_pin& p_driver,
+                               const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::output_pin& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    const auto argument =
+      (static_cast<std::uint32_t>(p_settings.open_drain) << 8) |
+      static_cast<std::uint32_t>(p_settings.resistor);
+    return m_tracer(trace_call::output_pin_configure, argument, [&]() {
+      return m_driver->configure(p_settings);
+    });
+  }
+
+  result<set_level_t> driver_level(bool p_high) override
+  {
+    return m_tracer(trace_call::output_pin_set_level,
+                    static_cast<std::uint32_t>(p_high),
+                    [&]() { return m_driver->level(p_high); });
+  }
+
+  result<level_t> driver_level() override
+  {
+    return m_tracer.read(
+      trace_call::output_pin_level,
+      [this]() { return m_driver->level(); },
+      [](const level_t& p_level) {
+        return static_cast<std::uint32_t>(p_level.state);
+      });
+  }
+
+  hal::output_pin* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::interrupt_pin> : public hal::interrupt_pin
+{
+public:
+  /**
+   * @brief Factory function to create a traced interrupt_pin
+   *
+   * @param p_driver - interrupt pin to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::interrupt_pin& p_driver,
+                               const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::interrupt_pin& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  status driver_configure(const settings& p_settings) override
+  {
+    const auto argument =
+      (static_cast<std::uint32_t>(p_settings.trigger) << 8) |
+      static_cast<std::uint32_t>(p_settings.resistor);
+    return m_tracer(trace_call::interrupt_pin_configure, argument, [&]() {
+      return m_driver->configure(p_settings);
+    });
+  }
+
+  void driver_on_trigger(hal::callback<handler> p_handler) override
+  {
+    m_handler = p_handler;
+    m_driver->on_trigger([this](bool p_level) {
+      m_tracer.event(trace_call::interrupt_pin_trigger,
+                     static_cast<std::uint32_t>(p_level),
+                     [&]() { m_handler(p_level); });
+    });
+  }
+
+  hal::interrupt_pin* m_driver;
+  tracer m_tracer;
+  hal::callback<handler> m_handler = []([[maybe_unused]] bool p_level) {};
+};
+
+template<>
+class traced<hal::timer> : public hal::timer
+{
+public:
+  /**
+   * @brief Factory function to create a traced timer
+   *
+   * @param p_driver - timer to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::timer& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::timer& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<is_running_t> driver_is_running() override
+  {
+    return m_tracer.read(
+      trace_call::timer_is_running,
+      [this]() { return m_driver->is_running(); },
+      [](const is_running_t& p_running) {
+        return static_cast<std::uint32_t>(p_running.is_running);
+      });
+  }
+
+  result<cancel_t> driver_cancel() override
+  {
+    return m_tracer(
+      trace_call::timer_cancel, 0, [this]() { return m_driver->cancel(); });
+  }
+
+  result<schedule_t> driver_schedule(hal::callback<void(void)> p_callback,
+                                     hal::time_duration p_delay) override
+  {
+    const auto microseconds =
+      std::chrono::duration_cast<std::chrono::microseconds>(p_delay).count();
+    const auto argument =
+      tracer::length(static_cast<std::size_t>(std::max<std::int64_t>(
+        microseconds, 0)));
+    m_callback = p_callback;
+    return m_tracer(trace_call::timer_schedule, argument, [&]() {
+      return m_driver->schedule(
+        [this]() {
+          m_tracer.event(
+            trace_call::timer_callback, 0, [this]() { m_callback(); });
+        },
+        p_delay);
+    });
+  }
+
+  hal::timer* m_driver;
+  tracer m_tracer;
+  hal::callback<void(void)> m_callback = []() {};
+};
+
+template<>
+class traced<hal::motor> : public hal::motor
+{
+public:
+  /**
+   * @brief Factory function to create a traced motor
+   *
+   * @param p_driver - motor to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::motor& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::motor& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<power_t> driver_power(float p_power) override
+  {
+    return m_tracer(trace_call::motor_power,
+                    tracer::bits(p_power),
+                    [&]() { return m_driver->power(p_power); });
+  }
+
+  hal::motor* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::servo> : public hal::servo
+{
+public:
+  /**
+   * @brief Factory function to create a traced servo
+   *
+   * @param p_driver - servo to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::servo& p_driver, const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::servo& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<position_t> driver_position(hal::degrees p_position) override
+  {
+    return m_tracer(trace_call::servo_position,
+                    tracer::bits(p_position),
+                    [&]() { return m_driver->position(p_position); });
+  }
+
+  hal::servo* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::rotation_sensor> : public hal::rotation_sensor
+{
+public:
+  /**
+   * @brief Factory function to create a traced rotation_sensor
+   *
+   * @param p_driver - rotation sensor to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::rotation_sensor& p_driver,
+                               const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::rotation_sensor& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<read_t> driver_read() override
+  {
+    return m_tracer.read(
+      trace_call::rotation_sensor_read,
+      [this]() { return m_driver->read(); },
+      [](const read_t& p_read) { return tracer::bits(p_read.angle); });
+  }
+
+  hal::rotation_sensor* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::temperature_sensor> : public hal::temperature_sensor
+{
+public:
+  /**
+   * @brief Factory function to create a traced temperature_sensor
+   *
+   * @param p_driver - temperature sensor to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::temperature_sensor& p_driver,
+                               const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::temperature_sensor& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<read_t> driver_read() override
+  {
+    return m_tracer.read(
+      trace_call::temperature_sensor_read,
+      [this]() { return m_driver->read(); },
+      [](const read_t& p_read) { return tracer::bits(p_read.temperature); });
+  }
+
+  hal::temperature_sensor* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::distance_sensor> : public hal::distance_sensor
+{
+public:
+  /**
+   * @brief Factory function to create a traced distance_sensor
+   *
+   * @param p_driver - distance sensor to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::distance_sensor& p_driver,
+                               const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::distance_sensor& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<read_t> driver_read() override
+  {
+    return m_tracer.read(
+      trace_call::distance_sensor_read,
+      [this]() { return m_driver->read(); },
+      [](const read_t& p_read) { return tracer::bits(p_read.distance); });
+  }
+
+  hal::distance_sensor* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::accelerometer> : public hal::accelerometer
+{
+public:
+  /**
+   * @brief Factory function to create a traced accelerometer
+   *
+   * @param p_driver - accelerometer to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::accelerometer& p_driver,
+                               const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::accelerometer& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<read_t> driver_read() override
+  {
+    return m_tracer.read(
+      trace_call::accelerometer_read,
+      [this]() { return m_driver->read(); },
+      [](const read_t& p_read) { return tracer::bits(p_read.x); });
+  }
+
+  hal::accelerometer* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::gyroscope> : public hal::gyroscope
+{
+public:
+  /**
+   * @brief Factory function to create a traced gyroscope
+   *
+   * @param p_driver - gyroscope to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::gyroscope& p_driver,
+                               const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::gyroscope& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<read_t> driver_read() override
+  {
+    return m_tracer.read(
+      trace_call::gyroscope_read,
+      [this]() { return m_driver->read(); },
+      [](const read_t& p_read) { return tracer::bits(p_read.x); });
+  }
+
+  hal::gyroscope* m_driver;
+  tracer m_tracer;
+};
+
+template<>
+class traced<hal::magnetometer> : public hal::magnetometer
+{
+public:
+  /**
+   * @brief Factory function to create a traced magnetometer
+   *
+   * @param p_driver - magnetometer to trace
+   * @param p_tracer - tracer recording the calls
+   * @return result<traced> - the constructed decorator
+   */
+  static result<traced> create(hal::magnetometer& p_driver,
+                               const tracer& p_tracer)
+  {
+    return traced(p_driver, p_tracer);
+  }
+
+private:
+  traced(hal::magnetometer& p_driver, const tracer& p_tracer)
+    : m_driver(&p_driver)
+    , m_tracer(p_tracer)
+  {
+  }
+
+  result<read_t> driver_read() override
+  {
+    return m_tracer.read(
+      trace_call::magnetometer_read,
+      [this]() { return m_driver->read(); },
+      [](const read_t& p_read) { return tracer::bits(p_read.x); });
+  }
+
+  hal::magnetometer* m_driver;
+  tracer m_tracer;
+};
+}  // namespace hal::soft
@@ -0,0 +1,284 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+
+#include <libhal/dac.hpp>
+#include <libhal/timer.hpp>
+#include <libhal/units.hpp>
+
+namespace hal::soft {
+namespace wavetable_detail {
+/**
+ * @brief Compile time sine of a fraction of a turn
+ *
+ * @param p_turns - angle in turns, from 0.0 to 1.0
+ * @return double - sine of the angle
+ */
+constexpr double sine(double p_turns)
+{
+  // Fold into the first quarter turn, where a short Taylor series converges
+  double sign = 1.0;
+  if (p_turns >= 0.5) {
+    p_turns -= 0.5;
+    sign = -1.0;
+  }
+  if (p_turns > 0.25) {
+    p_turns = 0.5 - p_turns;
+  }
+  const double x = p_turns * 2.0 * std::numbers::pi;
+  double term = x;
+  double sum = x;
+  for (int n = 1; n < 10; n++) {
+    term *= -(x * x) / static_cast<double>((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sign * sum;
+}
+
+/// Map -1.0 to 1.0 onto the full range of a table sample
+constexpr std::uint16_t to_sample(double p_value)
+{
+  return static_cast<std::uint16_t>(32767.5 + 32767.5 * p_value + 0.5);
+}
+}  // namespace wavetable_detail
+
+/**
+ * @brief Generate one period of a sine wave at compile time
+ *
+ * The wave starts at mid scale and rises, reaching full scale a quarter of
+ * the way through the table.
+ *
+ * @tparam Size - number of samples, a power of two
+ * @return std::array<std::uint16_t, Size> - unsigned samples, mid scale at
+ * 32768
+ */
+template<std::size_t Size>
+constexpr std::array<std::uint16_t, Size> make_sine_table()
+{
+  static_assert(std::has_single_bit(Size) && Size >= 2 && Size <= 65536,
+                "Wavetable size must be a power of two from 2 to 65536");
+  std::array<std::uint16_t, Size> table{};
+  for (std::size_t i = 0; i < Size; i++) {
+    const auto turns = static_cast<double>(i) / static_cast<double>(Size);
+    table[i] = wavetable_detail::to_sample(wavetable_detail::sine(turns));
+  }
+  return table;
+}
+
+/**
+ * @brief Generate one period of a triangle wave at compile time
+ *
+ * The wave is in phase with make_sine_table().
+ *
+ * @tparam Size - number of samples, a power of two
+ * @return std::array<std::uint16_t, Size> - unsigned samples, mid scale at
+ * 32768
+ */
+template<std::size_t Size>
+constexpr std::array<std::uint16_t, Size> make_triangle_table()
+{
+  static_assert(std::has_single_bit(Size) && Size >= 2 && Size <= 65536,
+                "Wavetable size must be a power of two from 2 to 65536");
+  std::array<std::uint16_t, Size> table{};
+  for (std::size_t i = 0; i < Size; i++) {
+    const auto turns = static_cast<double>(i) / static_cast<double>(Size);
+    double value = 4.0 * turns;
+    if (turns >= 0.75) {
+      value = 4.0 * turns - 4.0;
+    } else if (turns > 0.25) {
+      value = 2.0 - 4.0 * turns;
+    }
+    table[i] = wavetable_detail::to_sample(value);
+  }
+  return table;
+}
+
+/**
+ * @brief Streams a periodic waveform into a dac using direct digital
+ * synthesis
+ *
+ * A 32 bit phase accumulator advances by a tuning word every sample. The top
+ * bits of the phase index a one period wavetable, and with interpolation
+ * enabled, the bits below them blend linearly towards the next entry. The
+ * output frequency resolution is the sample rate / 2^32, independent of the
+ * table size.
+ *
+ * Each sample is generated with a handful of integer operations in the timer
+ * callback. In block mode, fill() generates samples ahead of time into a
+ * ring buffer, so the timer callback only copies one sample out of the ring.
+ * If the ring runs dry, the last sample is repeated and counted as an
+ * underrun.
+ *
+ * Moving a running generator re-arms the timer for the new object, which
+ * restarts the current sample period. Destroying a running generator cancels
+ * the timer.
+ */
+class waveform_generator
+{
+public:
+  struct settings
+  {
+    /// Rate at which samples are written to the dac
+    hal::hertz sample_rate = 10'000.0f;
+    /// Output frequency, below half of the sample rate
+    hal::hertz frequency = 100.0f;
+    /// Blend between table entries rather than stepping between them
+    bool interpolate = false;
+  };
+
+  /**
+   * @brief Factory function to create a waveform_generator that generates
+   * each sample in the timer callback
+   *
+   * @param p_dac - dac receiving the samples. Must outlive the generator.
+   * @param p_timer - timer pacing the samples. Must outlive the generator and
+   * must not be used for anything else.
+   * @param p_table - one period of the waveform, from make_sine_table(),
+   * make_triangle_table() or the user. Its size must be a power of two from 2
+   * to 65536. Must outlive the generator.
+   * @param p_settings - sample rate, frequency and interpolation
+   * @return result<waveform_generator> - the constructed generator, stopped
+   * @throws std::errc::invalid_argument - if p_table has the wrong size, the
+   * sample rate is below 1Hz, or the frequency is negative or not below half
+   * of the sample rate
+   */
+  static result<waveform_generator> create(
+    hal::dac& p_dac,
+    hal::timer& p_timer,
+    std::span<const std::uint16_t> p_table,
+    const settings& p_settings);
+
+  /**
+   * @brief Factory function to create a waveform_generator in block mode
+   *
+   * @param p_dac - dac receiving the samples. Must outlive the generator.
+   * @param p_timer - timer pacing the samples. Must outlive the generator and
+   * must not be used for anything else.
+   * @param p_table - one period of the waveform, see the other overload
+   * @param p_settings - sample rate, frequency and interpolation
+   * @param p_block - ring of samples generated ahead by fill(). Its size must
+   * be a power of two. Must outlive the generator.
+   * @return result<waveform_generator> - the constructed generator, stopped
+   * @throws std::errc::invalid_argument - if p_table or p_block has the wrong
+   * size, or the settings are invalid, see the other overload
+   */
+  static result<waveform_generator> create(
+    hal::dac& p_dac,
+    hal::timer& p_timer,
+    std::span<const std::uint16_t> p_table,
+    const settings& p_settings,
+    std::span<std::uint16_t> p_block);
+
+  waveform_generator(waveform_generator&& p_other) noexcept;
+  waveform_generator& operator=(waveform_generator&& p_other) = delete;
+  waveform_generator(const waveform_generator&) = delete;
+  waveform_generator& operator=(const waveform_generator&) = delete;
+  ~waveform_generator();
+
+  /**
+   * @brief Start writing samples to the dac
+   *
+   * In block mode, call fill() first so the ring does not start empty.
+   * Starting a running generator does nothing.
+   *
+   * @return status - success or the error from scheduling the timer
+   */
+  status start();
+
+  /**
+   * @brief Stop writing samples to the dac
+   *
+   * The phase is kept, so start() resumes the waveform where it stopped.
+   *
+   * @return status - success or the error from cancelling the timer
+   */
+  status stop();
+
+  /**
+   * @brief Change the output frequency
+   *
+   * The phase is kept, so the waveform stays continuous. In block mode, the
+   * samples already in the ring play out at the old frequency first.
+   *
+   * @param p_frequency - new output frequency
+   * @return status - success or an error
+   * @throws std::errc::invalid_argument - if the frequency is negative or not
+   * below half of the sample rate
+   */
+  status frequency(hal::hertz p_frequency);
+
+  /**
+   * @brief Generate samples into the free space of the block ring
+   *
+   * Call this from the main loop often enough to keep the ring from running
+   * dry. Does nothing outside of block mode.
+   *
+   * @return std::size_t - number of samples generated
+   */
+  std::size_t fill();
+
+  /**
+   * @brief Get the number of times the block ring ran dry
+   *
+   * @return std::uint32_t - underrun count since creation
+   */
+  [[nodiscard]] std::uint32_t underruns() const;
+
+  /**
+   * @brief Get the phase of the next sample to be generated
+   *
+   * @return std::uint32_t - phase, where 2^32 is one full period
+   */
+  [[nodiscard]] std::uint32_t phase() const;
+
+private:
+  waveform_generator(hal::dac& p_dac,
+                     hal::timer& p_timer,
+                     std::span<const std::uint16_t> p_table,
+                     const settings& p_settings,
+                     std::span<std::uint16_t> p_block);
+
+  /// Advance the phase accumulator and look up its sample
+  std::uint16_t next_sample();
+  /// Timer callback, writes one sample and reschedules itself
+  void output();
+
+  hal::dac* m_dac;
+  hal::timer* m_timer;
+  std::span<const std::uint16_t> m_table;
+  std::span<std::uint16_t> m_block;
+  hal::time_duration m_period;
+  float m_sample_rate;
+  std::uint32_t m_tuning_word = 0;
+  std::uint32_t m_phase = 0;
+  /// log2 of the table size
+  std::uint32_t m_table_bits;
+  bool m_interpolate;
+  bool m_running = false;
+  std::uint16_t m_last_sample = 0;
+  /// Samples generated into and played out of the block ring
+  std::atomic<std::uint32_t> m_written{ 0 };
+  std::atomic<std::uint32_t> m_played{ 0 };
+  std::uint32_t m_underruns = 0;
+};
+}  // namespace hal::soft
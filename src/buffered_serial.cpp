@@ -0,0 +1,151 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/buffered_serial.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace hal::soft {
+result<buffered_serial> buffered_serial::create(hal::serial& p_serial,
+                                                std::span<hal::byte> p_buffer)
+{
+  if (!std::has_single_bit(p_buffer.size())) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return buffered_serial(p_serial, p_buffer);
+}
+
+buffered_serial::buffered_serial(hal::serial& p_serial,
+                                 std::span<hal::byte> p_buffer)
+  : m_serial(&p_serial)
+  , m_buffer(p_buffer)
+{
+}
+
+std::size_t buffered_serial::size() const
+{
+  return m_tail - m_head;
+}
+
+std::size_t buffered_serial::capacity() const
+{
+  return m_buffer.size();
+}
+
+result<std::size_t> buffered_serial::fill()
+{
+  const auto mask = m_buffer.size() - 1;
+
+  // The free space is at most two contiguous regions: from the tail to the end
+  // of the buffer, then from the start of the buffer up to the head. Read
+  // directly into each region, stopping early once the port runs dry.
+  while (size() < capacity()) {
+    auto tail_index = m_tail & mask;
+    auto contiguous = std::min(capacity() - size(), capacity() - tail_index);
+    auto region = m_buffer.subspan(tail_index, contiguous);
+    auto received = HAL_CHECK(m_serial->read(region)).data.size();
+    m_tail += received;
+    if (received < region.size()) {
+      break;
+    }
+  }
+
+  return size();
+}
+
+buffered_serial::peek_t buffered_serial::buffered(std::size_t p_count) const
+{
+  const auto head_index = m_head & (m_buffer.size() - 1);
+  const auto first_length = std::min(p_count, capacity() - head_index);
+  return peek_t{
+    .first = m_buffer.subspan(head_index, first_length),
+    .second = m_buffer.first(p_count - first_length),
+  };
+}
+
+result<buffered_serial::peek_t> buffered_serial::peek()
+{
+  HAL_CHECK(fill());
+  return buffered(size());
+}
+
+void buffered_serial::consume(std::size_t p_count)
+{
+  m_head += std::min(p_count, size());
+}
+
+result<buffered_serial::peek_t> buffered_serial::read_until(
+  hal::byte p_delimiter)
+{
+  auto bytes = HAL_CHECK(peek());
+
+  std::size_t length = 0;
+  for (auto region : { bytes.first, bytes.second }) {
+    const auto* found = static_cast<const hal::byte*>(
+      std::memchr(region.data(), p_delimiter, region.size()));
+    if (found != nullptr) {
+      length += static_cast<std::size_t>(found - region.data()) + 1;
+      auto sequence = buffered(length);
+      consume(length);
+      return sequence;
+    }
+    length += region.size();
+  }
+
+  // No more bytes fit, so the delimiter can never arrive
+  if (size() == capacity()) {
+    return hal::new_error(std::errc::no_buffer_space);
+  }
+  return peek_t{};
+}
+
+status buffered_serial::driver_configure(const settings& p_settings)
+{
+  return m_serial->configure(p_settings);
+}
+
+result<serial::write_t> buffered_serial::driver_write(
+  std::span<const hal::byte> p_data)
+{
+  return m_serial->write(p_data);
+}
+
+result<serial::read_t> buffered_serial::driver_read(
+  std::span<hal::byte> p_data)
+{
+  auto bytes = HAL_CHECK(peek());
+
+  auto first_length = std::min(p_data.size(), bytes.first.size());
+  auto second_length =
+    std::min(p_data.size() - first_length, bytes.second.size());
+  std::copy_n(bytes.first.begin(), first_length, p_data.begin());
+  std::copy_n(
+    bytes.second.begin(), second_length, p_data.begin() + first_length);
+  consume(first_length + second_length);
+
+  return read_t{
+    .data = p_data.first(first_length + second_length),
+    .available = size(),
+    .capacity = capacity(),
+  };
+}
+
+result<serial::flush_t> buffered_serial::driver_flush()
+{
+  m_head = m_tail;
+  return m_serial->flush();
+}
+}  // namespace hal::soft
@@ -0,0 +1,183 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/can_tx_queue.hpp>
+
+#include <algorithm>
+
+#include <libhal-soft/can_arbitration.hpp>
+
+namespace hal::soft {
+result<can_tx_queue> can_tx_queue::create(hal::can& p_can,
+                                          std::span<message_t> p_storage)
+{
+  if (p_storage.empty()) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return can_tx_queue(p_can, p_storage, nullptr, hal::time_duration{});
+}
+
+result<can_tx_queue> can_tx_queue::create(hal::can& p_can,
+                                          std::span<message_t> p_storage,
+                                          hal::timer& p_retry_timer,
+                                          hal::time_duration p_retry_period)
+{
+  if (p_storage.empty()) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return can_tx_queue(p_can, p_storage, &p_retry_timer, p_retry_period);
+}
+
+can_tx_queue::can_tx_queue(hal::can& p_can,
+                           std::span<message_t> p_storage,
+                           hal::timer* p_retry_timer,
+                           hal::time_duration p_retry_period)
+  : m_can(&p_can)
+  , m_storage(p_storage)
+  , m_retry_timer(p_retry_timer)
+  , m_retry_period(p_retry_period)
+{
+}
+
+can_tx_queue::can_tx_queue(can_tx_queue&& p_other) noexcept
+  : m_can(p_other.m_can)
+  , m_storage(p_other.m_storage)
+  , m_retry_timer(p_other.m_retry_timer)
+  , m_retry_period(p_other.m_retry_period)
+  , m_size(p_other.m_size)
+  , m_dropped(p_other.m_dropped)
+{
+  // The timer now belongs to this object, so the other must not cancel it
+  p_other.m_retry_timer = nullptr;
+}
+
+can_tx_queue::~can_tx_queue()
+{
+  if (m_retry_timer != nullptr) {
+    (void)m_retry_timer->cancel();
+  }
+}
+
+status can_tx_queue::send_latest(const message_t& p_message)
+{
+  const auto queued = m_storage.first(m_size);
+  auto stale = std::find_if(
+    queued.begin(), queued.end(), [&p_message](const message_t& p_queued) {
+      return p_queued.id == p_message.id;
+    });
+
+  if (stale != queued.end()) {
+    *stale = p_message;
+  } else {
+    HAL_CHECK(enqueue(p_message));
+  }
+
+  transmit();
+  return hal::success();
+}
+
+std::size_t can_tx_queue::transmit()
+{
+  std::size_t sent = 0;
+  while (m_size != 0) {
+    if (!m_can->send(m_storage[m_size - 1])) {
+      break;
+    }
+    m_size--;
+    sent++;
+  }
+
+  if (m_size != 0) {
+    schedule_retry();
+  }
+  return sent;
+}
+
+std::size_t can_tx_queue::size() const
+{
+  return m_size;
+}
+
+std::size_t can_tx_queue::dropped_messages() const
+{
+  return m_dropped;
+}
+
+status can_tx_queue::driver_configure(const settings& p_settings)
+{
+  return m_can->configure(p_settings);
+}
+
+status can_tx_queue::driver_bus_on()
+{
+  HAL_CHECK(m_can->bus_on());
+  transmit();
+  return hal::success();
+}
+
+result<can_tx_queue::send_t> can_tx_queue::driver_send(
+  const message_t& p_message)
+{
+  HAL_CHECK(enqueue(p_message));
+  transmit();
+  return send_t{};
+}
+
+void can_tx_queue::driver_on_receive(hal::callback<handler> p_handler)
+{
+  m_can->on_receive(p_handler);
+}
+
+status can_tx_queue::enqueue(const message_t& p_message)
+{
+  const auto key = can_arbitration_key(p_message);
+  if (m_size == m_storage.size()) {
+    // The front of the queue holds the lowest priority message. Only drop it
+    // for a message that would win arbitration against it.
+    if (can_arbitration_key(m_storage.front()) <= key) {
+      return hal::new_error(std::errc::no_buffer_space);
+    }
+    std::copy(m_storage.begin() + 1, m_storage.end(), m_storage.begin());
+    m_size--;
+    m_dropped++;
+  }
+
+  // Insert in front of every message with the same or a higher priority, so
+  // equal keys are sent oldest first.
+  const auto end = m_storage.begin() + m_size;
+  auto position =
+    std::find_if(m_storage.begin(), end, [key](const message_t& p_queued) {
+      return can_arbitration_key(p_queued) <= key;
+    });
+  std::copy_backward(position, end, end + 1);
+  *position = p_message;
+  m_size++;
+
+  return hal::success();
+}
+
+void can_tx_queue::schedule_retry()
+{
+  if (m_retry_timer == nullptr) {
+    return;
+  }
+
+  auto running = m_retry_timer->is_running();
+  if (running && running.value().is_running) {
+    return;
+  }
+
+  (void)m_retry_timer->schedule([this]() { transmit(); }, m_retry_period);
+}
+}  // namespace hal::soft
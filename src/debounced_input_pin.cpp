@@ -0,0 +1,111 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/debounced_input_pin.hpp>
+
+#include <ratio>
+
+namespace hal::soft {
+result<debounced_input_pin> debounced_input_pin::create(
+  hal::input_pin& p_pin,
+  std::uint8_t p_samples)
+{
+  if (p_samples == 0) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return debounced_input_pin(p_pin, nullptr, 0, p_samples);
+}
+
+result<debounced_input_pin> debounced_input_pin::create(
+  hal::input_pin& p_pin,
+  hal::steady_clock& p_clock,
+  hal::time_duration p_lockout)
+{
+  const auto frequency = p_clock.frequency().operating_frequency;
+  const auto lockout_ticks = static_cast<std::uint64_t>(
+    static_cast<double>(p_lockout.count()) * frequency / std::nano::den);
+
+  if (p_lockout.count() <= 0 || lockout_ticks == 0) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return debounced_input_pin(p_pin, &p_clock, lockout_ticks, 0);
+}
+
+debounced_input_pin::debounced_input_pin(hal::input_pin& p_pin,
+                                         hal::steady_clock* p_clock,
+                                         std::uint64_t p_lockout_ticks,
+                                         std::uint8_t p_samples)
+  : m_pin(&p_pin)
+  , m_clock(p_clock)
+  , m_lockout_ticks(p_lockout_ticks)
+  , m_samples(p_samples)
+{
+}
+
+status debounced_input_pin::driver_configure(const settings& p_settings)
+{
+  HAL_CHECK(m_pin->configure(p_settings));
+  // A new resistor setting can change the level, start over
+  m_started = false;
+  return hal::success();
+}
+
+result<hal::input_pin::level_t> debounced_input_pin::driver_level()
+{
+  if (m_clock != nullptr) {
+    return lock_out();
+  }
+  return integrate();
+}
+
+result<hal::input_pin::level_t> debounced_input_pin::integrate()
+{
+  const auto sample = HAL_CHECK(m_pin->level()).state;
+
+  if (!m_started) {
+    m_started = true;
+    m_state = sample;
+    m_integrator = sample ? m_samples : 0;
+  } else if (sample && m_integrator < m_samples) {
+    m_integrator++;
+  } else if (!sample && m_integrator > 0) {
+    m_integrator--;
+  }
+
+  if (m_integrator == m_samples) {
+    m_state = true;
+  } else if (m_integrator == 0) {
+    m_state = false;
+  }
+  return level_t{ .state = m_state };
+}
+
+result<hal::input_pin::level_t> debounced_input_pin::lock_out()
+{
+  const auto now = m_clock->uptime().ticks;
+  if (m_started && now < m_lockout_end) {
+    return level_t{ .state = m_state };
+  }
+
+  const auto sample = HAL_CHECK(m_pin->level()).state;
+  if (!m_started) {
+    m_started = true;
+    m_state = sample;
+  } else if (sample != m_state) {
+    m_state = sample;
+    m_lockout_end = now + m_lockout_ticks;
+  }
+  return level_t{ .state = m_state };
+}
+}  // namespace hal::soft
@@ -0,0 +1,165 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/fast_clock.hpp>
+
+#include <cmath>
+#include <limits>
+#include <ratio>
+
+namespace hal::soft {
+namespace {
+/**
+ * @brief Compute (p_value * p_factor) >> p_shift without a 128-bit type
+ *
+ * Splits both operands into 32-bit halves, so every partial product is a
+ * 32x32 to 64-bit multiply, which 32-bit cores do in one instruction. The
+ * partial products are summed into the full 128-bit product, so the result is
+ * the exact floor.
+ */
+constexpr std::uint64_t multiply_shift(std::uint64_t p_value,
+                                       std::uint64_t p_factor,
+                                       std::uint8_t p_shift)
+{
+  constexpr std::uint64_t low_mask = 0xFFFF'FFFF;
+  const std::uint64_t low_low = (p_value & low_mask) * (p_factor & low_mask);
+  const std::uint64_t low_high = (p_value & low_mask) * (p_factor >> 32);
+  const std::uint64_t high_low = (p_value >> 32) * (p_factor & low_mask);
+  const std::uint64_t high_high = (p_value >> 32) * (p_factor >> 32);
+
+  const std::uint64_t middle =
+    (low_low >> 32) + (low_high & low_mask) + (high_low & low_mask);
+  const std::uint64_t low = (middle << 32) | (low_low & low_mask);
+  const std::uint64_t high =
+    high_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32);
+
+  if (p_shift == 0) {
+    return low;
+  }
+  if (p_shift >= 64) {
+    return high >> (p_shift - 64);
+  }
+  return (high << (64 - p_shift)) | (low >> p_shift);
+}
+
+static_assert(multiply_shift(3, std::uint64_t{ 1 } << 32, 32) == 3);
+static_assert(multiply_shift(1ULL << 40, 1000ULL << 32, 32) == 1000ULL << 40);
+static_assert(multiply_shift(1ULL << 63, 1ULL << 63, 96) == 1ULL << 30);
+static_assert(multiply_shift(1, 0xFFFF'FFFF, 32) == 0);
+
+/**
+ * @brief Scale a positive ratio into a fixed-point factor with 62 significant
+ * bits
+ *
+ * @param p_ratio - ratio to represent, between 1e-10 and 1e10
+ * @param p_shift - receives the number of fraction bits of the factor
+ * @return std::uint64_t - the factor, p_ratio * 2^p_shift
+ */
+std::uint64_t to_fixed_point(double p_ratio, std::uint8_t& p_shift)
+{
+  p_shift = static_cast<std::uint8_t>(62 - std::ilogb(p_ratio));
+  return static_cast<std::uint64_t>(
+    std::round(std::ldexp(p_ratio, p_shift)));
+}
+}  // namespace
+
+result<fast_clock> fast_clock::create(hal::steady_clock& p_clock,
+                                      std::uint8_t p_counter_bits)
+{
+  const auto frequency = p_clock.frequency().operating_frequency;
+  if (p_counter_bits == 0 || p_counter_bits > 64 || !(frequency >= 1.0f)) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return fast_clock(p_clock, p_counter_bits, frequency);
+}
+
+fast_clock::fast_clock(hal::steady_clock& p_clock,
+                       std::uint8_t p_counter_bits,
+                       hal::hertz p_frequency)
+  : m_clock(&p_clock)
+  , m_frequency(p_frequency)
+  , m_counter_mask(p_counter_bits == 64
+                     ? std::numeric_limits<std::uint64_t>::max()
+                     : (std::uint64_t{ 1 } << p_counter_bits) - 1)
+  , m_counter_bits(p_counter_bits)
+{
+  const auto frequency = static_cast<double>(p_frequency);
+  m_ns_per_tick =
+    to_fixed_point(std::nano::den / frequency, m_ns_per_tick_shift);
+  m_ticks_per_ns =
+    to_fixed_point(frequency / std::nano::den, m_ticks_per_ns_shift);
+  m_last_count = m_clock->uptime().ticks & m_counter_mask;
+}
+
+hal::time_duration fast_clock::to_duration(std::uint64_t p_ticks) const
+{
+  const auto nanoseconds =
+    multiply_shift(p_ticks, m_ns_per_tick, m_ns_per_tick_shift);
+  return hal::time_duration(static_cast<std::int64_t>(nanoseconds));
+}
+
+std::uint64_t fast_clock::to_ticks(hal::time_duration p_duration) const
+{
+  if (p_duration <= hal::time_duration::zero()) {
+    return 0;
+  }
+  return multiply_shift(static_cast<std::uint64_t>(p_duration.count()),
+                        m_ticks_per_ns,
+                        m_ticks_per_ns_shift);
+}
+
+hal::time_duration fast_clock::now()
+{
+  return to_duration(uptime().ticks);
+}
+
+std::uint64_t fast_clock::deadline(hal::time_duration p_duration)
+{
+  return uptime().ticks + to_ticks(p_duration);
+}
+
+void fast_clock::delay(hal::time_duration p_duration)
+{
+  const auto end = deadline(p_duration);
+  while (uptime().ticks < end) {
+    continue;
+  }
+}
+
+hal::time_duration fast_clock::wrap_period() const
+{
+  if (m_counter_bits == 64) {
+    return hal::time_duration::max();
+  }
+  return to_duration(m_counter_mask + 1);
+}
+
+fast_clock::frequency_t fast_clock::driver_frequency()
+{
+  return frequency_t{ .operating_frequency = m_frequency };
+}
+
+fast_clock::uptime_t fast_clock::driver_uptime()
+{
+  const auto count = m_clock->uptime().ticks & m_counter_mask;
+  if (count < m_last_count) {
+    m_wraps++;
+  }
+  m_last_count = count;
+  if (m_counter_bits == 64) {
+    return uptime_t{ .ticks = count };
+  }
+  return uptime_t{ .ticks = (m_wraps << m_counter_bits) | count };
+}
+}  // namespace hal::soft
@@ -0,0 +1,369 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/framing.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace hal::soft {
+namespace {
+constexpr std::uint32_t lsb_of_each_byte = 0x01010101U;
+constexpr std::uint32_t msb_of_each_byte = 0x80808080U;
+
+constexpr std::uint32_t broadcast(hal::byte p_byte)
+{
+  return lsb_of_each_byte * p_byte;
+}
+
+constexpr bool has_zero_byte(std::uint32_t p_word)
+{
+  return ((p_word - lsb_of_each_byte) & ~p_word & msb_of_each_byte) != 0;
+}
+
+/**
+ * @brief Find the first occurrence of either of two bytes
+ *
+ * Scans a 32-bit word at a time and only falls back to checking individual
+ * bytes for the word containing a match and for the tail of the input.
+ *
+ * @param p_data - bytes to search
+ * @param p_first - byte to search for
+ * @param p_second - other byte to search for
+ * @return std::size_t - index of the first match or p_data.size() if there is
+ * no match
+ */
+std::size_t find_either(std::span<const hal::byte> p_data,
+                        hal::byte p_first,
+                        hal::byte p_second)
+{
+  const auto first_pattern = broadcast(p_first);
+  const auto second_pattern = broadcast(p_second);
+
+  std::size_t index = 0;
+  for (; index + sizeof(std::uint32_t) <= p_data.size();
+       index += sizeof(std::uint32_t)) {
+    std::uint32_t word;
+    std::memcpy(&word, p_data.data() + index, sizeof(word));
+    if (has_zero_byte(word ^ first_pattern) ||
+        has_zero_byte(word ^ second_pattern)) {
+      break;
+    }
+  }
+
+  for (; index < p_data.size(); index++) {
+    if (p_data[index] == p_first || p_data[index] == p_second) {
+      break;
+    }
+  }
+
+  return index;
+}
+
+std::size_t find(std::span<const hal::byte> p_data, hal::byte p_byte)
+{
+  return find_either(p_data, p_byte, p_byte);
+}
+
+constexpr std::size_t max_cobs_block = cobs_max_block;
+
+/**
+ * @brief Split a payload into COBS blocks
+ *
+ * @param p_payload - bytes to encode
+ * @param p_emit - called with each code byte and the run of non-zero bytes
+ * that follows it
+ * @return status - success or the first error returned by p_emit
+ */
+template<class Emit>
+status for_each_cobs_block(std::span<const hal::byte> p_payload, Emit p_emit)
+{
+  bool more = true;
+  while (more) {
+    const auto searchable = std::min(p_payload.size(), max_cobs_block);
+    const auto zero = find(p_payload.first(searchable), 0);
+    HAL_CHECK(p_emit(static_cast<hal::byte>(zero + 1), p_payload.first(zero)));
+
+    if (zero == max_cobs_block) {
+      // A full block does not imply a zero, so there is nothing to skip
+      p_payload = p_payload.subspan(zero);
+      more = !p_payload.empty();
+    } else if (zero < p_payload.size()) {
+      // Skip over the zero that the code byte stands in for. A zero at the end
+      // of the payload still needs a final, empty block.
+      p_payload = p_payload.subspan(zero + 1);
+    } else {
+      more = false;
+    }
+  }
+  return hal::success();
+}
+}  // namespace
+
+// Implementations for cobs_decoder
+
+result<cobs_decoder> cobs_decoder::create(std::span<hal::byte> p_buffer)
+{
+  return cobs_decoder(p_buffer);
+}
+
+cobs_decoder::cobs_decoder(std::span<hal::byte> p_buffer)
+  : m_buffer(p_buffer)
+{
+}
+
+void cobs_decoder::reset()
+{
+  m_length = 0;
+  m_block_remaining = 0;
+  m_started = false;
+  m_pending_zero = false;
+  m_discarding = false;
+}
+
+std::size_t cobs_decoder::dropped_frames() const
+{
+  return m_dropped;
+}
+
+frame_decode_t cobs_decoder::decode(std::span<const hal::byte> p_data)
+{
+  while (!p_data.empty()) {
+    if (m_block_remaining == 0) {
+      const auto code = p_data[0];
+      p_data = p_data.subspan(1);
+
+      if (code == 0) {
+        const bool complete = m_started && !m_discarding;
+        const auto length = m_length;
+        reset();
+        if (complete) {
+          return { .remaining = p_data,
+                   .frame = m_buffer.first(length),
+                   .complete = true };
+        }
+        continue;
+      }
+
+      if (m_pending_zero) {
+        if (m_length < m_buffer.size()) {
+          m_buffer[m_length++] = 0;
+        } else if (!m_discarding) {
+          m_discarding = true;
+          m_dropped++;
+        }
+      }
+      m_started = true;
+      m_pending_zero = code != max_cobs_block + 1;
+      m_block_remaining = code - 1;
+      continue;
+    }
+
+    auto block = p_data.first(std::min<std::size_t>(m_block_remaining,
+                                                    p_data.size()));
+    // A delimiter inside of a block means the frame was cut short. Drop it
+    // and let the delimiter start the next frame.
+    const auto delimiter = find(block, 0);
+    if (delimiter != block.size()) {
+      if (!m_discarding) {
+        m_dropped++;
+      }
+      reset();
+      p_data = p_data.subspan(delimiter);
+      continue;
+    }
+
+    if (!m_discarding) {
+      if (m_length + block.size() <= m_buffer.size()) {
+        std::copy(block.begin(), block.end(), m_buffer.begin() + m_length);
+        m_length += block.size();
+      } else {
+        m_discarding = true;
+        m_dropped++;
+      }
+    }
+    m_block_remaining -= static_cast<hal::byte>(block.size());
+    p_data = p_data.subspan(block.size());
+  }
+
+  return { .remaining = p_data };
+}
+
+// Implementations for slip_decoder
+
+result<slip_decoder> slip_decoder::create(std::span<hal::byte> p_buffer)
+{
+  return slip_decoder(p_buffer);
+}
+
+slip_decoder::slip_decoder(std::span<hal::byte> p_buffer)
+  : m_buffer(p_buffer)
+{
+}
+
+void slip_decoder::reset()
+{
+  m_length = 0;
+  m_escaped = false;
+  m_discarding = false;
+}
+
+std::size_t slip_decoder::dropped_frames() const
+{
+  return m_dropped;
+}
+
+void slip_decoder::append(std::span<const hal::byte> p_data)
+{
+  if (m_discarding) {
+    return;
+  }
+  if (m_length + p_data.size() > m_buffer.size()) {
+    m_discarding = true;
+    m_dropped++;
+    return;
+  }
+  std::copy(p_data.begin(), p_data.end(), m_buffer.begin() + m_length);
+  m_length += p_data.size();
+}
+
+frame_decode_t slip_decoder::decode(std::span<const hal::byte> p_data)
+{
+  while (!p_data.empty()) {
+    if (m_escaped) {
+      m_escaped = false;
+      const auto escaped = p_data[0];
+      if (escaped == escaped_end || escaped == escaped_escape) {
+        const hal::byte original = (escaped == escaped_end) ? end : escape;
+        append(std::span(&original, 1));
+        p_data = p_data.subspan(1);
+      } else if (!m_discarding) {
+        // Leave the invalid byte in the input, it may be an end byte that
+        // terminates this frame.
+        m_discarding = true;
+        m_dropped++;
+      }
+      continue;
+    }
+
+    // Copy the run of plain bytes up to the next special byte in one go
+    const auto special = find_either(p_data, end, escape);
+    append(p_data.first(special));
+    p_data = p_data.subspan(special);
+    if (p_data.empty()) {
+      break;
+    }
+
+    const auto special_byte = p_data[0];
+    p_data = p_data.subspan(1);
+    if (special_byte == escape) {
+      m_escaped = true;
+      continue;
+    }
+
+    const bool complete = m_length != 0 && !m_discarding;
+    const auto length = m_length;
+    reset();
+    if (complete) {
+      return { .remaining = p_data,
+               .frame = m_buffer.first(length),
+               .complete = true };
+    }
+  }
+
+  return { .remaining = p_data };
+}
+
+// Implementations for encoders
+
+status write_cobs_frame(hal::serial& p_serial,
+                        std::span<const hal::byte> p_payload)
+{
+  auto write_block = [&p_serial](hal::byte p_code,
+                                 std::span<const hal::byte> p_block) -> status {
+    const std::array<hal::byte, 1> code{ p_code };
+    HAL_CHECK(p_serial.write(code));
+    if (!p_block.empty()) {
+      HAL_CHECK(p_serial.write(p_block));
+    }
+    return hal::success();
+  };
+  HAL_CHECK(for_each_cobs_block(p_payload, write_block));
+
+  constexpr std::array<hal::byte, 1> delimiter{ 0 };
+  HAL_CHECK(p_serial.write(delimiter));
+  return hal::success();
+}
+
+result<std::span<hal::byte>> cobs_encode(std::span<const hal::byte> p_payload,
+                                         std::span<hal::byte> p_output)
+{
+  if (p_output.size() < cobs_max_encoded_size(p_payload.size())) {
+    return hal::new_error(std::errc::no_buffer_space);
+  }
+
+  std::size_t length = 0;
+  auto copy_block = [&p_output, &length](
+                      hal::byte p_code,
+                      std::span<const hal::byte> p_block) -> status {
+    p_output[length++] = p_code;
+    std::copy(p_block.begin(), p_block.end(), p_output.begin() + length);
+    length += p_block.size();
+    return hal::success();
+  };
+  HAL_CHECK(for_each_cobs_block(p_payload, copy_block));
+  p_output[length++] = 0;
+
+  return p_output.first(length);
+}
+
+status write_slip_frame(hal::serial& p_serial,
+                        std::span<const hal::byte> p_payload)
+{
+  constexpr std::array<hal::byte, 1> end_sequence{ slip_decoder::end };
+  constexpr std::array<hal::byte, 2> escaped_end_sequence{
+    slip_decoder::escape, slip_decoder::escaped_end
+  };
+  constexpr std::array<hal::byte, 2> escaped_escape_sequence{
+    slip_decoder::escape, slip_decoder::escaped_escape
+  };
+
+  // A leading end byte flushes any line noise received by the other side
+  HAL_CHECK(p_serial.write(end_sequence));
+
+  while (!p_payload.empty()) {
+    const auto special =
+      find_either(p_payload, slip_decoder::end, slip_decoder::escape);
+    if (special != 0) {
+      HAL_CHECK(p_serial.write(p_payload.first(special)));
+    }
+    p_payload = p_payload.subspan(special);
+    if (p_payload.empty()) {
+      break;
+    }
+
+    if (p_payload[0] == slip_decoder::end) {
+      HAL_CHECK(p_serial.write(escaped_end_sequence));
+    } else {
+      HAL_CHECK(p_serial.write(escaped_escape_sequence));
+    }
+    p_payload = p_payload.subspan(1);
+  }
+
+  HAL_CHECK(p_serial.write(end_sequence));
+  return hal::success();
+}
+}  // namespace hal::soft
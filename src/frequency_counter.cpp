@@ -0,0 +1,209 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/frequency_counter.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <ratio>
+
+namespace hal::soft {
+namespace {
+std::uint64_t to_ticks(hal::time_duration p_duration, double p_frequency)
+{
+  if (p_duration <= hal::time_duration::zero()) {
+    return 0;
+  }
+  return static_cast<std::uint64_t>(static_cast<double>(p_duration.count()) *
+                                    p_frequency / std::nano::den);
+}
+}  // namespace
+
+result<frequency_counter> frequency_counter::create(
+  hal::interrupt_pin& p_pin,
+  hal::steady_clock& p_clock,
+  std::span<std::uint64_t> p_timestamps,
+  const settings& p_settings)
+{
+  const auto frequency =
+    static_cast<double>(p_clock.frequency().operating_frequency);
+  const auto gate_ticks = to_ticks(p_settings.gate_time, frequency);
+  const auto timeout_ticks = to_ticks(p_settings.timeout, frequency);
+
+  if (p_timestamps.size() < 4 || !std::has_single_bit(p_timestamps.size()) ||
+      gate_ticks == 0 || timeout_ticks == 0 ||
+      p_settings.pulses_per_revolution == 0) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+
+  HAL_CHECK(p_pin.configure({
+    .trigger = hal::interrupt_pin::trigger_edge::rising,
+  }));
+  return frequency_counter(p_pin,
+                           p_clock,
+                           p_timestamps,
+                           gate_ticks,
+                           timeout_ticks,
+                           p_settings.pulses_per_revolution);
+}
+
+result<frequency_counter> frequency_counter::create(
+  hal::interrupt_pin& p_pin,
+  hal::steady_clock& p_clock,
+  std::span<std::uint64_t> p_timestamps)
+{
+  return create(p_pin, p_clock, p_timestamps, settings{});
+}
+
+frequency_counter::frequency_counter(hal::interrupt_pin& p_pin,
+                                     hal::steady_clock& p_clock,
+                                     std::span<std::uint64_t> p_timestamps,
+                                     std::uint64_t p_gate_ticks,
+                                     std::uint64_t p_timeout_ticks,
+                                     std::uint32_t p_pulses_per_revolution)
+  : m_pin(&p_pin)
+  , m_clock(&p_clock)
+  , m_timestamps(p_timestamps)
+  , m_clock_frequency(p_clock.frequency().operating_frequency)
+  , m_gate_ticks(p_gate_ticks)
+  , m_timeout_ticks(p_timeout_ticks)
+  , m_pulses_per_revolution(p_pulses_per_revolution)
+  , m_gate_start(p_clock.uptime().ticks)
+{
+  attach();
+}
+
+frequency_counter::frequency_counter(frequency_counter&& p_other) noexcept
+  : m_pin(p_other.m_pin)
+  , m_clock(p_other.m_clock)
+  , m_timestamps(p_other.m_timestamps)
+  , m_clock_frequency(p_other.m_clock_frequency)
+  , m_gate_ticks(p_other.m_gate_ticks)
+  , m_timeout_ticks(p_other.m_timeout_ticks)
+  , m_pulses_per_revolution(p_other.m_pulses_per_revolution)
+  , m_head(p_other.m_head.load())
+  , m_gate_start(p_other.m_gate_start)
+  , m_gate_head(p_other.m_gate_head)
+  , m_gated_ticks(p_other.m_gated_ticks)
+  , m_gated_edges(p_other.m_gated_edges)
+{
+  // The handler now belongs to this object, so the other must not detach
+  p_other.m_pin = nullptr;
+  attach();
+}
+
+frequency_counter::~frequency_counter()
+{
+  detach();
+}
+
+void frequency_counter::attach()
+{
+  m_pin->on_trigger([this]([[maybe_unused]] bool p_level) {
+    // Keep the interrupt down to a timestamp and a store
+    const auto head = m_head.load(std::memory_order_relaxed);
+    m_timestamps[head & (m_timestamps.size() - 1)] = m_clock->uptime().ticks;
+    m_head.store(head + 1, std::memory_order_release);
+  });
+}
+
+void frequency_counter::detach()
+{
+  if (m_pin != nullptr) {
+    m_pin->on_trigger([]([[maybe_unused]] bool p_level) {});
+  }
+}
+
+frequency_counter::measurement_t frequency_counter::measure()
+{
+  const auto size = static_cast<std::uint32_t>(m_timestamps.size());
+  const auto mask = size - 1;
+  auto head = m_head.load(std::memory_order_acquire);
+  auto now = m_clock->uptime().ticks;
+
+  if (now - m_gate_start >= m_gate_ticks) {
+    m_gated_edges = head - m_gate_head;
+    m_gated_ticks = now - m_gate_start;
+    m_gate_head = head;
+    m_gate_start = now;
+  }
+
+  if (head == 0) {
+    return result_of(0.0, counting_method::none);
+  }
+
+  // One slot is left spare, so an edge arriving while the ring is read does
+  // not overwrite the oldest timestamp in use.
+  std::uint64_t newest = 0;
+  std::uint64_t oldest = 0;
+  std::uint32_t count = 0;
+  while (true) {
+    count = std::min(head, size - 1);
+    newest = m_timestamps[(head - 1) & mask];
+    oldest = m_timestamps[(head - count) & mask];
+    const auto after = m_head.load(std::memory_order_acquire);
+    if (after - head <= size - count) {
+      break;
+    }
+    head = after;
+  }
+
+  // Edges may have been stamped after now was read
+  now = std::max(now, newest);
+  if (now - newest > m_timeout_ticks) {
+    return result_of(0.0, counting_method::none);
+  }
+
+  // Relative quantization error of each method, the smaller one wins
+  auto method = counting_method::none;
+  double frequency = 0.0;
+  double error = 2.0;
+
+  const auto span = newest - oldest;
+  if (count > 1 && span > 0) {
+    frequency = (count - 1) * m_clock_frequency / static_cast<double>(span);
+    error = 1.0 / static_cast<double>(span);
+    method = counting_method::reciprocal;
+  }
+
+  if (m_gated_edges > 0 && 1.0 / m_gated_edges < error) {
+    frequency = m_gated_edges * m_clock_frequency /
+                static_cast<double>(m_gated_ticks);
+    method = counting_method::gated;
+  }
+
+  return result_of(frequency, method);
+}
+
+std::uint32_t frequency_counter::edges() const
+{
+  return m_head.load(std::memory_order_relaxed);
+}
+
+frequency_counter::measurement_t frequency_counter::result_of(
+  double p_frequency,
+  counting_method p_method) const
+{
+  if (p_method == counting_method::none) {
+    return {};
+  }
+  return measurement_t{
+    .frequency = static_cast<hal::hertz>(p_frequency),
+    .period = std::chrono::duration_cast<hal::time_duration>(
+      std::chrono::duration<double>(1.0 / p_frequency)),
+    .rpm = static_cast<float>(p_frequency * 60.0 / m_pulses_per_revolution),
+    .method = p_method,
+  };
+}
+}  // namespace hal::soft
@@ -0,0 +1,264 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/h_bridge_motor.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace hal::soft {
+result<h_bridge_motor> h_bridge_motor::create(hal::pwm& p_enable,
+                                              hal::output_pin& p_forward,
+                                              hal::output_pin& p_reverse,
+                                              const settings& p_settings)
+{
+  HAL_CHECK(p_enable.frequency(p_settings.frequency));
+  h_bridge_motor motor(wiring::enable_and_direction,
+                       &p_enable,
+                       nullptr,
+                       &p_forward,
+                       &p_reverse,
+                       p_settings.brake);
+  HAL_CHECK(motor.power(0.0f));
+  return motor;
+}
+
+result<h_bridge_motor> h_bridge_motor::create(hal::pwm& p_forward,
+                                              hal::pwm& p_reverse,
+                                              const settings& p_settings)
+{
+  HAL_CHECK(p_forward.frequency(p_settings.frequency));
+  HAL_CHECK(p_reverse.frequency(p_settings.frequency));
+  h_bridge_motor motor(wiring::dual_pwm,
+                       &p_forward,
+                       &p_reverse,
+                       nullptr,
+                       nullptr,
+                       p_settings.brake);
+  HAL_CHECK(motor.power(0.0f));
+  return motor;
+}
+
+result<h_bridge_motor> h_bridge_motor::create(hal::pwm& p_pwm,
+                                              hal::output_pin& p_enable,
+                                              const settings& p_settings)
+{
+  HAL_CHECK(p_pwm.frequency(p_settings.frequency));
+  h_bridge_motor motor(wiring::locked_antiphase,
+                       &p_pwm,
+                       nullptr,
+                       &p_enable,
+                       nullptr,
+                       p_settings.brake);
+  HAL_CHECK(motor.power(0.0f));
+  return motor;
+}
+
+h_bridge_motor::h_bridge_motor(wiring p_wiring,
+                               hal::pwm* p_pwm,
+                               hal::pwm* p_reverse_pwm,
+                               hal::output_pin* p_forward,
+                               hal::output_pin* p_reverse,
+                               bool p_brake)
+  : m_wiring(p_wiring)
+  , m_pwm(p_pwm)
+  , m_reverse_pwm(p_reverse_pwm)
+  , m_forward(p_forward)
+  , m_reverse(p_reverse)
+  , m_brake(p_brake)
+{
+}
+
+result<h_bridge_motor::power_t> h_bridge_motor::driver_power(float p_power)
+{
+  const auto power = std::clamp(p_power, -1.0f, 1.0f);
+  auto next = direction::stopped;
+  if (power > 0.0f) {
+    next = direction::forward;
+  } else if (power < 0.0f) {
+    next = direction::reverse;
+  }
+
+  switch (m_wiring) {
+    case wiring::enable_and_direction:
+      HAL_CHECK(drive_enable_and_direction(next, std::abs(power)));
+      break;
+    case wiring::dual_pwm:
+      HAL_CHECK(drive_dual_pwm(next, std::abs(power)));
+      break;
+    case wiring::locked_antiphase:
+      HAL_CHECK(drive_locked_antiphase(next, power));
+      break;
+  }
+
+  m_direction = next;
+  return power_t{};
+}
+
+status h_bridge_motor::drive_enable_and_direction(direction p_direction,
+                                                  float p_magnitude)
+{
+  const bool changed = p_direction != m_direction;
+  if (changed) {
+    // Release the bridge so the inputs never swap under a driven load
+    HAL_CHECK(m_pwm->duty_cycle(0.0f));
+    // Both inputs low with the bridge enabled shorts the motor to brake
+    HAL_CHECK(m_forward->level(p_direction == direction::forward));
+    HAL_CHECK(m_reverse->level(p_direction == direction::reverse));
+  }
+
+  if (p_direction == direction::stopped) {
+    // The bridge was just released, which coasts
+    if (changed && m_brake) {
+      HAL_CHECK(m_pwm->duty_cycle(1.0f));
+    }
+    return hal::success();
+  }
+  HAL_CHECK(m_pwm->duty_cycle(p_magnitude));
+  return hal::success();
+}
+
+status h_bridge_motor::drive_dual_pwm(direction p_direction,
+                                      float p_magnitude)
+{
+  const bool changed = p_direction != m_direction;
+  if (changed) {
+    // Coast with both inputs low before driving either one, so leaving a
+    // braking stop never passes through a full power pulse
+    HAL_CHECK(m_pwm->duty_cycle(0.0f));
+    HAL_CHECK(m_reverse_pwm->duty_cycle(0.0f));
+  }
+
+  if (p_direction == direction::stopped) {
+    // Both inputs high brakes
+    if (changed && m_brake) {
+      HAL_CHECK(m_pwm->duty_cycle(1.0f));
+      HAL_CHECK(m_reverse_pwm->duty_cycle(1.0f));
+    }
+    return hal::success();
+  }
+
+  auto* active = p_direction == direction::forward ? m_pwm : m_reverse_pwm;
+  HAL_CHECK(active->duty_cycle(p_magnitude));
+  return hal::success();
+}
+
+status h_bridge_motor::drive_locked_antiphase(direction p_direction,
+                                              float p_power)
+{
+  // Only coasting disables the bridge, so the enable input changes when
+  // entering or leaving a coasting stop
+  const bool coasting = p_direction == direction::stopped && !m_brake;
+  const bool was_coasting = m_direction == direction::stopped && !m_brake;
+
+  // 50% is zero power, when the bridge is enabled it holds the motor still
+  HAL_CHECK(m_pwm->duty_cycle(0.5f + 0.5f * p_power));
+  if (coasting != was_coasting || m_direction == direction::unknown) {
+    HAL_CHECK(m_forward->level(!coasting));
+  }
+  return hal::success();
+}
+
+result<slew_limited_motor> slew_limited_motor::create(
+  hal::motor& p_motor,
+  hal::timer& p_timer,
+  const settings& p_settings)
+{
+  if (!(p_settings.rate > 0.0f) ||
+      p_settings.period <= hal::time_duration::zero()) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return slew_limited_motor(p_motor, p_timer, p_settings);
+}
+
+slew_limited_motor::slew_limited_motor(hal::motor& p_motor,
+                                       hal::timer& p_timer,
+                                       const settings& p_settings)
+  : m_motor(&p_motor)
+  , m_timer(&p_timer)
+  , m_period(p_settings.period)
+  , m_step(p_settings.rate *
+           std::chrono::duration<float>(p_settings.period).count())
+{
+}
+
+slew_limited_motor::slew_limited_motor(slew_limited_motor&& p_other) noexcept
+  : m_motor(p_other.m_motor)
+  , m_timer(p_other.m_timer)
+  , m_period(p_other.m_period)
+  , m_step(p_other.m_step)
+  , m_target(p_other.m_target)
+  , m_output(p_other.m_output)
+  , m_ramping(p_other.m_ramping)
+{
+  // The pending update refers to the other object, so point it here
+  p_other.m_ramping = false;
+  if (m_ramping) {
+    m_ramping =
+      bool{ m_timer->schedule([this]() { (void)ramp(); }, m_period) };
+  }
+}
+
+slew_limited_motor::~slew_limited_motor()
+{
+  if (m_ramping) {
+    (void)m_timer->cancel();
+  }
+}
+
+float slew_limited_motor::output() const
+{
+  return m_output;
+}
+
+result<slew_limited_motor::power_t> slew_limited_motor::driver_power(
+  float p_power)
+{
+  m_target = std::clamp(p_power, -1.0f, 1.0f);
+  // While ramping, the next update picks up the new target
+  if (!m_ramping) {
+    HAL_CHECK(ramp());
+  }
+  return power_t{};
+}
+
+status slew_limited_motor::ramp()
+{
+  const auto target = m_target;
+  const auto difference = target - m_output;
+  // Land exactly on the target rather than a rounding error away from it
+  if (std::abs(difference) <= m_step) {
+    m_output = target;
+  } else {
+    m_output += difference > 0.0f ? m_step : -m_step;
+  }
+
+  // The flag stays set until the timer is known not to be re-armed, so a
+  // power() call never starts a second ramp next to this one.
+  auto applied = m_motor->power(m_output);
+  if (!applied || m_output == target) {
+    m_ramping = false;
+    HAL_CHECK(applied);
+    return hal::success();
+  }
+
+  m_ramping = true;
+  auto scheduled = m_timer->schedule([this]() { (void)ramp(); }, m_period);
+  if (!scheduled) {
+    m_ramping = false;
+    HAL_CHECK(scheduled);
+  }
+  return hal::success();
+}
+}  // namespace hal::soft
@@ -0,0 +1,418 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/isotp.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace hal::soft {
+namespace {
+// Protocol control information: frame type in the upper nibble of byte 0
+constexpr hal::byte single_frame = 0x00;
+constexpr hal::byte first_frame = 0x10;
+constexpr hal::byte consecutive_frame = 0x20;
+constexpr hal::byte flow_control = 0x30;
+
+// Flow status in the lower nibble of a flow control frame
+constexpr hal::byte flow_continue = 0x0;
+constexpr hal::byte flow_wait = 0x1;
+constexpr hal::byte flow_overflow = 0x2;
+
+constexpr std::size_t frame_size = 8;
+constexpr std::size_t single_frame_capacity = frame_size - 1;
+constexpr std::size_t consecutive_frame_capacity = frame_size - 1;
+
+/**
+ * @brief Decode an STmin byte into a duration
+ *
+ * 0x00 to 0x7F are milliseconds and 0xF1 to 0xF9 are 100us to 900us. Reserved
+ * values must be treated as the longest valid time, 127ms.
+ */
+hal::time_duration decode_separation_time(hal::byte p_separation_time)
+{
+  using namespace std::chrono_literals;
+  if (p_separation_time <= 0x7F) {
+    return std::chrono::milliseconds(p_separation_time);
+  }
+  if (p_separation_time >= 0xF1 && p_separation_time <= 0xF9) {
+    return std::chrono::microseconds(100 * (p_separation_time - 0xF0));
+  }
+  return 127ms;
+}
+}  // namespace
+
+result<isotp_session> isotp_session::create(
+  hal::can& p_can,
+  hal::timer& p_timer,
+  std::span<hal::byte> p_receive_buffer,
+  const settings& p_settings)
+{
+  return isotp_session(p_can, p_timer, p_receive_buffer, p_settings);
+}
+
+isotp_session::isotp_session(hal::can& p_can,
+                             hal::timer& p_timer,
+                             std::span<hal::byte> p_receive_buffer,
+                             const settings& p_settings)
+  : m_can(&p_can)
+  , m_timer(&p_timer)
+  , m_receive_buffer(p_receive_buffer)
+  , m_settings(p_settings)
+{
+}
+
+isotp_session::isotp_session(isotp_session&& p_other) noexcept
+  : m_can(p_other.m_can)
+  , m_timer(p_other.m_timer)
+  , m_receive_buffer(p_other.m_receive_buffer)
+  , m_settings(p_other.m_settings)
+  , m_receive_handler(p_other.m_receive_handler)
+  , m_transmit_data(p_other.m_transmit_data)
+  , m_transmit_offset(p_other.m_transmit_offset)
+  , m_separation_time(p_other.m_separation_time)
+  , m_transmit_state(p_other.m_transmit_state)
+  , m_transmit_sequence(p_other.m_transmit_sequence)
+  , m_peer_block_size(p_other.m_peer_block_size)
+  , m_transmit_block_left(p_other.m_transmit_block_left)
+  , m_wait_frames(p_other.m_wait_frames)
+  , m_receive_length(p_other.m_receive_length)
+  , m_receive_offset(p_other.m_receive_offset)
+  , m_aborted(p_other.m_aborted)
+  , m_receiving(p_other.m_receiving)
+  , m_receive_sequence(p_other.m_receive_sequence)
+  , m_receive_block_left(p_other.m_receive_block_left)
+{
+  // Any pending timer callback is now this object's, so the other must not
+  // cancel it
+  p_other.m_transmit_state = transmit_state::idle;
+}
+
+isotp_session::~isotp_session()
+{
+  if (m_transmit_state != transmit_state::idle) {
+    (void)m_timer->cancel();
+  }
+}
+
+status isotp_session::send(std::span<const hal::byte> p_payload)
+{
+  if (m_transmit_state != transmit_state::idle) {
+    return hal::new_error(std::errc::device_or_resource_busy);
+  }
+  if (p_payload.empty()) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+
+  if (p_payload.size() <= single_frame_capacity) {
+    const std::array header{ static_cast<hal::byte>(
+      single_frame | p_payload.size()) };
+    if (!send_frame(header, p_payload)) {
+      return hal::new_error(std::errc::device_or_resource_busy);
+    }
+    return hal::success();
+  }
+
+  const auto length = p_payload.size();
+  std::array<hal::byte, 6> header_storage{};
+  std::span<hal::byte> header(header_storage);
+  if (length <= max_short_length) {
+    header_storage[0] = static_cast<hal::byte>(first_frame | (length >> 8));
+    header_storage[1] = static_cast<hal::byte>(length);
+    header = header.first(2);
+  } else {
+    // Escape sequence: a zero 12-bit length followed by a 32-bit length
+    header_storage[0] = first_frame;
+    header_storage[1] = 0x00;
+    header_storage[2] = static_cast<hal::byte>(length >> 24);
+    header_storage[3] = static_cast<hal::byte>(length >> 16);
+    header_storage[4] = static_cast<hal::byte>(length >> 8);
+    header_storage[5] = static_cast<hal::byte>(length);
+  }
+  const auto first_data = p_payload.first(frame_size - header.size());
+
+  // The flow control reply can arrive before send_frame() returns, so the
+  // session must already be waiting for it.
+  m_transmit_data = p_payload;
+  m_transmit_offset = first_data.size();
+  m_transmit_sequence = 1;
+  m_wait_frames = 0;
+  HAL_CHECK(m_timer->schedule([this]() { abort(); },
+                              m_settings.flow_control_timeout));
+  m_transmit_state = transmit_state::waiting_for_flow_control;
+
+  if (!send_frame(header, first_data)) {
+    (void)m_timer->cancel();
+    m_transmit_state = transmit_state::idle;
+    return hal::new_error(std::errc::device_or_resource_busy);
+  }
+  return hal::success();
+}
+
+void isotp_session::abort()
+{
+  if (m_transmit_state == transmit_state::idle) {
+    return;
+  }
+  (void)m_timer->cancel();
+  m_transmit_state = transmit_state::idle;
+  m_aborted++;
+}
+
+void isotp_session::on_receive(hal::callback<receive_handler> p_handler)
+{
+  m_receive_handler = p_handler;
+}
+
+void isotp_session::operator()(const hal::can::message_t& p_message)
+{
+  if (p_message.id != m_settings.receive_id || p_message.length == 0) {
+    return;
+  }
+
+  switch (p_message.payload[0] & 0xF0) {
+    case single_frame:
+      receive_single_frame(p_message);
+      break;
+    case first_frame:
+      receive_first_frame(p_message);
+      break;
+    case consecutive_frame:
+      receive_consecutive_frame(p_message);
+      break;
+    case flow_control:
+      receive_flow_control(p_message);
+      break;
+    default:
+      break;
+  }
+}
+
+bool isotp_session::transmitting() const
+{
+  return m_transmit_state != transmit_state::idle;
+}
+
+std::size_t isotp_session::aborted_transfers() const
+{
+  return m_aborted;
+}
+
+bool isotp_session::send_frame(std::span<const hal::byte> p_header,
+                               std::span<const hal::byte> p_data)
+{
+  hal::can::message_t message{
+    .id = m_settings.transmit_id,
+    .length = static_cast<std::uint8_t>(frame_size),
+  };
+  auto end =
+    std::copy(p_header.begin(), p_header.end(), message.payload.begin());
+  end = std::copy(p_data.begin(), p_data.end(), end);
+  std::fill(end, message.payload.end(), m_settings.padding);
+  return bool{ m_can->send(message) };
+}
+
+void isotp_session::send_flow_control(hal::byte p_flow_status)
+{
+  const std::array header{
+    static_cast<hal::byte>(flow_control | p_flow_status),
+    m_settings.block_size,
+    m_settings.separation_time,
+  };
+  (void)send_frame(header, {});
+}
+
+void isotp_session::send_consecutive_frames()
+{
+  while (m_transmit_state == transmit_state::sending) {
+    const auto remaining = m_transmit_data.subspan(m_transmit_offset);
+    const auto data =
+      remaining.first(std::min(remaining.size(), consecutive_frame_capacity));
+    const auto sequence = m_transmit_sequence;
+    const std::array header{ static_cast<hal::byte>(consecutive_frame |
+                                                    sequence) };
+
+    // Advance before sending, as with send(), then roll back on failure
+    const bool ends_block = m_peer_block_size != 0;
+    m_transmit_offset += data.size();
+    m_transmit_sequence = (sequence + 1) & 0x0F;
+    if (ends_block) {
+      m_transmit_block_left--;
+    }
+    if (m_transmit_offset == m_transmit_data.size()) {
+      m_transmit_state = transmit_state::idle;
+    } else if (ends_block && m_transmit_block_left == 0) {
+      m_transmit_state = transmit_state::waiting_for_flow_control;
+    }
+
+    if (!send_frame(header, data)) {
+      m_transmit_offset -= data.size();
+      m_transmit_sequence = sequence;
+      if (ends_block) {
+        m_transmit_block_left++;
+      }
+      m_transmit_state = transmit_state::sending;
+      if (!m_timer->schedule([this]() { send_consecutive_frames(); },
+                             retry_delay)) {
+        abort();
+      }
+      return;
+    }
+
+    if (m_transmit_state == transmit_state::waiting_for_flow_control) {
+      m_wait_frames = 0;
+      await_flow_control();
+      return;
+    }
+
+    if (m_transmit_state == transmit_state::sending &&
+        m_separation_time != hal::time_duration::zero()) {
+      if (!m_timer->schedule([this]() { send_consecutive_frames(); },
+                             m_separation_time)) {
+        abort();
+      }
+      return;
+    }
+  }
+}
+
+void isotp_session::await_flow_control()
+{
+  if (!m_timer->schedule([this]() { abort(); },
+                         m_settings.flow_control_timeout)) {
+    abort();
+  }
+}
+
+void isotp_session::receive_single_frame(const hal::can::message_t& p_message)
+{
+  const std::size_t length = p_message.payload[0] & 0x0F;
+  if (length == 0 || length > single_frame_capacity ||
+      length >= p_message.length || length > m_receive_buffer.size()) {
+    return;
+  }
+
+  // A single frame abandons any reception in progress
+  m_receiving = false;
+  std::copy_n(p_message.payload.begin() + 1, length, m_receive_buffer.begin());
+  m_receive_handler(m_receive_buffer.first(length));
+}
+
+void isotp_session::receive_first_frame(const hal::can::message_t& p_message)
+{
+  // A first frame always fills the whole CAN frame, so any other length is a
+  // malformed frame and must be ignored.
+  if (p_message.length != frame_size) {
+    return;
+  }
+
+  std::size_t length =
+    ((p_message.payload[0] & 0x0F) << 8) | p_message.payload[1];
+  std::size_t header_size = 2;
+  if (length == 0) {
+    length = (std::size_t{ p_message.payload[2] } << 24) |
+             (std::size_t{ p_message.payload[3] } << 16) |
+             (std::size_t{ p_message.payload[4] } << 8) |
+             std::size_t{ p_message.payload[5] };
+    header_size = 6;
+  }
+  if (length <= single_frame_capacity) {
+    return;
+  }
+
+  // A new first frame replaces any reception in progress
+  m_receiving = false;
+  if (length > m_receive_buffer.size()) {
+    send_flow_control(flow_overflow);
+    return;
+  }
+
+  const auto data_size = std::min(frame_size - header_size, length);
+  std::copy_n(p_message.payload.begin() + header_size,
+              data_size,
+              m_receive_buffer.begin());
+  m_receive_length = length;
+  m_receive_offset = data_size;
+  m_receive_sequence = 1;
+  m_receive_block_left = m_settings.block_size;
+  m_receiving = true;
+  send_flow_control(flow_continue);
+}
+
+void isotp_session::receive_consecutive_frame(
+  const hal::can::message_t& p_message)
+{
+  if (!m_receiving) {
+    return;
+  }
+
+  if ((p_message.payload[0] & 0x0F) != m_receive_sequence) {
+    m_receiving = false;
+    m_aborted++;
+    return;
+  }
+
+  const auto data_size = std::min<std::size_t>(
+    { p_message.length - std::size_t{ 1 },
+      consecutive_frame_capacity,
+      m_receive_length - m_receive_offset });
+  std::copy_n(p_message.payload.begin() + 1,
+              data_size,
+              m_receive_buffer.begin() + m_receive_offset);
+  m_receive_offset += data_size;
+  m_receive_sequence = (m_receive_sequence + 1) & 0x0F;
+
+  if (m_receive_offset == m_receive_length) {
+    m_receiving = false;
+    m_receive_handler(m_receive_buffer.first(m_receive_length));
+    return;
+  }
+
+  if (m_settings.block_size != 0 && --m_receive_block_left == 0) {
+    m_receive_block_left = m_settings.block_size;
+    send_flow_control(flow_continue);
+  }
+}
+
+void isotp_session::receive_flow_control(const hal::can::message_t& p_message)
+{
+  if (m_transmit_state != transmit_state::waiting_for_flow_control ||
+      p_message.length < 3) {
+    return;
+  }
+
+  switch (p_message.payload[0] & 0x0F) {
+    case flow_continue:
+      (void)m_timer->cancel();
+      m_peer_block_size = p_message.payload[1];
+      m_transmit_block_left = m_peer_block_size;
+      m_separation_time = decode_separation_time(p_message.payload[2]);
+      m_transmit_state = transmit_state::sending;
+      send_consecutive_frames();
+      break;
+    case flow_wait:
+      // Each wait frame restarts the timeout, up to N_WFTmax in a row
+      if (m_wait_frames >= m_settings.max_wait_frames) {
+        abort();
+        break;
+      }
+      m_wait_frames++;
+      await_flow_control();
+      break;
+    default:
+      abort();
+      break;
+  }
+}
+}  // namespace hal::soft
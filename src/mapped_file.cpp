@@ -0,0 +1,89 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/mapped_file.hpp>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hal::soft {
+result<mapped_file> mapped_file::create(const char* p_path)
+{
+  const int descriptor = ::open(p_path, O_RDONLY | O_CLOEXEC);
+  if (descriptor < 0) {
+    return hal::new_error(static_cast<std::errc>(errno));
+  }
+
+  struct stat info;
+  if (::fstat(descriptor, &info) != 0) {
+    const auto error = static_cast<std::errc>(errno);
+    ::close(descriptor);
+    return hal::new_error(error);
+  }
+
+  // mmap rejects zero length mappings, an empty file maps to an empty span
+  const auto size = static_cast<std::size_t>(info.st_size);
+  void* address = nullptr;
+  auto error = std::errc{};
+  if (size != 0) {
+    address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (address == MAP_FAILED) {
+      error = static_cast<std::errc>(errno);
+    }
+  }
+  // The mapping keeps its own reference to the file
+  ::close(descriptor);
+  if (address == MAP_FAILED) {
+    return hal::new_error(error);
+  }
+
+  if (address != nullptr) {
+    ::madvise(address, size, MADV_SEQUENTIAL);
+  }
+  return mapped_file(static_cast<const hal::byte*>(address), size);
+}
+
+mapped_file::mapped_file(const hal::byte* p_data, std::size_t p_size)
+  : m_data(p_data)
+  , m_size(p_size)
+{
+}
+
+mapped_file::mapped_file(mapped_file&& p_other) noexcept
+  : m_data(p_other.m_data)
+  , m_size(p_other.m_size)
+{
+  p_other.m_data = nullptr;
+  p_other.m_size = 0;
+}
+
+mapped_file::~mapped_file()
+{
+  if (m_data != nullptr) {
+    ::munmap(const_cast<hal::byte*>(m_data), m_size);
+  }
+}
+
+std::span<const hal::byte> mapped_file::data() const
+{
+  return { m_data, m_size };
+}
+}  // namespace hal::soft
+#endif
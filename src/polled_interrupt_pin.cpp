@@ -0,0 +1,191 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/polled_interrupt_pin.hpp>
+
+#include <bit>
+
+namespace hal::soft {
+namespace {
+constexpr std::uint32_t all_pins = 0xFFFF'FFFF;
+static_assert(pin_poller::max_pins == 32);
+}  // namespace
+
+result<pin_poller> pin_poller::create(hal::timer& p_timer,
+                                      hal::time_duration p_period)
+{
+  if (p_period <= hal::time_duration::zero()) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return pin_poller(p_timer, p_period);
+}
+
+pin_poller::pin_poller(hal::timer& p_timer, hal::time_duration p_period)
+  : m_timer(&p_timer)
+  , m_period(p_period)
+{
+}
+
+void pin_poller::poll()
+{
+  auto sample = m_levels;
+  auto remaining = m_attached;
+  while (remaining != 0) {
+    const auto index = std::countr_zero(remaining);
+    const auto bit = std::uint32_t{ 1 } << index;
+    remaining &= ~bit;
+    auto level = m_pins[index]->level();
+    if (!level) {
+      m_read_errors++;
+      continue;
+    }
+    sample = level.value().state ? (sample | bit) : (sample & ~bit);
+  }
+
+  const auto changed = sample ^ m_levels;
+  auto fired = changed & ((sample & m_rising) | (~sample & m_falling));
+  m_levels = sample;
+
+  while (fired != 0) {
+    const auto index = std::countr_zero(fired);
+    const auto bit = std::uint32_t{ 1 } << index;
+    fired &= ~bit;
+    // A handler may have detached another pin that fired in this poll
+    if ((m_attached & bit) != 0 && m_handlers[index]) {
+      m_handlers[index]((sample & bit) != 0);
+    }
+  }
+}
+
+std::uint32_t pin_poller::read_errors() const
+{
+  return m_read_errors;
+}
+
+result<std::size_t> pin_poller::attach(hal::input_pin& p_pin)
+{
+  if (m_attached == all_pins) {
+    return hal::new_error(std::errc::no_buffer_space);
+  }
+  const auto state = HAL_CHECK(p_pin.level()).state;
+  const auto index = static_cast<std::size_t>(std::countr_one(m_attached));
+  const auto bit = std::uint32_t{ 1 } << index;
+
+  m_pins[index] = &p_pin;
+  m_handlers[index] = nullptr;
+  m_attached |= bit;
+  m_levels = state ? (m_levels | bit) : (m_levels & ~bit);
+  m_rising |= bit;
+  m_falling &= ~bit;
+  return index;
+}
+
+void pin_poller::detach(std::size_t p_index)
+{
+  const auto bit = std::uint32_t{ 1 } << p_index;
+  m_attached &= ~bit;
+  m_rising &= ~bit;
+  m_falling &= ~bit;
+  m_pins[p_index] = nullptr;
+  m_handlers[p_index] = nullptr;
+
+  if (m_attached == 0 && m_armed) {
+    (void)m_timer->cancel();
+    m_armed = false;
+  }
+}
+
+status pin_poller::configure(std::size_t p_index,
+                             const hal::interrupt_pin::settings& p_settings)
+{
+  auto& pin = *m_pins[p_index];
+  HAL_CHECK(pin.configure({ .resistor = p_settings.resistor }));
+  // The new resistor setting may have changed the level, which is not an edge
+  const auto state = HAL_CHECK(pin.level()).state;
+
+  using trigger_edge = hal::interrupt_pin::trigger_edge;
+  const auto bit = std::uint32_t{ 1 } << p_index;
+  const bool rising = p_settings.trigger != trigger_edge::falling;
+  const bool falling = p_settings.trigger != trigger_edge::rising;
+  m_levels = state ? (m_levels | bit) : (m_levels & ~bit);
+  m_rising = rising ? (m_rising | bit) : (m_rising & ~bit);
+  m_falling = falling ? (m_falling | bit) : (m_falling & ~bit);
+
+  arm();
+  return hal::success();
+}
+
+void pin_poller::on_trigger(
+  std::size_t p_index,
+  hal::callback<hal::interrupt_pin::handler> p_handler)
+{
+  m_handlers[p_index] = p_handler;
+  arm();
+}
+
+void pin_poller::arm()
+{
+  if (m_armed || m_attached == 0) {
+    return;
+  }
+  auto result = m_timer->schedule(
+    [this]() {
+      m_armed = false;
+      poll();
+      arm();
+    },
+    m_period);
+  m_armed = static_cast<bool>(result);
+}
+
+result<polled_interrupt_pin> polled_interrupt_pin::create(
+  pin_poller& p_poller,
+  hal::input_pin& p_pin)
+{
+  const auto index = HAL_CHECK(p_poller.attach(p_pin));
+  return polled_interrupt_pin(p_poller, index);
+}
+
+polled_interrupt_pin::polled_interrupt_pin(pin_poller& p_poller,
+                                           std::size_t p_index)
+  : m_poller(&p_poller)
+  , m_index(p_index)
+{
+}
+
+polled_interrupt_pin::polled_interrupt_pin(
+  polled_interrupt_pin&& p_other) noexcept
+  : m_poller(p_other.m_poller)
+  , m_index(p_other.m_index)
+{
+  p_other.m_poller = nullptr;
+}
+
+polled_interrupt_pin::~polled_interrupt_pin()
+{
+  if (m_poller != nullptr) {
+    m_poller->detach(m_index);
+  }
+}
+
+status polled_interrupt_pin::driver_configure(const settings& p_settings)
+{
+  return m_poller->configure(m_index, p_settings);
+}
+
+void polled_interrupt_pin::driver_on_trigger(hal::callback<handler> p_handler)
+{
+  m_poller->on_trigger(m_index, p_handler);
+}
+}  // namespace hal::soft
@@ -0,0 +1,161 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/pwm_dac.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace hal::soft {
+namespace {
+constexpr std::uint32_t fraction_bits = 16;
+constexpr std::uint32_t fraction_mask = (1U << fraction_bits) - 1;
+constexpr std::uint32_t percentage_bits = 24;
+
+/// Duty cycle in hardware steps, 16.16 fixed point
+std::int64_t to_fixed_steps(float p_duty_cycle, std::uint32_t p_steps)
+{
+  return std::llround(static_cast<double>(p_duty_cycle) * p_steps *
+                      (1U << fraction_bits));
+}
+
+bool is_duty_cycle(float p_value)
+{
+  return p_value >= 0.0f && p_value <= 1.0f;
+}
+}  // namespace
+
+result<pwm_dac> pwm_dac::create(hal::pwm& p_pwm, const settings& p_settings)
+{
+  if (!is_duty_cycle(p_settings.minimum_duty_cycle) ||
+      !is_duty_cycle(p_settings.maximum_duty_cycle)) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  HAL_CHECK(p_pwm.frequency(p_settings.frequency));
+  return pwm_dac(p_pwm, nullptr, p_settings, dither_settings{});
+}
+
+result<pwm_dac> pwm_dac::create(hal::pwm& p_pwm,
+                                hal::timer& p_timer,
+                                const settings& p_settings,
+                                const dither_settings& p_dither)
+{
+  if (!is_duty_cycle(p_settings.minimum_duty_cycle) ||
+      !is_duty_cycle(p_settings.maximum_duty_cycle) || p_dither.steps == 0 ||
+      p_dither.steps > fraction_mask ||
+      p_dither.period <= hal::time_duration::zero()) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  HAL_CHECK(p_pwm.frequency(p_settings.frequency));
+  return pwm_dac(p_pwm, &p_timer, p_settings, p_dither);
+}
+
+pwm_dac::pwm_dac(hal::pwm& p_pwm,
+                 hal::timer* p_timer,
+                 const settings& p_settings,
+                 const dither_settings& p_dither)
+  : m_pwm(&p_pwm)
+  , m_timer(p_timer)
+  , m_period(p_dither.period)
+  , m_offset(p_settings.minimum_duty_cycle)
+  , m_scale(p_settings.maximum_duty_cycle - p_settings.minimum_duty_cycle)
+  , m_step_size(1.0f / static_cast<float>(p_dither.steps))
+  , m_fixed_offset(static_cast<std::uint32_t>(
+      to_fixed_steps(p_settings.minimum_duty_cycle, p_dither.steps)))
+  , m_fixed_scale(
+      to_fixed_steps(p_settings.maximum_duty_cycle, p_dither.steps) -
+      m_fixed_offset)
+{
+}
+
+pwm_dac::pwm_dac(pwm_dac&& p_other) noexcept
+  : m_pwm(p_other.m_pwm)
+  , m_timer(p_other.m_timer)
+  , m_period(p_other.m_period)
+  , m_offset(p_other.m_offset)
+  , m_scale(p_other.m_scale)
+  , m_step_size(p_other.m_step_size)
+  , m_fixed_offset(p_other.m_fixed_offset)
+  , m_fixed_scale(p_other.m_fixed_scale)
+  , m_target(p_other.m_target)
+  , m_accumulator(p_other.m_accumulator)
+  , m_dithering(p_other.m_dithering)
+{
+  // The pending update refers to the other object, so point it here
+  p_other.m_dithering = false;
+  if (m_dithering) {
+    m_dithering = bool{ m_timer->schedule([this]() { (void)dither(); },
+                                          m_period) };
+  }
+}
+
+pwm_dac::~pwm_dac()
+{
+  if (m_dithering) {
+    (void)m_timer->cancel();
+  }
+}
+
+result<pwm_dac::write_t> pwm_dac::driver_write(float p_percentage)
+{
+  const auto percentage = std::clamp(p_percentage, 0.0f, 1.0f);
+
+  if (m_timer == nullptr) {
+    HAL_CHECK(m_pwm->duty_cycle(m_offset + percentage * m_scale));
+    return write_t{};
+  }
+
+  // Scaling by a power of two is exact, so only bits below 2^-24 are lost
+  constexpr auto percentage_scale = static_cast<float>(1U << percentage_bits);
+  const auto fixed_percentage =
+    static_cast<std::int64_t>(percentage * percentage_scale);
+  const auto rounding = std::int64_t{ 1 } << (percentage_bits - 1);
+  m_target = static_cast<std::uint32_t>(
+    m_fixed_offset +
+    ((fixed_percentage * m_fixed_scale + rounding) >> percentage_bits));
+  // While dithering, the next update picks up the new target
+  if (!m_dithering) {
+    HAL_CHECK(dither());
+  }
+  return write_t{};
+}
+
+status pwm_dac::dither()
+{
+  // First order sigma-delta: the fraction accumulates until it carries into
+  // an extra step, so the average step count equals the target exactly.
+  const auto target = m_target;
+  m_accumulator += target & fraction_mask;
+  const auto step =
+    (target >> fraction_bits) + (m_accumulator >> fraction_bits);
+  m_accumulator &= fraction_mask;
+
+  // The flag stays set until the timer is known not to be re-armed, so a
+  // write never starts a second dither sequence next to this one.
+  auto output = m_pwm->duty_cycle(static_cast<float>(step) * m_step_size);
+  if (!output || (target & fraction_mask) == 0) {
+    m_dithering = false;
+    HAL_CHECK(output);
+    return hal::success();
+  }
+
+  m_dithering = true;
+  auto scheduled = m_timer->schedule([this]() { (void)dither(); }, m_period);
+  if (!scheduled) {
+    m_dithering = false;
+    HAL_CHECK(scheduled);
+  }
+  return hal::success();
+}
+}  // namespace hal::soft
@@ -0,0 +1,147 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/quadrature_encoder.hpp>
+
+namespace hal::soft {
+namespace {
+/// Counts for each transition, indexed by (previous state << 2) | new state
+constexpr std::array<std::int8_t, 16> transition_table{
+  //  00  01  10  11   new state, A in bit 1 and B in bit 0
+  0,  -1, 1,  0,   // from 00
+  1,  0,  0,  -1,  // from 01
+  -1, 0,  0,  1,   // from 10
+  0,  1,  -1, 0,   // from 11
+};
+}  // namespace
+
+result<quadrature_encoder> quadrature_encoder::create(
+  std::uint32_t p_counts_per_revolution)
+{
+  if (p_counts_per_revolution == 0) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return quadrature_encoder(nullptr, nullptr, p_counts_per_revolution);
+}
+
+result<quadrature_encoder> quadrature_encoder::create(
+  hal::interrupt_pin& p_channel_a,
+  hal::interrupt_pin& p_channel_b,
+  std::uint32_t p_counts_per_revolution)
+{
+  if (p_counts_per_revolution == 0) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  const hal::interrupt_pin::settings settings{
+    .trigger = hal::interrupt_pin::trigger_edge::both,
+  };
+  HAL_CHECK(p_channel_a.configure(settings));
+  HAL_CHECK(p_channel_b.configure(settings));
+  return quadrature_encoder(
+    &p_channel_a, &p_channel_b, p_counts_per_revolution);
+}
+
+quadrature_encoder::quadrature_encoder(hal::interrupt_pin* p_channel_a,
+                                       hal::interrupt_pin* p_channel_b,
+                                       std::uint32_t p_counts_per_revolution)
+  : m_channel_a(p_channel_a)
+  , m_channel_b(p_channel_b)
+  , m_degrees_per_count(360.0 / p_counts_per_revolution)
+{
+  attach();
+}
+
+quadrature_encoder::quadrature_encoder(quadrature_encoder&& p_other) noexcept
+  : m_channel_a(p_other.m_channel_a)
+  , m_channel_b(p_other.m_channel_b)
+  , m_degrees_per_count(p_other.m_degrees_per_count)
+  , m_count(p_other.m_count)
+  , m_state(p_other.m_state)
+{
+  // The handlers now belong to this object, so the other must not detach
+  p_other.m_channel_a = nullptr;
+  p_other.m_channel_b = nullptr;
+  attach();
+}
+
+quadrature_encoder::~quadrature_encoder()
+{
+  detach();
+}
+
+void quadrature_encoder::attach()
+{
+  if (m_channel_a != nullptr) {
+    m_channel_a->on_trigger([this](bool p_level) {
+      decode(static_cast<std::uint8_t>((p_level << 1) | (m_state & 0b01)));
+    });
+  }
+  if (m_channel_b != nullptr) {
+    m_channel_b->on_trigger([this](bool p_level) {
+      decode(static_cast<std::uint8_t>((m_state & 0b10) | p_level));
+    });
+  }
+}
+
+void quadrature_encoder::detach()
+{
+  if (m_channel_a != nullptr) {
+    m_channel_a->on_trigger([]([[maybe_unused]] bool p_level) {});
+  }
+  if (m_channel_b != nullptr) {
+    m_channel_b->on_trigger([]([[maybe_unused]] bool p_level) {});
+  }
+}
+
+void quadrature_encoder::update(bool p_channel_a, bool p_channel_b)
+{
+  decode(static_cast<std::uint8_t>((p_channel_a << 1) | p_channel_b));
+}
+
+void quadrature_encoder::decode(std::uint8_t p_state)
+{
+  const auto updates = m_updates.load(std::memory_order_relaxed);
+  m_updates.store(updates + 1, std::memory_order_relaxed);
+  std::atomic_signal_fence(std::memory_order_release);
+  m_count += transition_table[(m_state << 2) | p_state];
+  m_state = p_state;
+  m_updates.store(updates + 2, std::memory_order_release);
+}
+
+std::int64_t quadrature_encoder::count() const
+{
+  while (true) {
+    const auto before = m_updates.load(std::memory_order_acquire);
+    const auto count = m_count;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    if ((before & 1) == 0 &&
+        before == m_updates.load(std::memory_order_relaxed)) {
+      return count;
+    }
+  }
+}
+
+void quadrature_encoder::reset(std::int64_t p_count)
+{
+  m_count = p_count;
+}
+
+result<quadrature_encoder::read_t> quadrature_encoder::driver_read()
+{
+  return read_t{
+    .angle = static_cast<float>(static_cast<double>(count()) *
+                                m_degrees_per_count),
+  };
+}
+}  // namespace hal::soft
@@ -0,0 +1,158 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/replay.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace hal::soft {
+namespace {
+constexpr std::array<hal::byte, 4> replay_magic{ 'H', 'R', 'P', 'L' };
+
+void put_u16(std::span<hal::byte> p_bytes,
+             std::size_t p_offset,
+             std::uint16_t p_value)
+{
+  p_bytes[p_offset] = static_cast<hal::byte>(p_value);
+  p_bytes[p_offset + 1] = static_cast<hal::byte>(p_value >> 8);
+}
+
+std::uint16_t get_u16(std::span<const hal::byte> p_bytes, std::size_t p_offset)
+{
+  return static_cast<std::uint16_t>(p_bytes[p_offset] |
+                                    (p_bytes[p_offset + 1] << 8));
+}
+}  // namespace
+
+result<trace_recorder> trace_recorder::create(std::span<hal::byte> p_buffer)
+{
+  if (p_buffer.size() < header_size) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return trace_recorder(p_buffer);
+}
+
+trace_recorder::trace_recorder(std::span<hal::byte> p_buffer)
+  : m_buffer(p_buffer)
+{
+  std::copy(replay_magic.begin(), replay_magic.end(), m_buffer.begin());
+  put_u16(m_buffer, 4, format_version);
+  put_u16(m_buffer, 6, 0);
+  m_size = header_size;
+}
+
+bool trace_recorder::append(std::uint16_t p_source,
+                            trace_call p_call,
+                            bool p_failed,
+                            std::span<const hal::byte> p_payload)
+{
+  const auto entry_size = entry_header_size + p_payload.size();
+  if (m_dropped != 0 ||
+      p_payload.size() > std::numeric_limits<std::uint16_t>::max() ||
+      entry_size > available()) {
+    m_dropped++;
+    return false;
+  }
+
+  auto entry = m_buffer.subspan(m_size, entry_size);
+  put_u16(entry, 0, p_source);
+  entry[2] = static_cast<hal::byte>(p_call);
+  entry[3] = static_cast<hal::byte>(p_failed);
+  put_u16(entry, 4, static_cast<std::uint16_t>(p_payload.size()));
+  std::copy(p_payload.begin(), p_payload.end(), entry.begin() + 6);
+  m_size += entry_size;
+  return true;
+}
+
+std::span<const hal::byte> trace_recorder::recorded() const
+{
+  return m_buffer.first(m_size);
+}
+
+std::size_t trace_recorder::available() const
+{
+  return m_buffer.size() - m_size;
+}
+
+status trace_recorder::flush(hal::serial& p_port)
+{
+  if (m_size != 0) {
+    HAL_CHECK(p_port.write(recorded()));
+    m_size = 0;
+  }
+  return hal::success();
+}
+
+std::uint32_t trace_recorder::dropped() const
+{
+  return m_dropped;
+}
+
+result<trace_player> trace_player::create(std::span<const hal::byte> p_trace)
+{
+  if (p_trace.size() < trace_recorder::header_size ||
+      !std::equal(replay_magic.begin(), replay_magic.end(), p_trace.begin())) {
+    return hal::new_error(std::errc::illegal_byte_sequence);
+  }
+  if (get_u16(p_trace, 4) != trace_recorder::format_version) {
+    return hal::new_error(std::errc::not_supported);
+  }
+  return trace_player(p_trace);
+}
+
+trace_player::trace_player(std::span<const hal::byte> p_trace)
+  : m_trace(p_trace)
+{
+}
+
+result<trace_entry> trace_player::next(std::uint16_t p_source,
+                                       trace_call p_call,
+                                       std::size_t& p_cursor) const
+{
+  auto offset = std::max(p_cursor, trace_recorder::header_size);
+
+  while (offset < m_trace.size()) {
+    if (m_trace.size() - offset < trace_recorder::entry_header_size) {
+      return hal::new_error(std::errc::illegal_byte_sequence);
+    }
+    const auto entry = m_trace.subspan(offset);
+    const auto length = get_u16(entry, 4);
+    if (entry.size() - trace_recorder::entry_header_size < length) {
+      return hal::new_error(std::errc::illegal_byte_sequence);
+    }
+    offset += trace_recorder::entry_header_size + length;
+
+    const auto source = get_u16(entry, 0);
+    if (source != p_source) {
+      continue;
+    }
+
+    p_cursor = offset;
+    const auto call = static_cast<trace_call>(entry[2]);
+    if (call != p_call) {
+      return hal::new_error(std::errc::invalid_argument);
+    }
+    return trace_entry{
+      .source = source,
+      .call = call,
+      .failed = entry[3] != 0,
+      .payload = entry.subspan(trace_recorder::entry_header_size, length),
+    };
+  }
+
+  p_cursor = offset;
+  return hal::new_error(std::errc::no_message);
+}
+}  // namespace hal::soft
@@ -0,0 +1,254 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/serial_mux.hpp>
+
+#include <algorithm>
+
+namespace hal::soft {
+// Implementations for serial_mux
+
+result<serial_mux> serial_mux::create(hal::serial& p_port,
+                                      std::span<hal::byte> p_transmit_buffer,
+                                      std::span<hal::byte> p_frame_buffer)
+{
+  auto decoder = HAL_CHECK(cobs_decoder::create(p_frame_buffer));
+  return serial_mux(p_port, p_transmit_buffer, decoder);
+}
+
+serial_mux::serial_mux(hal::serial& p_port,
+                       std::span<hal::byte> p_transmit_buffer,
+                       cobs_decoder p_decoder)
+  : m_port(&p_port)
+  , m_transmit_buffer(p_transmit_buffer)
+  , m_decoder(p_decoder)
+{
+}
+
+std::size_t serial_mux::dropped_frames() const
+{
+  return m_dropped + m_decoder.dropped_frames();
+}
+
+status serial_mux::write_batch()
+{
+  if (m_batch_length != 0) {
+    HAL_CHECK(m_port->write(m_transmit_buffer.first(m_batch_length)));
+    m_batch_length = 0;
+  }
+  return hal::success();
+}
+
+status serial_mux::transmit()
+{
+  for (std::size_t i = 0; i < max_channels; i++) {
+    auto& channel = m_channels[(m_next_channel + i) % max_channels];
+    // A length of 1 is just the channel number, so there is nothing to send
+    if (channel.transmit_length <= 1) {
+      continue;
+    }
+
+    auto payload = channel.transmit_buffer.first(channel.transmit_length);
+    auto space = m_transmit_buffer.size() - m_batch_length;
+    if (space < cobs_max_encoded_size(payload.size())) {
+      HAL_CHECK(write_batch());
+    }
+    auto unused = m_transmit_buffer.subspan(m_batch_length);
+    auto encoded = HAL_CHECK(cobs_encode(payload, unused));
+    m_batch_length += encoded.size();
+    channel.transmit_length = 1;
+  }
+
+  m_next_channel = (m_next_channel + 1) % max_channels;
+  return write_batch();
+}
+
+status serial_mux::receive()
+{
+  std::array<hal::byte, 32> chunk;
+
+  while (true) {
+    auto received = HAL_CHECK(m_port->read(chunk)).data;
+    std::span<const hal::byte> remaining = received;
+    while (!remaining.empty()) {
+      auto decoded = m_decoder.decode(remaining);
+      if (decoded.complete) {
+        deliver(decoded.frame);
+      }
+      remaining = decoded.remaining;
+    }
+    if (received.size() < chunk.size()) {
+      break;
+    }
+  }
+
+  return hal::success();
+}
+
+void serial_mux::deliver(std::span<const hal::byte> p_frame)
+{
+  if (p_frame.empty() || p_frame[0] >= max_channels ||
+      !m_channels[p_frame[0]].in_use) {
+    m_dropped++;
+    return;
+  }
+
+  auto& channel = m_channels[p_frame[0]];
+  auto& buffer = channel.receive_buffer;
+  auto payload = p_frame.subspan(1);
+  if (payload.size() > buffer.size() - channel.receive_stored) {
+    m_dropped++;
+    return;
+  }
+
+  // Copy in at most two runs: up to the end of the buffer, then from its start
+  auto remaining = payload;
+  while (!remaining.empty()) {
+    auto tail =
+      (channel.receive_head + channel.receive_stored) % buffer.size();
+    auto run = std::min(remaining.size(), buffer.size() - tail);
+    std::copy_n(remaining.begin(), run, buffer.begin() + tail);
+    channel.receive_stored += run;
+    remaining = remaining.subspan(run);
+  }
+}
+
+status serial_mux::stage(std::uint8_t p_channel,
+                         std::span<const hal::byte> p_data)
+{
+  auto& channel = m_channels[p_channel];
+  while (!p_data.empty()) {
+    auto space = channel.transmit_buffer.size() - channel.transmit_length;
+    if (space == 0) {
+      HAL_CHECK(transmit());
+      continue;
+    }
+    auto count = std::min(space, p_data.size());
+    std::copy_n(p_data.begin(),
+                count,
+                channel.transmit_buffer.begin() + channel.transmit_length);
+    channel.transmit_length += count;
+    p_data = p_data.subspan(count);
+  }
+  return hal::success();
+}
+
+std::span<hal::byte> serial_mux::unstage(std::uint8_t p_channel,
+                                         std::span<hal::byte> p_data)
+{
+  auto& channel = m_channels[p_channel];
+  auto& buffer = channel.receive_buffer;
+  auto count = std::min(p_data.size(), channel.receive_stored);
+
+  auto filled = p_data.first(count);
+  while (!filled.empty()) {
+    auto run = std::min(filled.size(), buffer.size() - channel.receive_head);
+    std::copy_n(buffer.begin() + channel.receive_head, run, filled.begin());
+    channel.receive_head = (channel.receive_head + run) % buffer.size();
+    channel.receive_stored -= run;
+    filled = filled.subspan(run);
+  }
+
+  return p_data.first(count);
+}
+
+// Implementations for serial_mux_channel
+
+serial_mux_channel::serial_mux_channel(serial_mux& p_mux,
+                                       std::uint8_t p_channel)
+  : m_mux(&p_mux)
+  , m_channel(p_channel)
+{
+}
+
+status serial_mux_channel::driver_configure(
+  [[maybe_unused]] const settings& p_settings)
+{
+  return hal::success();
+}
+
+result<serial::write_t> serial_mux_channel::driver_write(
+  std::span<const hal::byte> p_data)
+{
+  HAL_CHECK(m_mux->stage(m_channel, p_data));
+  return write_t{ .data = p_data };
+}
+
+result<serial::read_t> serial_mux_channel::driver_read(
+  std::span<hal::byte> p_data)
+{
+  HAL_CHECK(m_mux->receive());
+  auto& channel = m_mux->m_channels[m_channel];
+  return read_t{
+    .data = m_mux->unstage(m_channel, p_data),
+    .available = channel.receive_stored,
+    .capacity = channel.receive_buffer.size(),
+  };
+}
+
+result<serial::flush_t> serial_mux_channel::driver_flush()
+{
+  auto& channel = m_mux->m_channels[m_channel];
+  channel.receive_head = 0;
+  channel.receive_stored = 0;
+  return flush_t{};
+}
+
+result<serial_mux_channel> serial_mux_channel::create(
+  serial_mux& p_mux,
+  std::uint8_t p_channel,
+  std::span<hal::byte> p_receive_buffer,
+  std::span<hal::byte> p_transmit_buffer)
+{
+  if (p_channel >= serial_mux::max_channels) {
+    return hal::new_error(std::errc::result_out_of_range);
+  }
+
+  auto& channel = p_mux.m_channels[p_channel];
+  if (channel.in_use) {
+    return hal::new_error(std::errc::device_or_resource_busy);
+  }
+
+  if (p_transmit_buffer.size() < 2 ||
+      cobs_max_encoded_size(p_transmit_buffer.size()) >
+        p_mux.m_transmit_buffer.size()) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+
+  p_transmit_buffer[0] = p_channel;
+  channel = serial_mux::channel_state{
+    .receive_buffer = p_receive_buffer,
+    .transmit_buffer = p_transmit_buffer,
+    .transmit_length = 1,
+    .in_use = true,
+  };
+
+  return serial_mux_channel(p_mux, p_channel);
+}
+
+serial_mux_channel::serial_mux_channel(serial_mux_channel&& p_other) noexcept
+  : m_mux(p_other.m_mux)
+  , m_channel(p_other.m_channel)
+{
+  // The slot now belongs to this channel, so the other must not free it
+  p_other.m_mux = nullptr;
+}
+
+serial_mux_channel::~serial_mux_channel()
+{
+  if (m_mux != nullptr) {
+    m_mux->m_channels[m_channel] = serial_mux::channel_state{};
+  }
+}
+}  // namespace hal::soft
@@ -0,0 +1,240 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/simulated_can.hpp>
+
+#include <cmath>
+#include <ratio>
+
+#include <libhal-soft/can_arbitration.hpp>
+
+namespace hal::soft {
+namespace {
+constexpr hal::can::id_t max_standard_id = 0x7FF;
+
+/**
+ * @brief Length of a frame on the wire in bits, without stuff bits
+ *
+ * SOF, arbitration and control fields, data, CRC and its delimiter, ACK, EOF
+ * and the interframe space.
+ */
+std::uint64_t frame_bits(const hal::can::message_t& p_message)
+{
+  constexpr std::uint64_t standard_overhead = 47;
+  constexpr std::uint64_t extended_overhead = 67;
+
+  const auto overhead =
+    (p_message.id > max_standard_id) ? extended_overhead : standard_overhead;
+  if (p_message.is_remote_request) {
+    return overhead;
+  }
+  return overhead + 8U * p_message.length;
+}
+}  // namespace
+
+result<simulated_can_bus> simulated_can_bus::create(hal::hertz p_bitrate)
+{
+  if (p_bitrate < 0.0f) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return simulated_can_bus(p_bitrate);
+}
+
+simulated_can_bus::simulated_can_bus(hal::hertz p_bitrate)
+  : m_bitrate(static_cast<std::uint32_t>(std::lround(p_bitrate)))
+{
+}
+
+bool simulated_can_bus::step()
+{
+  auto* sender = arbitrate();
+  if (sender == nullptr) {
+    return false;
+  }
+
+  // Remove the frame before delivering it, so handlers can queue replies
+  const auto message = sender->pop(sender->next_mailbox());
+  if (m_bitrate != 0) {
+    m_bit_time += frame_bits(message);
+  }
+  m_frames++;
+
+  for (std::size_t i = 0; i < m_node_count; i++) {
+    if (m_nodes[i] != sender) {
+      m_nodes[i]->m_handler(message);
+    }
+  }
+  return true;
+}
+
+std::size_t simulated_can_bus::run()
+{
+  std::size_t transmitted = 0;
+  while (step()) {
+    transmitted++;
+  }
+  return transmitted;
+}
+
+std::size_t simulated_can_bus::run_for(hal::time_duration p_duration)
+{
+  if (m_bitrate == 0) {
+    return run();
+  }
+
+  const auto end = m_bit_time + to_bits(p_duration);
+  std::size_t transmitted = 0;
+  while (auto* sender = arbitrate()) {
+    const auto& next = sender->m_mailboxes[sender->next_mailbox()];
+    if (m_bit_time + frame_bits(next) > end) {
+      break;
+    }
+    step();
+    transmitted++;
+  }
+
+  m_bit_time = end;
+  return transmitted;
+}
+
+hal::time_duration simulated_can_bus::now() const
+{
+  if (m_bitrate == 0) {
+    return hal::time_duration::zero();
+  }
+
+  // Split into whole seconds and a remainder so the product cannot overflow
+  constexpr std::uint64_t ns_per_second = std::nano::den;
+  const auto seconds = m_bit_time / m_bitrate;
+  const auto remainder = m_bit_time % m_bitrate;
+  const auto nanoseconds =
+    seconds * ns_per_second + remainder * ns_per_second / m_bitrate;
+  return hal::time_duration(static_cast<std::int64_t>(nanoseconds));
+}
+
+std::size_t simulated_can_bus::frames_transmitted() const
+{
+  return m_frames;
+}
+
+status simulated_can_bus::join(simulated_can_node& p_node)
+{
+  if (m_node_count == max_nodes) {
+    return hal::new_error(std::errc::no_buffer_space);
+  }
+  m_nodes[m_node_count++] = &p_node;
+  return hal::success();
+}
+
+simulated_can_node* simulated_can_bus::arbitrate()
+{
+  simulated_can_node* winner = nullptr;
+  std::uint32_t winning_key = 0;
+
+  for (std::size_t i = 0; i < m_node_count; i++) {
+    auto* node = m_nodes[i];
+    if (node->m_pending == 0) {
+      continue;
+    }
+    const auto& next = node->m_mailboxes[node->next_mailbox()];
+    const auto key = can_arbitration_key(next);
+    if (winner == nullptr || key < winning_key) {
+      winner = node;
+      winning_key = key;
+    }
+  }
+  return winner;
+}
+
+std::uint64_t simulated_can_bus::to_bits(hal::time_duration p_duration) const
+{
+  constexpr std::uint64_t ns_per_second = std::nano::den;
+  const auto nanoseconds = static_cast<std::uint64_t>(p_duration.count());
+  const auto seconds = nanoseconds / ns_per_second;
+  const auto remainder = nanoseconds % ns_per_second;
+  return seconds * m_bitrate + remainder * m_bitrate / ns_per_second;
+}
+
+result<simulated_can_node> simulated_can_node::create(
+  simulated_can_bus& p_bus)
+{
+  return simulated_can_node(p_bus);
+}
+
+simulated_can_node::simulated_can_node(simulated_can_bus& p_bus)
+  : m_bus(&p_bus)
+{
+}
+
+std::size_t simulated_can_node::pending() const
+{
+  return m_pending;
+}
+
+status simulated_can_node::driver_configure(
+  [[maybe_unused]] const settings& p_settings)
+{
+  return driver_bus_on();
+}
+
+status simulated_can_node::driver_bus_on()
+{
+  if (!m_joined) {
+    HAL_CHECK(m_bus->join(*this));
+    m_joined = true;
+  }
+  return hal::success();
+}
+
+result<simulated_can_node::send_t> simulated_can_node::driver_send(
+  const message_t& p_message)
+{
+  if (!m_joined) {
+    return hal::new_error(std::errc::network_down);
+  }
+  if (m_pending == mailbox_count) {
+    return hal::new_error(std::errc::device_or_resource_busy);
+  }
+  m_mailboxes[m_pending++] = p_message;
+  return send_t{};
+}
+
+void simulated_can_node::driver_on_receive(hal::callback<handler> p_handler)
+{
+  m_handler = p_handler;
+}
+
+std::size_t simulated_can_node::next_mailbox() const
+{
+  std::size_t next = 0;
+  for (std::size_t i = 1; i < m_pending; i++) {
+    if (can_arbitration_key(m_mailboxes[i]) <
+        can_arbitration_key(m_mailboxes[next])) {
+      next = i;
+    }
+  }
+  return next;
+}
+
+hal::can::message_t simulated_can_node::pop(std::size_t p_mailbox)
+{
+  const auto message = m_mailboxes[p_mailbox];
+  // Shift the rest down to keep frames with equal IDs in send order
+  for (std::size_t i = p_mailbox + 1; i < m_pending; i++) {
+    m_mailboxes[i - 1] = m_mailboxes[i];
+  }
+  m_pending--;
+  return message;
+}
+}  // namespace hal::soft
@@ -0,0 +1,212 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/simulated_time.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <ratio>
+
+namespace hal::soft {
+result<simulated_time> simulated_time::create(hal::hertz p_frequency,
+                                              hal::time_duration p_poll_step)
+{
+  if (!(p_frequency > 0.0f)) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return simulated_time(p_frequency, p_poll_step);
+}
+
+simulated_time::simulated_time(hal::hertz p_frequency,
+                               hal::time_duration p_poll_step)
+  : m_frequency(p_frequency)
+  , m_ticks_per_ns(static_cast<double>(p_frequency) / std::nano::den)
+  , m_ns_per_tick(std::nano::den / static_cast<double>(p_frequency))
+  , m_poll_ticks(std::max<std::uint64_t>(to_ticks(p_poll_step), 1))
+{
+}
+
+void simulated_time::advance(hal::time_duration p_duration)
+{
+  advance_to(m_ticks + to_ticks(p_duration));
+}
+
+bool simulated_time::run_next()
+{
+  auto* timer = earliest();
+  if (timer == nullptr) {
+    return false;
+  }
+  advance_to(std::max(m_ticks, timer->m_deadline));
+  return true;
+}
+
+hal::time_duration simulated_time::now() const
+{
+  return hal::time_duration(
+    static_cast<std::int64_t>(std::llround(m_ticks * m_ns_per_tick)));
+}
+
+std::size_t simulated_time::pending() const
+{
+  return m_timer_count;
+}
+
+std::uint64_t simulated_time::to_ticks(hal::time_duration p_duration) const
+{
+  if (p_duration <= hal::time_duration::zero()) {
+    return 0;
+  }
+  return static_cast<std::uint64_t>(
+    std::ceil(static_cast<double>(p_duration.count()) * m_ticks_per_ns));
+}
+
+void simulated_time::advance_to(std::uint64_t p_ticks)
+{
+  // Callbacks may read a clock, which advances time again. Time never moves
+  // backwards, even if such a nested advance overshoots p_ticks.
+  while (auto* timer = earliest()) {
+    if (timer->m_deadline > p_ticks) {
+      break;
+    }
+    m_ticks = std::max(m_ticks, timer->m_deadline);
+    detach(*timer);
+    timer->m_callback();
+  }
+  m_ticks = std::max(m_ticks, p_ticks);
+}
+
+simulated_timer* simulated_time::earliest() const
+{
+  simulated_timer* earliest = nullptr;
+  for (std::size_t i = 0; i < m_timer_count; i++) {
+    auto* timer = m_timers[i];
+    if (earliest == nullptr || timer->m_deadline < earliest->m_deadline ||
+        (timer->m_deadline == earliest->m_deadline &&
+         timer->m_sequence < earliest->m_sequence)) {
+      earliest = timer;
+    }
+  }
+  return earliest;
+}
+
+status simulated_time::attach(simulated_timer& p_timer)
+{
+  if (m_timer_count == max_timers) {
+    return hal::new_error(std::errc::no_buffer_space);
+  }
+  m_timers[m_timer_count++] = &p_timer;
+  p_timer.m_sequence = m_sequence++;
+  p_timer.m_scheduled = true;
+  return hal::success();
+}
+
+void simulated_time::detach(simulated_timer& p_timer)
+{
+  auto end = m_timers.begin() + m_timer_count;
+  auto position = std::find(m_timers.begin(), end, &p_timer);
+  if (position != end) {
+    *position = *(end - 1);
+    m_timer_count--;
+  }
+  p_timer.m_scheduled = false;
+}
+
+void simulated_time::replace(simulated_timer& p_old, simulated_timer& p_new)
+{
+  auto end = m_timers.begin() + m_timer_count;
+  auto position = std::find(m_timers.begin(), end, &p_old);
+  if (position != end) {
+    *position = &p_new;
+  }
+  p_old.m_scheduled = false;
+}
+
+result<simulated_steady_clock> simulated_steady_clock::create(
+  simulated_time& p_time)
+{
+  return simulated_steady_clock(p_time);
+}
+
+simulated_steady_clock::simulated_steady_clock(simulated_time& p_time)
+  : m_time(&p_time)
+{
+}
+
+simulated_steady_clock::frequency_t simulated_steady_clock::driver_frequency()
+{
+  return frequency_t{ .operating_frequency = m_time->m_frequency };
+}
+
+simulated_steady_clock::uptime_t simulated_steady_clock::driver_uptime()
+{
+  m_time->advance_to(m_time->m_ticks + m_time->m_poll_ticks);
+  return uptime_t{ .ticks = m_time->m_ticks };
+}
+
+result<simulated_timer> simulated_timer::create(simulated_time& p_time)
+{
+  return simulated_timer(p_time);
+}
+
+simulated_timer::simulated_timer(simulated_time& p_time)
+  : m_time(&p_time)
+{
+}
+
+simulated_timer::simulated_timer(simulated_timer&& p_other) noexcept
+  : m_time(p_other.m_time)
+  , m_callback(std::move(p_other.m_callback))
+  , m_deadline(p_other.m_deadline)
+  , m_sequence(p_other.m_sequence)
+  , m_scheduled(p_other.m_scheduled)
+{
+  if (m_scheduled) {
+    m_time->replace(p_other, *this);
+  }
+}
+
+simulated_timer::~simulated_timer()
+{
+  if (m_scheduled) {
+    m_time->detach(*this);
+  }
+}
+
+result<simulated_timer::is_running_t> simulated_timer::driver_is_running()
+{
+  return is_running_t{ .is_running = m_scheduled };
+}
+
+result<simulated_timer::cancel_t> simulated_timer::driver_cancel()
+{
+  if (m_scheduled) {
+    m_time->detach(*this);
+  }
+  return cancel_t{};
+}
+
+result<simulated_timer::schedule_t> simulated_timer::driver_schedule(
+  hal::callback<void(void)> p_callback,
+  hal::time_duration p_delay)
+{
+  if (m_scheduled) {
+    m_time->detach(*this);
+  }
+  HAL_CHECK(m_time->attach(*this));
+  m_callback = p_callback;
+  m_deadline = m_time->m_ticks + m_time->to_ticks(p_delay);
+  return schedule_t{};
+}
+}  // namespace hal::soft
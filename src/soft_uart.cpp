@@ -0,0 +1,305 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/soft_uart.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+namespace hal::soft {
+namespace {
+constexpr std::uint8_t data_bits = 8;
+}  // namespace
+
+result<soft_uart> soft_uart::create(hal::output_pin& p_transmit_pin,
+                                    hal::interrupt_pin& p_receive_edge,
+                                    hal::input_pin& p_receive_pin,
+                                    hal::timer& p_transmit_timer,
+                                    hal::timer& p_receive_timer,
+                                    std::span<hal::byte> p_transmit_buffer,
+                                    std::span<hal::byte> p_receive_buffer)
+{
+  return soft_uart(p_transmit_pin,
+                   p_receive_edge,
+                   p_receive_pin,
+                   p_transmit_timer,
+                   p_receive_timer,
+                   p_transmit_buffer,
+                   p_receive_buffer);
+}
+
+soft_uart::soft_uart(hal::output_pin& p_transmit_pin,
+                     hal::interrupt_pin& p_receive_edge,
+                     hal::input_pin& p_receive_pin,
+                     hal::timer& p_transmit_timer,
+                     hal::timer& p_receive_timer,
+                     std::span<hal::byte> p_transmit_buffer,
+                     std::span<hal::byte> p_receive_buffer)
+  : m_transmit_pin(&p_transmit_pin)
+  , m_receive_edge(&p_receive_edge)
+  , m_receive_pin(&p_receive_pin)
+  , m_transmit_timer(&p_transmit_timer)
+  , m_receive_timer(&p_receive_timer)
+  , m_transmit_buffer(p_transmit_buffer)
+  , m_receive_buffer(p_receive_buffer)
+{
+}
+
+soft_uart::soft_uart(soft_uart&& p_other) noexcept
+  : m_transmit_pin(p_other.m_transmit_pin)
+  , m_receive_edge(p_other.m_receive_edge)
+  , m_receive_pin(p_other.m_receive_pin)
+  , m_transmit_timer(p_other.m_transmit_timer)
+  , m_receive_timer(p_other.m_receive_timer)
+  , m_transmit_buffer(p_other.m_transmit_buffer)
+  , m_receive_buffer(p_other.m_receive_buffer)
+  , m_bit_period(p_other.m_bit_period)
+  , m_half_bit_period(p_other.m_half_bit_period)
+  , m_stop_pattern(p_other.m_stop_pattern)
+  , m_frame_bits(p_other.m_frame_bits)
+  , m_parity_data_mask(p_other.m_parity_data_mask)
+  , m_parity_invert(p_other.m_parity_invert)
+  , m_has_parity(p_other.m_has_parity)
+  , m_transmit_head(p_other.m_transmit_head)
+  , m_transmit_tail(p_other.m_transmit_tail)
+  , m_receive_head(p_other.m_receive_head)
+  , m_receive_tail(p_other.m_receive_tail)
+  , m_receive_errors(p_other.m_receive_errors)
+  , m_transmitting(p_other.m_transmitting.load())
+  , m_receiving(p_other.m_receiving)
+  , m_transmit_frame(p_other.m_transmit_frame)
+  , m_receive_frame(p_other.m_receive_frame)
+  , m_transmit_bits_left(p_other.m_transmit_bits_left)
+  , m_receive_bit(p_other.m_receive_bit)
+{
+  // The pins and timers now belong to this object, so the other must not
+  // release them
+  p_other.m_receive_edge = nullptr;
+  p_other.m_transmit_timer = nullptr;
+  p_other.m_receive_timer = nullptr;
+}
+
+soft_uart::~soft_uart()
+{
+  if (m_transmit_timer != nullptr) {
+    (void)m_transmit_timer->cancel();
+  }
+  if (m_receive_timer != nullptr) {
+    (void)m_receive_timer->cancel();
+  }
+  if (m_receive_edge != nullptr) {
+    m_receive_edge->on_trigger([]([[maybe_unused]] bool p_state) {});
+  }
+}
+
+std::size_t soft_uart::receive_errors() const
+{
+  return m_receive_errors;
+}
+
+status soft_uart::driver_configure(const settings& p_settings)
+{
+  using parity = decltype(p_settings.parity);
+
+  if (p_settings.baud_rate < 1.0f) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+
+  // Stop any transfer in flight so the timings can change underneath it
+  HAL_CHECK(m_transmit_timer->cancel());
+  HAL_CHECK(m_receive_timer->cancel());
+  m_transmitting = false;
+  m_receiving = false;
+
+  const auto bit_period_ns = std::nano::den / p_settings.baud_rate;
+  m_bit_period = hal::time_duration(static_cast<std::int64_t>(bit_period_ns));
+  m_half_bit_period = m_bit_period / 2;
+
+  m_has_parity = p_settings.parity != parity::none;
+  m_parity_data_mask =
+    (p_settings.parity == parity::odd || p_settings.parity == parity::even);
+  m_parity_invert =
+    (p_settings.parity == parity::odd || p_settings.parity == parity::forced1);
+
+  // Frame layout, least significant bit first:
+  //   start bit (0), data bits, optional parity bit, stop bits (1)
+  const std::uint8_t stop_bits =
+    (p_settings.stop == settings::stop_bits::two) ? 2 : 1;
+  const std::uint8_t stop_position = 1 + data_bits + (m_has_parity ? 1 : 0);
+  m_frame_bits = stop_position + stop_bits;
+  m_stop_pattern = ((1U << stop_bits) - 1U) << stop_position;
+
+  HAL_CHECK(m_transmit_pin->level(true));
+  HAL_CHECK(m_receive_edge->configure(hal::interrupt_pin::settings{
+    .resistor = hal::pin_resistor::pull_up,
+    .trigger = hal::interrupt_pin::trigger_edge::falling,
+  }));
+  m_receive_edge->on_trigger(
+    [this]([[maybe_unused]] bool p_state) { start_receive(); });
+
+  return hal::success();
+}
+
+std::uint16_t soft_uart::make_frame(hal::byte p_byte) const
+{
+  std::uint16_t frame = m_stop_pattern | (p_byte << 1);
+  if (m_has_parity) {
+    const auto data_parity = std::popcount(p_byte) & 1;
+    const auto parity_bit =
+      (data_parity & m_parity_data_mask) ^ m_parity_invert;
+    frame |= parity_bit << (1 + data_bits);
+  }
+  return frame;
+}
+
+result<serial::write_t> soft_uart::driver_write(
+  std::span<const hal::byte> p_data)
+{
+  const auto capacity = m_transmit_buffer.size();
+  const auto space = capacity - (m_transmit_tail - m_transmit_head);
+  const auto accepted = p_data.first(std::min(space, p_data.size()));
+
+  std::size_t tail = m_transmit_tail;
+  for (auto value : accepted) {
+    m_transmit_buffer[tail % capacity] = value;
+    tail++;
+  }
+  m_transmit_tail = tail;
+
+  if (!accepted.empty() && claim_transmitter()) {
+    m_transmit_bits_left = 0;
+    transmit_bit();
+  }
+
+  return write_t{ .data = accepted };
+}
+
+bool soft_uart::claim_transmitter()
+{
+  bool idle = false;
+  return m_transmitting.compare_exchange_strong(idle, true);
+}
+
+void soft_uart::transmit_bit()
+{
+  if (m_transmit_bits_left == 0) {
+    // The previous frame, including its stop bits, has been on the line for
+    // its full duration.
+    if (m_transmit_head == m_transmit_tail) {
+      m_transmitting = false;
+      // A write may have queued bytes after the check above while the
+      // transmitter still looked busy to it, so check again once released.
+      if (m_transmit_head == m_transmit_tail || !claim_transmitter()) {
+        return;
+      }
+    }
+    const auto next =
+      m_transmit_buffer[m_transmit_head % m_transmit_buffer.size()];
+    m_transmit_head = m_transmit_head + 1;
+    m_transmit_frame = make_frame(next);
+    m_transmit_bits_left = m_frame_bits;
+  }
+
+  (void)m_transmit_pin->level(m_transmit_frame & 1U);
+  m_transmit_frame >>= 1;
+  m_transmit_bits_left--;
+  (void)m_transmit_timer->schedule([this]() { transmit_bit(); },
+                                   m_bit_period);
+}
+
+void soft_uart::start_receive()
+{
+  if (m_receiving) {
+    return;
+  }
+  m_receiving = true;
+  m_receive_frame = 0;
+  m_receive_bit = 0;
+  // Sample the start bit in its middle to reject glitches
+  (void)m_receive_timer->schedule([this]() { receive_bit(); },
+                                  m_half_bit_period);
+}
+
+void soft_uart::receive_bit()
+{
+  auto level = m_receive_pin->level();
+  if (!level) {
+    m_receive_errors = m_receive_errors + 1;
+    m_receiving = false;
+    return;
+  }
+
+  if (m_receive_bit == 0 && level.value().state) {
+    // Line is back to idle, so that edge was noise rather than a start bit
+    m_receiving = false;
+    return;
+  }
+
+  m_receive_frame |= static_cast<std::uint16_t>(level.value().state)
+                     << m_receive_bit;
+  m_receive_bit++;
+
+  if (m_receive_bit < m_frame_bits) {
+    (void)m_receive_timer->schedule([this]() { receive_bit(); },
+                                    m_bit_period);
+    return;
+  }
+
+  m_receiving = false;
+
+  const auto received = static_cast<hal::byte>(m_receive_frame >> 1);
+  const bool framing_valid =
+    (m_receive_frame & m_stop_pattern) == m_stop_pattern;
+  const auto parity_mismatch =
+    (m_receive_frame ^ make_frame(received)) >> (1 + data_bits);
+  const bool parity_valid = !m_has_parity || (parity_mismatch & 1U) == 0;
+  const auto stored = m_receive_tail - m_receive_head;
+
+  if (!framing_valid || !parity_valid ||
+      stored >= m_receive_buffer.size()) {
+    m_receive_errors = m_receive_errors + 1;
+    return;
+  }
+
+  m_receive_buffer[m_receive_tail % m_receive_buffer.size()] = received;
+  m_receive_tail = m_receive_tail + 1;
+}
+
+result<serial::read_t> soft_uart::driver_read(std::span<hal::byte> p_data)
+{
+  const auto capacity = m_receive_buffer.size();
+  std::size_t head = m_receive_head;
+  const std::size_t tail = m_receive_tail;
+  const auto count = std::min(p_data.size(), tail - head);
+
+  for (std::size_t i = 0; i < count; i++) {
+    p_data[i] = m_receive_buffer[head % capacity];
+    head++;
+  }
+  m_receive_head = head;
+
+  return read_t{
+    .data = p_data.first(count),
+    .available = tail - head,
+    .capacity = capacity,
+  };
+}
+
+result<serial::flush_t> soft_uart::driver_flush()
+{
+  m_receive_head = m_receive_tail;
+  return flush_t{};
+}
+}  // namespace hal::soft
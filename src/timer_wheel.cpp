@@ -0,0 +1,309 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/timer_wheel.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <ratio>
+
+namespace hal::soft {
+namespace {
+constexpr std::size_t bits_per_level = 6;
+constexpr std::uint64_t slot_mask = timer_wheel::slots_per_level - 1;
+constexpr std::uint64_t max_steps = std::uint64_t{ 1 }
+                                    << (bits_per_level * timer_wheel::levels);
+
+static_assert(timer_wheel::slots_per_level == 1U << bits_per_level);
+}  // namespace
+
+result<timer_wheel> timer_wheel::create(hal::timer& p_timer,
+                                        hal::steady_clock& p_clock,
+                                        hal::time_duration p_resolution)
+{
+  const auto frequency = p_clock.frequency().operating_frequency;
+  const auto clock_ticks_per_step = static_cast<std::uint64_t>(
+    static_cast<double>(p_resolution.count()) * frequency / std::nano::den);
+
+  if (clock_ticks_per_step == 0) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+
+  return timer_wheel(p_timer, p_clock, clock_ticks_per_step, frequency);
+}
+
+timer_wheel::timer_wheel(hal::timer& p_timer,
+                         hal::steady_clock& p_clock,
+                         std::uint64_t p_clock_ticks_per_step,
+                         float p_clock_frequency)
+  : m_timer(&p_timer)
+  , m_clock(&p_clock)
+  , m_origin(p_clock.uptime().ticks)
+  , m_clock_ticks_per_step(p_clock_ticks_per_step)
+  , m_clock_ticks_per_ns(static_cast<double>(p_clock_frequency) /
+                         std::nano::den)
+  , m_ns_per_clock_tick(std::nano::den / static_cast<double>(p_clock_frequency))
+{
+}
+
+hal::time_duration timer_wheel::max_delay() const
+{
+  const auto clock_ticks = (max_steps - 1) * m_clock_ticks_per_step;
+  return hal::time_duration(
+    static_cast<std::int64_t>(clock_ticks * m_ns_per_clock_tick));
+}
+
+std::uint64_t timer_wheel::elapsed_clock_ticks()
+{
+  return m_clock->uptime().ticks - m_origin;
+}
+
+std::uint64_t timer_wheel::next_event() const
+{
+  auto next = never;
+  for (std::size_t level = 0; level < levels; level++) {
+    if (m_occupied[level] == 0) {
+      continue;
+    }
+    // The next occupied slot after the current one, wrapping around, is the
+    // next time this level needs attention: an expiry on level 0, a cascade
+    // on the others.
+    const auto shift = bits_per_level * level;
+    const auto current = m_now >> shift;
+    const auto rotated =
+      std::rotr(m_occupied[level], static_cast<int>((current + 1) & slot_mask));
+    const auto distance = std::countr_zero(rotated) + 1U;
+    next = std::min(next, (current + distance) << shift);
+  }
+  return next;
+}
+
+void timer_wheel::link(wheel_timer& p_timer)
+{
+  const auto delta = p_timer.m_deadline - m_now;
+  std::size_t level = 0;
+  while ((delta >> (bits_per_level * (level + 1))) != 0) {
+    level++;
+  }
+  const auto slot =
+    (p_timer.m_deadline >> (bits_per_level * level)) & slot_mask;
+
+  auto& head = m_slots[level][slot];
+  p_timer.m_previous = nullptr;
+  p_timer.m_next = head;
+  if (head != nullptr) {
+    head->m_previous = &p_timer;
+  }
+  head = &p_timer;
+  p_timer.m_level = static_cast<std::uint8_t>(level);
+  p_timer.m_slot = static_cast<std::uint8_t>(slot);
+  p_timer.m_scheduled = true;
+  m_occupied[level] |= std::uint64_t{ 1 } << slot;
+}
+
+void timer_wheel::unlink(wheel_timer& p_timer)
+{
+  auto& head = m_slots[p_timer.m_level][p_timer.m_slot];
+  if (p_timer.m_previous != nullptr) {
+    p_timer.m_previous->m_next = p_timer.m_next;
+  } else {
+    head = p_timer.m_next;
+  }
+  if (p_timer.m_next != nullptr) {
+    p_timer.m_next->m_previous = p_timer.m_previous;
+  }
+  if (head == nullptr) {
+    m_occupied[p_timer.m_level] &= ~(std::uint64_t{ 1 } << p_timer.m_slot);
+  }
+  p_timer.m_previous = nullptr;
+  p_timer.m_next = nullptr;
+  p_timer.m_scheduled = false;
+}
+
+void timer_wheel::replace(wheel_timer& p_old, wheel_timer& p_new)
+{
+  if (p_new.m_previous != nullptr) {
+    p_new.m_previous->m_next = &p_new;
+  } else {
+    m_slots[p_new.m_level][p_new.m_slot] = &p_new;
+  }
+  if (p_new.m_next != nullptr) {
+    p_new.m_next->m_previous = &p_new;
+  }
+  p_old.m_previous = nullptr;
+  p_old.m_next = nullptr;
+  p_old.m_scheduled = false;
+}
+
+wheel_timer* timer_wheel::detach(std::size_t p_level, std::size_t p_slot)
+{
+  auto* list = m_slots[p_level][p_slot];
+  m_slots[p_level][p_slot] = nullptr;
+  m_occupied[p_level] &= ~(std::uint64_t{ 1 } << p_slot);
+  return list;
+}
+
+void timer_wheel::advance(std::uint64_t p_target)
+{
+  while (true) {
+    const auto now = next_event();
+    if (now > p_target) {
+      // Every expiry and cascade up to the target has been handled, so the
+      // wheel can catch up to it. Otherwise an idle wheel falls behind and
+      // rejects short delays as out of range.
+      m_now = std::max(m_now, p_target);
+      return;
+    }
+    m_now = now;
+
+    // Cascade coarse slots that start now down to finer levels. Every timer
+    // in such a slot is due within the slot, so none lands back in it.
+    for (std::size_t level = levels - 1; level > 0; level--) {
+      const auto shift = bits_per_level * level;
+      if ((now & ((std::uint64_t{ 1 } << shift) - 1)) != 0) {
+        continue;
+      }
+      auto* timer = detach(level, (now >> shift) & slot_mask);
+      while (timer != nullptr) {
+        auto* next = timer->m_next;
+        link(*timer);
+        timer = next;
+      }
+    }
+
+    // Expire timers one at a time, so callbacks can freely schedule and
+    // cancel other timers, including ones in this slot.
+    auto& expired = m_slots[0][now & slot_mask];
+    while (expired != nullptr) {
+      auto& timer = *expired;
+      unlink(timer);
+      timer.m_callback();
+    }
+  }
+}
+
+void timer_wheel::arm()
+{
+  const auto next = next_event();
+  if (next == never || next == m_armed) {
+    return;
+  }
+
+  const auto deadline = next * m_clock_ticks_per_step;
+  const auto elapsed = elapsed_clock_ticks();
+  const auto clock_ticks = (deadline > elapsed) ? deadline - elapsed : 0;
+  const auto delay = hal::time_duration(
+    static_cast<std::int64_t>(std::ceil(clock_ticks * m_ns_per_clock_tick)));
+
+  m_armed = next;
+  (void)m_timer->schedule([this]() { service(); }, delay);
+}
+
+void timer_wheel::service()
+{
+  m_armed = never;
+  advance(elapsed_clock_ticks() / m_clock_ticks_per_step);
+  arm();
+}
+
+result<wheel_timer> wheel_timer::create(timer_wheel& p_wheel)
+{
+  return wheel_timer(p_wheel);
+}
+
+wheel_timer::wheel_timer(timer_wheel& p_wheel)
+  : m_wheel(&p_wheel)
+{
+}
+
+wheel_timer::wheel_timer(wheel_timer&& p_other) noexcept
+  : m_wheel(p_other.m_wheel)
+  , m_callback(std::move(p_other.m_callback))
+  , m_deadline(p_other.m_deadline)
+  , m_previous(p_other.m_previous)
+  , m_next(p_other.m_next)
+  , m_level(p_other.m_level)
+  , m_slot(p_other.m_slot)
+  , m_scheduled(p_other.m_scheduled)
+{
+  if (m_scheduled) {
+    m_wheel->replace(p_other, *this);
+  }
+}
+
+wheel_timer::~wheel_timer()
+{
+  if (m_scheduled) {
+    m_wheel->unlink(*this);
+  }
+}
+
+result<wheel_timer::is_running_t> wheel_timer::driver_is_running()
+{
+  return is_running_t{ .is_running = m_scheduled };
+}
+
+result<wheel_timer::cancel_t> wheel_timer::driver_cancel()
+{
+  // The hardware timer stays armed; waking up to an empty slot is harmless
+  // and cheaper than re-arming on every cancel.
+  if (m_scheduled) {
+    m_wheel->unlink(*this);
+  }
+  return cancel_t{};
+}
+
+result<wheel_timer::schedule_t> wheel_timer::driver_schedule(
+  hal::callback<void(void)> p_callback,
+  hal::time_duration p_delay)
+{
+  auto& wheel = *m_wheel;
+  const auto delay = std::max(p_delay, hal::time_duration::zero());
+  const auto delay_clock_ticks = static_cast<std::uint64_t>(
+    std::ceil(static_cast<double>(delay.count()) * wheel.m_clock_ticks_per_ns));
+  const auto step = wheel.m_clock_ticks_per_step;
+
+  const auto elapsed = wheel.elapsed_clock_ticks();
+
+  // Catch up on time spent idle, unless timers are due, which are left for
+  // the hardware timer callback to expire
+  if (wheel.next_event() > elapsed / step) {
+    wheel.m_now = std::max(wheel.m_now, elapsed / step);
+  }
+
+  // Round up, so the timer never fires early
+  auto deadline = (elapsed + delay_clock_ticks + step - 1) / step;
+  deadline = std::max(deadline, wheel.m_now + 1);
+
+  if (deadline - wheel.m_now >= max_steps) {
+    return hal::new_error(out_of_bounds_error{
+      .invalid = p_delay,
+      .maximum = wheel.max_delay(),
+    });
+  }
+
+  if (m_scheduled) {
+    wheel.unlink(*this);
+  }
+  m_callback = p_callback;
+  m_deadline = deadline;
+  wheel.link(*this);
+
+  if (wheel.next_event() < wheel.m_armed) {
+    wheel.arm();
+  }
+  return schedule_t{};
+}
+}  // namespace hal::soft
@@ -0,0 +1,208 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/trace_ring.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace hal::soft {
+namespace {
+constexpr std::array<hal::byte, 4> dump_magic{ 'H', 'T', 'R', 'C' };
+/// Records encoded per write to the serial port
+constexpr std::size_t records_per_write = 8;
+
+template<class T>
+void put(std::span<hal::byte> p_bytes, std::size_t p_offset, T p_value)
+{
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    p_bytes[p_offset + i] = static_cast<hal::byte>(p_value >> (8 * i));
+  }
+}
+
+template<class T>
+T get(std::span<const hal::byte> p_bytes, std::size_t p_offset)
+{
+  T value = 0;
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    value |= static_cast<T>(static_cast<T>(p_bytes[p_offset + i]) << (8 * i));
+  }
+  return value;
+}
+
+void encode(const trace_record& p_record, std::span<hal::byte> p_bytes)
+{
+  put<std::uint64_t>(p_bytes, 0, p_record.start);
+  put<std::uint32_t>(p_bytes, 8, p_record.duration);
+  put<std::uint32_t>(p_bytes, 12, p_record.sequence);
+  put<std::uint32_t>(p_bytes, 16, p_record.argument);
+  put<std::uint16_t>(p_bytes, 20, p_record.source);
+  put<std::uint8_t>(p_bytes, 22, static_cast<std::uint8_t>(p_record.call));
+  put<std::uint8_t>(p_bytes, 23, p_record.status);
+}
+}  // namespace
+
+result<trace_ring> trace_ring::create(std::span<trace_record> p_storage)
+{
+  if (!std::has_single_bit(p_storage.size())) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  return trace_ring(p_storage);
+}
+
+trace_ring::trace_ring(std::span<trace_record> p_storage)
+  : m_storage(p_storage)
+{
+  clear();
+}
+
+trace_ring::trace_ring(trace_ring&& p_other) noexcept
+  : m_storage(p_other.m_storage)
+  , m_head(p_other.m_head.load())
+{
+}
+
+void trace_ring::push(const trace_record& p_record)
+{
+  const auto index = m_head.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = m_storage[index & (m_storage.size() - 1)];
+  std::atomic_ref<std::uint32_t> sequence(slot.sequence);
+
+  // Mark the slot as being written before touching the rest of it
+  sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.start = p_record.start;
+  slot.duration = p_record.duration;
+  slot.argument = p_record.argument;
+  slot.source = p_record.source;
+  slot.call = p_record.call;
+  slot.status = p_record.status;
+  sequence.store(index + 1, std::memory_order_release);
+}
+
+std::uint32_t trace_ring::pushed() const
+{
+  return m_head.load(std::memory_order_relaxed);
+}
+
+bool trace_ring::read(std::uint32_t p_sequence, trace_record& p_record) const
+{
+  auto& slot = m_storage[(p_sequence - 1) & (m_storage.size() - 1)];
+  std::atomic_ref<std::uint32_t> sequence(slot.sequence);
+
+  if (sequence.load(std::memory_order_acquire) != p_sequence) {
+    return false;
+  }
+  p_record.start = slot.start;
+  p_record.duration = slot.duration;
+  p_record.argument = slot.argument;
+  p_record.source = slot.source;
+  p_record.call = slot.call;
+  p_record.status = slot.status;
+  p_record.sequence = p_sequence;
+
+  // If a writer claimed the slot while it was copied, the copy is torn
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return sequence.load(std::memory_order_relaxed) == p_sequence;
+}
+
+std::span<trace_record> trace_ring::snapshot(
+  std::span<trace_record> p_output) const
+{
+  const auto head = m_head.load(std::memory_order_acquire);
+  const auto available =
+    std::min<std::uint32_t>(head, static_cast<std::uint32_t>(m_storage.size()));
+
+  std::size_t count = 0;
+  for (auto sequence = head - available + 1;
+       sequence <= head && count < p_output.size();
+       sequence++) {
+    if (read(sequence, p_output[count])) {
+      count++;
+    }
+  }
+  return p_output.first(count);
+}
+
+void trace_ring::clear()
+{
+  for (auto& record : m_storage) {
+    record = trace_record{};
+  }
+  m_head.store(0, std::memory_order_release);
+}
+
+status trace_ring::dump(hal::serial& p_port, hal::hertz p_frequency) const
+{
+  const auto head = m_head.load(std::memory_order_acquire);
+  const auto available =
+    std::min<std::uint32_t>(head, static_cast<std::uint32_t>(m_storage.size()));
+
+  std::array<hal::byte, header_size> header{};
+  std::copy(dump_magic.begin(), dump_magic.end(), header.begin());
+  put<std::uint16_t>(header, 4, format_version);
+  put<std::uint16_t>(header, 6, record_size);
+  put<std::uint32_t>(header, 8, std::bit_cast<std::uint32_t>(p_frequency));
+  put<std::uint32_t>(header, 12, available);
+  HAL_CHECK(p_port.write(header));
+
+  std::array<hal::byte, record_size * records_per_write> buffer{};
+  std::size_t buffered = 0;
+  for (auto sequence = head - available + 1; sequence <= head; sequence++) {
+    // A record overwritten since head was read is dumped as an empty record
+    trace_record record{};
+    if (!read(sequence, record)) {
+      record = trace_record{};
+    }
+    encode(record,
+           std::span(buffer).subspan(buffered * record_size, record_size));
+    if (++buffered == records_per_write) {
+      HAL_CHECK(p_port.write(buffer));
+      buffered = 0;
+    }
+  }
+
+  if (buffered != 0) {
+    HAL_CHECK(p_port.write(std::span(buffer).first(buffered * record_size)));
+  }
+  return hal::success();
+}
+
+result<trace_dump_header> trace_ring::decode_header(
+  std::span<const hal::byte, header_size> p_bytes)
+{
+  if (!std::equal(dump_magic.begin(), dump_magic.end(), p_bytes.begin())) {
+    return hal::new_error(std::errc::illegal_byte_sequence);
+  }
+  return trace_dump_header{
+    .version = get<std::uint16_t>(p_bytes, 4),
+    .record_size = get<std::uint16_t>(p_bytes, 6),
+    .frequency = std::bit_cast<hal::hertz>(get<std::uint32_t>(p_bytes, 8)),
+    .record_count = get<std::uint32_t>(p_bytes, 12),
+  };
+}
+
+trace_record trace_ring::decode(std::span<const hal::byte, record_size> p_bytes)
+{
+  return trace_record{
+    .start = get<std::uint64_t>(p_bytes, 0),
+    .duration = get<std::uint32_t>(p_bytes, 8),
+    .sequence = get<std::uint32_t>(p_bytes, 12),
+    .argument = get<std::uint32_t>(p_bytes, 16),
+    .source = get<std::uint16_t>(p_bytes, 20),
+    .call = static_cast<trace_call>(get<std::uint8_t>(p_bytes, 22)),
+    .status = get<std::uint8_t>(p_bytes, 23),
+  };
+}
+}  // namespace hal::soft
@@ -0,0 +1,207 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/waveform_generator.hpp>
+
+#include <cmath>
+#include <ratio>
+
+namespace hal::soft {
+namespace {
+/// Bits of the phase below the table index used to interpolate
+constexpr std::uint32_t fraction_bits = 15;
+constexpr float sample_scale = 1.0f / 65535.0f;
+
+result<std::uint32_t> tuning_word(hal::hertz p_frequency,
+                                  hal::hertz p_sample_rate)
+{
+  if (p_frequency < 0.0f || p_frequency >= p_sample_rate / 2.0f) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  // Phase increment per sample, where 2^32 is one full period
+  const auto word = static_cast<double>(p_frequency) * 4294967296.0 /
+                    static_cast<double>(p_sample_rate);
+  return static_cast<std::uint32_t>(std::llround(word));
+}
+
+bool is_ring_size(std::size_t p_size)
+{
+  return std::has_single_bit(p_size);
+}
+}  // namespace
+
+result<waveform_generator> waveform_generator::create(
+  hal::dac& p_dac,
+  hal::timer& p_timer,
+  std::span<const std::uint16_t> p_table,
+  const settings& p_settings)
+{
+  return create(p_dac, p_timer, p_table, p_settings, {});
+}
+
+result<waveform_generator> waveform_generator::create(
+  hal::dac& p_dac,
+  hal::timer& p_timer,
+  std::span<const std::uint16_t> p_table,
+  const settings& p_settings,
+  std::span<std::uint16_t> p_block)
+{
+  if (!is_ring_size(p_table.size()) || p_table.size() < 2 ||
+      p_table.size() > 65536 ||
+      (!p_block.empty() && !is_ring_size(p_block.size())) ||
+      p_settings.sample_rate < 1.0f) {
+    return hal::new_error(std::errc::invalid_argument);
+  }
+  waveform_generator generator(p_dac, p_timer, p_table, p_settings, p_block);
+  HAL_CHECK(generator.frequency(p_settings.frequency));
+  return generator;
+}
+
+waveform_generator::waveform_generator(hal::dac& p_dac,
+                                       hal::timer& p_timer,
+                                       std::span<const std::uint16_t> p_table,
+                                       const settings& p_settings,
+                                       std::span<std::uint16_t> p_block)
+  : m_dac(&p_dac)
+  , m_timer(&p_timer)
+  , m_table(p_table)
+  , m_block(p_block)
+  , m_period(static_cast<std::int64_t>(std::nano::den / p_settings.sample_rate))
+  , m_sample_rate(p_settings.sample_rate)
+  , m_table_bits(static_cast<std::uint32_t>(std::countr_zero(p_table.size())))
+  , m_interpolate(p_settings.interpolate)
+{
+}
+
+waveform_generator::waveform_generator(waveform_generator&& p_other) noexcept
+  : m_dac(p_other.m_dac)
+  , m_timer(p_other.m_timer)
+  , m_table(p_other.m_table)
+  , m_block(p_other.m_block)
+  , m_period(p_other.m_period)
+  , m_sample_rate(p_other.m_sample_rate)
+  , m_tuning_word(p_other.m_tuning_word)
+  , m_phase(p_other.m_phase)
+  , m_table_bits(p_other.m_table_bits)
+  , m_interpolate(p_other.m_interpolate)
+  , m_running(p_other.m_running)
+  , m_last_sample(p_other.m_last_sample)
+  , m_written(p_other.m_written.load())
+  , m_played(p_other.m_played.load())
+  , m_underruns(p_other.m_underruns)
+{
+  // The pending callback refers to the other object, so point it here
+  p_other.m_running = false;
+  if (m_running) {
+    m_running = bool{ m_timer->schedule([this]() { output(); }, m_period) };
+  }
+}
+
+waveform_generator::~waveform_generator()
+{
+  if (m_running) {
+    (void)m_timer->cancel();
+  }
+}
+
+status waveform_generator::start()
+{
+  if (m_running) {
+    return hal::success();
+  }
+  HAL_CHECK(m_timer->schedule([this]() { output(); }, m_period));
+  m_running = true;
+  return hal::success();
+}
+
+status waveform_generator::stop()
+{
+  m_running = false;
+  HAL_CHECK(m_timer->cancel());
+  return hal::success();
+}
+
+status waveform_generator::frequency(hal::hertz p_frequency)
+{
+  m_tuning_word = HAL_CHECK(tuning_word(p_frequency, m_sample_rate));
+  return hal::success();
+}
+
+std::size_t waveform_generator::fill()
+{
+  const auto size = static_cast<std::uint32_t>(m_block.size());
+  const auto mask = size - 1;
+  const auto played = m_played.load(std::memory_order_acquire);
+  auto written = m_written.load(std::memory_order_relaxed);
+  const auto space = size - (written - played);
+
+  for (std::uint32_t i = 0; i < space; i++) {
+    m_block[written & mask] = next_sample();
+    written++;
+  }
+  m_written.store(written, std::memory_order_release);
+  return space;
+}
+
+std::uint32_t waveform_generator::underruns() const
+{
+  return m_underruns;
+}
+
+std::uint32_t waveform_generator::phase() const
+{
+  return m_phase;
+}
+
+std::uint16_t waveform_generator::next_sample()
+{
+  const auto phase = m_phase;
+  m_phase += m_tuning_word;
+
+  const auto mask = static_cast<std::uint32_t>(m_table.size() - 1);
+  const auto index = phase >> (32 - m_table_bits);
+  const auto sample = m_table[index];
+  if (!m_interpolate) {
+    return sample;
+  }
+
+  // The phase bits below the index, reduced so the product fits in 32 bits
+  const auto fraction =
+    static_cast<std::int32_t>((phase << m_table_bits) >> (32 - fraction_bits));
+  const auto next = m_table[(index + 1) & mask];
+  const auto delta = static_cast<std::int32_t>(next) - sample;
+  return static_cast<std::uint16_t>(sample +
+                                    ((delta * fraction) >> fraction_bits));
+}
+
+void waveform_generator::output()
+{
+  // Reschedule first so the time spent writing does not stretch the period
+  (void)m_timer->schedule([this]() { output(); }, m_period);
+
+  if (m_block.empty()) {
+    m_last_sample = next_sample();
+  } else {
+    const auto played = m_played.load(std::memory_order_relaxed);
+    if (played != m_written.load(std::memory_order_acquire)) {
+      m_last_sample = m_block[played & (m_block.size() - 1)];
+      m_played.store(played + 1, std::memory_order_release);
+    } else {
+      m_underruns++;
+    }
+  }
+
+  (void)m_dac->write(static_cast<float>(m_last_sample) * sample_scale);
+}
+}  // namespace hal::soft
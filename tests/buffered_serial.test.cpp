@@ -0,0 +1,148 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/buffered_serial.hpp>
+
+#include <algorithm>
+
+#include <libhal-soft/inert_drivers/inert_serial.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void buffered_serial_test()
+{
+  using namespace boost::ut;
+
+  "hal::soft::buffered_serial::create"_test = []() {
+    // Setup
+    std::array<hal::byte, 8> storage{};
+    std::array<hal::byte, 8> ring_good{};
+    std::array<hal::byte, 6> ring_bad{};
+    auto port = inert_serial::create_loopback(storage).value();
+
+    // Exercise
+    auto good = buffered_serial::create(port, ring_good);
+    auto bad = buffered_serial::create(port, ring_bad);
+
+    // Verify
+    expect(bool{ good });
+    expect(!bad);
+  };
+
+  "hal::soft::buffered_serial::peek + consume"_test = []() {
+    // Setup
+    std::array<hal::byte, 16> storage{};
+    std::array<hal::byte, 4> ring{};
+    constexpr std::array<hal::byte, 3> first_data{ 'a', 'b', 'c' };
+    constexpr std::array<hal::byte, 3> second_data{ 'd', 'e', 'f' };
+    auto port = inert_serial::create_loopback(storage).value();
+    auto test = buffered_serial::create(port, ring).value();
+
+    // Exercise
+    (void)port.write(first_data);
+    auto peek1 = test.peek().value();
+    auto peek1_size = peek1.size();
+    test.consume(2);
+    (void)port.write(second_data);
+    auto peek2 = test.peek().value();
+
+    // Verify
+    expect(that % 3U == peek1_size);
+    // "cd" run up to the end of the ring and "ef" wraps around to the start
+    expect(that % 4U == peek2.size());
+    expect(that % 2U == peek2.first.size());
+    expect(that % 2U == peek2.second.size());
+    expect(that % 'c' == peek2.first[0]);
+    expect(that % 'd' == peek2.first[1]);
+    expect(that % 'e' == peek2.second[0]);
+    expect(that % 'f' == peek2.second[1]);
+  };
+
+  "hal::soft::buffered_serial::read_until"_test = []() {
+    // Setup
+    std::array<hal::byte, 16> storage{};
+    std::array<hal::byte, 8> ring{};
+    constexpr std::array<hal::byte, 6> data{ 'o', 'k', '\n', 'h', 'i', '\n' };
+    auto port = inert_serial::create_loopback(storage).value();
+    auto test = buffered_serial::create(port, ring).value();
+
+    // Exercise
+    (void)port.write(std::span(data).first(4));
+    auto line1 = test.read_until('\n').value();
+    auto line1_first = line1.first;
+    auto partial = test.read_until('\n').value();
+    auto partial_size = partial.size();
+    (void)port.write(std::span(data).subspan(4));
+    auto line2 = test.read_until('\n').value();
+
+    // Verify
+    expect(that % 3U == line1_first.size());
+    expect(std::equal(line1_first.begin(), line1_first.end(), data.begin()));
+    expect(that % 0U == partial_size);
+    expect(that % 3U == line2.size());
+    expect(that % 'h' == line2.first[0]);
+    expect(that % 0U == test.size());
+  };
+
+  "hal::soft::buffered_serial::read_until on a full ring"_test = []() {
+    // Setup
+    std::array<hal::byte, 16> storage{};
+    std::array<hal::byte, 4> ring{};
+    constexpr std::array<hal::byte, 6> data{ 't', 'o', 'o', 'l', 'o', 'n' };
+    auto port = inert_serial::create_loopback(storage).value();
+    auto test = buffered_serial::create(port, ring).value();
+
+    // Exercise
+    (void)port.write(data);
+    auto too_long = test.read_until('\n');
+    const auto kept = test.size();
+    test.consume(test.size());
+    auto rest = test.read_until('\n');
+
+    // Verify
+    expect(!bool{ too_long });
+    expect(that % 4U == kept);
+    // The remaining bytes fit, so the delimiter may still arrive
+    expect(bool{ rest });
+    expect(that % 0U == rest.value().size());
+    expect(that % 2U == test.size());
+  };
+
+  "hal::soft::buffered_serial as hal::serial"_test = []() {
+    // Setup
+    std::array<hal::byte, 16> storage{};
+    std::array<hal::byte, 4> ring{};
+    std::array<hal::byte, 8> buffer{};
+    constexpr std::array<hal::byte, 6> data{ '1', '2', '3', '4', '5', '6' };
+    auto port = inert_serial::create_loopback(storage).value();
+    auto buffered = buffered_serial::create(port, ring).value();
+    hal::serial& test = buffered;
+
+    // Exercise
+    auto write_result = test.write(data);
+    auto read_result1 = test.read(std::span(buffer).first(3));
+    auto read_result2 = test.read(buffer);
+
+    // Verify
+    expect(bool{ write_result });
+    expect(that % 3U == read_result1.value().data.size());
+    expect(that % 1U == read_result1.value().available);
+    expect(that % 4U == read_result1.value().capacity);
+    expect(that % 3U == read_result2.value().data.size());
+    expect(that % '4' == buffer[0]);
+    expect(that % '6' == buffer[2]);
+  };
+};
+}  // namespace hal::soft
@@ -0,0 +1,133 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/can_router.hpp>
+
+#include <libhal-soft/inert_drivers/inert_can.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void can_router_test()
+{
+  using namespace boost::ut;
+
+  "can_router routes by ID"_test = []() {
+    // Setup
+    auto bus = inert_can::create_loopback().value();
+    auto router = can_router<4>::create(bus).value();
+    int first_count = 0;
+    int second_count = 0;
+    hal::can::message_t received{};
+
+    // Exercise
+    auto first_result = router.add_route(
+      0x100, [&](const hal::can::message_t&) { first_count++; });
+    auto second_result =
+      router.add_route(0x200, [&](const hal::can::message_t& p_message) {
+        received = p_message;
+        second_count++;
+      });
+    (void)bus.send({ .id = 0x200, .payload = { 0x42 }, .length = 1 });
+    (void)bus.send({ .id = 0x100, .length = 0 });
+    (void)bus.send({ .id = 0x300, .length = 0 });
+
+    // Verify
+    expect(bool{ first_result });
+    expect(bool{ second_result });
+    expect(that % 1 == first_count);
+    expect(that % 1 == second_count);
+    expect(that % 0x200U == received.id);
+    expect(that % 0x42 == received.payload[0]);
+    expect(that % 1U == router.unrouted_messages());
+  };
+
+  "can_router mask route"_test = []() {
+    // Setup
+    auto bus = inert_can::create_loopback().value();
+    auto router = can_router<2, 32>::create(bus).value();
+    int count = 0;
+
+    // Exercise
+    auto result = router.add_route(
+      0x7E0, 0x7F0, [&](const hal::can::message_t&) { count++; });
+    for (hal::can::id_t id = 0x7D0; id < 0x800; id++) {
+      (void)bus.send({ .id = id, .length = 0 });
+    }
+
+    // Verify
+    expect(bool{ result });
+    expect(that % 16 == count);
+    expect(that % 32U == router.unrouted_messages());
+  };
+
+  "can_router rejects conflicts and overflow"_test = []() {
+    // Setup
+    auto bus = inert_can::create_loopback().value();
+    auto router = can_router<2, 16>::create(bus).value();
+    auto handler = [](const hal::can::message_t&) {};
+
+    // Exercise
+    auto too_wide = router.add_route(0x700, 0x700, handler);
+    auto first = router.add_route(0x10, 0x7F8, handler);
+    auto conflict = router.add_route(0x13, handler);
+    auto second = router.add_route(0x20, handler);
+    auto out_of_handlers = router.add_route(0x30, handler);
+
+    // Verify
+    expect(!bool{ too_wide });
+    expect(bool{ first });
+    expect(!bool{ conflict });
+    expect(bool{ second });
+    expect(!bool{ out_of_handlers });
+  };
+
+  "can_router follows moves"_test = []() {
+    // Setup
+    auto bus = inert_can::create_loopback().value();
+    auto original = can_router<1>::create(bus).value();
+    int count = 0;
+    (void)original.add_route(
+      0x123, [&](const hal::can::message_t&) { count++; });
+
+    // Exercise
+    auto moved = std::move(original);
+    (void)bus.send({ .id = 0x123, .length = 0 });
+    (void)bus.send({ .id = 0x124, .length = 0 });
+
+    // Verify
+    expect(that % 1 == count);
+    expect(that % 1U == moved.unrouted_messages());
+  };
+
+  "can_router detaches when destroyed"_test = []() {
+    // Setup
+    auto bus = inert_can::create_loopback().value();
+    int count = 0;
+
+    // Exercise
+    {
+      // The temporaries moved from by create() must leave the bus alone
+      auto router = can_router<1>::create(bus).value();
+      (void)router.add_route(
+        0x123, [&](const hal::can::message_t&) { count++; });
+      (void)bus.send({ .id = 0x123, .length = 0 });
+    }
+    (void)bus.send({ .id = 0x123, .length = 0 });
+
+    // Verify
+    expect(that % 1 == count);
+  };
+}
+}  // namespace hal::soft
@@ -0,0 +1,275 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/can_tx_queue.hpp>
+
+#include <vector>
+
+#include <boost/ut.hpp>
+
+namespace {
+/// CAN bus with a limited number of mailboxes, emptied by the test
+struct mailbox_can : public hal::can
+{
+  std::vector<hal::can::message_t> sent{};
+  std::size_t mailboxes = 1;
+
+  /// Free every mailbox, as if their messages went out on the bus
+  void drain()
+  {
+    mailboxes += in_flight;
+    in_flight = 0;
+  }
+
+private:
+  hal::status driver_configure(const settings&) final
+  {
+    return hal::success();
+  }
+
+  hal::status driver_bus_on() final
+  {
+    return hal::success();
+  }
+
+  hal::result<send_t> driver_send(const message_t& p_message) final
+  {
+    if (mailboxes == 0) {
+      return hal::new_error(std::errc::device_or_resource_busy);
+    }
+    mailboxes--;
+    in_flight++;
+    sent.push_back(p_message);
+    return send_t{};
+  }
+
+  void driver_on_receive(hal::callback<handler>) final
+  {
+  }
+
+  std::size_t in_flight = 0;
+};
+
+/// Timer whose scheduled callback is run by the test
+struct manual_timer : public hal::timer
+{
+  /// Run the scheduled callback, if there is one
+  bool run()
+  {
+    if (!scheduled) {
+      return false;
+    }
+    scheduled = false;
+    callback();
+    return true;
+  }
+
+  hal::callback<void(void)> callback;
+  hal::time_duration delay{};
+  bool scheduled = false;
+
+private:
+  hal::result<is_running_t> driver_is_running() final
+  {
+    return is_running_t{ .is_running = scheduled };
+  }
+
+  hal::result<cancel_t> driver_cancel() final
+  {
+    scheduled = false;
+    return cancel_t{};
+  }
+
+  hal::result<schedule_t> driver_schedule(hal::callback<void(void)> p_callback,
+                                          hal::time_duration p_delay) final
+  {
+    callback = p_callback;
+    delay = p_delay;
+    scheduled = true;
+    return schedule_t{};
+  }
+};
+}  // namespace
+
+namespace hal::soft {
+void can_tx_queue_test()
+{
+  using namespace boost::ut;
+
+  "can_tx_queue sends by priority"_test = []() {
+    // Setup
+    mailbox_can bus;
+    std::array<hal::can::message_t, 4> storage{};
+    auto test = can_tx_queue::create(bus, storage).value();
+
+    // Exercise
+    auto first = test.send({ .id = 0x300, .length = 0 });
+    auto second = test.send({ .id = 0x200, .payload = { 1 }, .length = 1 });
+    auto third = test.send({ .id = 0x100, .length = 0 });
+    auto fourth = test.send({ .id = 0x200, .payload = { 2 }, .length = 1 });
+    const auto queued = test.size();
+    bus.drain();
+    const auto sent_after_drain = test.transmit();
+    bus.drain();
+    test.transmit();
+    bus.drain();
+    test.transmit();
+
+    // Verify
+    expect(bool{ first });
+    expect(bool{ second });
+    expect(bool{ third });
+    expect(bool{ fourth });
+    expect(that % 3U == queued);
+    expect(that % 1U == sent_after_drain);
+    expect(that % 0U == test.size());
+    expect(that % 4U == bus.sent.size());
+    expect(that % 0x300U == bus.sent[0].id);
+    expect(that % 0x100U == bus.sent[1].id);
+    expect(that % 0x200U == bus.sent[2].id);
+    expect(that % 1 == bus.sent[2].payload[0]);
+    expect(that % 0x200U == bus.sent[3].id);
+    expect(that % 2 == bus.sent[3].payload[0]);
+  };
+
+  "can_tx_queue send_latest replaces queued message"_test = []() {
+    // Setup
+    mailbox_can bus;
+    bus.mailboxes = 0;
+    std::array<hal::can::message_t, 4> storage{};
+    auto test = can_tx_queue::create(bus, storage).value();
+
+    // Exercise
+    (void)test.send_latest({ .id = 0x400, .payload = { 1 }, .length = 1 });
+    (void)test.send_latest({ .id = 0x400, .payload = { 2 }, .length = 1 });
+    const auto queued = test.size();
+    bus.mailboxes = 4;
+    test.transmit();
+
+    // Verify
+    expect(that % 1U == queued);
+    expect(that % 1U == bus.sent.size());
+    expect(that % 2 == bus.sent[0].payload[0]);
+  };
+
+  "can_tx_queue full queue"_test = []() {
+    // Setup
+    mailbox_can bus;
+    bus.mailboxes = 0;
+    std::array<hal::can::message_t, 2> storage{};
+    auto test = can_tx_queue::create(bus, storage).value();
+    (void)test.send({ .id = 0x200, .length = 0 });
+    (void)test.send({ .id = 0x300, .length = 0 });
+
+    // Exercise
+    auto lower_priority = test.send({ .id = 0x400, .length = 0 });
+    auto higher_priority = test.send({ .id = 0x100, .length = 0 });
+    bus.mailboxes = 4;
+    test.transmit();
+
+    // Verify
+    expect(!bool{ lower_priority });
+    expect(bool{ higher_priority });
+    expect(that % 1U == test.dropped_messages());
+    expect(that % 2U == bus.sent.size());
+    expect(that % 0x100U == bus.sent[0].id);
+    expect(that % 0x200U == bus.sent[1].id);
+  };
+
+  "can_tx_queue retries from timer"_test = []() {
+    // Setup
+    using namespace std::chrono_literals;
+    mailbox_can bus;
+    manual_timer timer;
+    std::array<hal::can::message_t, 4> storage{};
+    auto test = can_tx_queue::create(bus, storage, timer, 100us).value();
+
+    // Exercise
+    (void)test.send({ .id = 0x10, .length = 0 });
+    (void)test.send({ .id = 0x20, .length = 0 });
+    const bool scheduled = timer.scheduled;
+    bus.drain();
+    timer.run();
+    const bool rescheduled = timer.scheduled;
+
+    // Verify
+    expect(scheduled);
+    expect(!rescheduled);
+    expect(that % 100us == timer.delay);
+    expect(that % 0U == test.size());
+    expect(that % 2U == bus.sent.size());
+  };
+
+  "can_tx_queue ranks messages like the bus"_test = []() {
+    // Setup
+    mailbox_can bus;
+    std::array<hal::can::message_t, 4> storage{};
+    auto test = can_tx_queue::create(bus, storage).value();
+    // Extended ID with base ID 0x100, so it beats standard ID 0x200
+    constexpr hal::can::id_t extended = (0x100 << 18) | 0x1234;
+
+    // Exercise
+    (void)test.send({ .id = 0x7FF, .length = 0 });
+    (void)test.send({ .id = 0x200, .length = 0 });
+    (void)test.send({ .id = 0x100, .is_remote_request = true });
+    (void)test.send({ .id = extended, .length = 0 });
+    (void)test.send({ .id = 0x100, .length = 0 });
+    for (int i = 0; i < 5; i++) {
+      bus.drain();
+      test.transmit();
+    }
+
+    // Verify
+    expect(that % 5U == bus.sent.size());
+    expect(that % 0x7FFU == bus.sent[0].id);
+    expect(that % 0x100U == bus.sent[1].id);
+    expect(!bus.sent[1].is_remote_request);
+    expect(that % 0x100U == bus.sent[2].id);
+    expect(bus.sent[2].is_remote_request);
+    expect(that % extended == bus.sent[3].id);
+    expect(that % 0x200U == bus.sent[4].id);
+  };
+
+  "can_tx_queue cancels its retry timer when destroyed"_test = []() {
+    // Setup
+    using namespace std::chrono_literals;
+    mailbox_can bus;
+    manual_timer timer;
+    std::array<hal::can::message_t, 4> storage{};
+
+    // Exercise
+    {
+      auto created = can_tx_queue::create(bus, storage, timer, 100us).value();
+      auto test = std::move(created);
+      (void)test.send({ .id = 0x10, .length = 0 });
+      (void)test.send({ .id = 0x20, .length = 0 });
+    }
+
+    // Verify
+    expect(!timer.scheduled);
+    expect(that % 1U == bus.sent.size());
+  };
+
+  "can_tx_queue rejects empty storage"_test = []() {
+    // Setup
+    mailbox_can bus;
+
+    // Exercise
+    auto result = can_tx_queue::create(bus, std::span<hal::can::message_t>{});
+
+    // Verify
+    expect(!bool{ result });
+  };
+}
+}  // namespace hal::soft
@@ -0,0 +1,168 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/debounced_input_pin.hpp>
+
+#include <array>
+#include <vector>
+
+#include <libhal-soft/simulated_time.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+class settable_pin : public hal::input_pin
+{
+public:
+  bool state = false;
+  int reads = 0;
+
+private:
+  status driver_configure(const settings&) override
+  {
+    return hal::success();
+  }
+
+  result<level_t> driver_level() override
+  {
+    reads++;
+    return level_t{ .state = state };
+  }
+};
+}  // namespace
+
+void debounced_input_pin_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "debounced_input_pin integrator ignores short glitches"_test = []() {
+    // Setup
+    settable_pin pin;
+    auto debounced = debounced_input_pin::create(pin, 3).value();
+    const std::array samples{ false, true, false, true, true, true,
+                              true,  false, true, false, false, false };
+    std::vector<bool> levels;
+
+    // Exercise
+    for (bool sample : samples) {
+      pin.state = sample;
+      levels.push_back(debounced.level().value().state);
+    }
+
+    // Verify
+    const std::vector<bool> expected{
+      false, false, false, false, false, true,
+      true,  true,  true,  true,  true,  false,
+    };
+    expect(expected == levels);
+  };
+
+  "debounced_input_pin integrator rejects zero samples"_test = []() {
+    // Setup
+    settable_pin pin;
+
+    // Exercise
+    auto result = debounced_input_pin::create(pin, 0);
+
+    // Verify
+    expect(!bool{ result });
+  };
+
+  "debounced_input_pin lock-out reports edges immediately"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto clock = simulated_steady_clock::create(time).value();
+    settable_pin pin;
+    auto debounced = debounced_input_pin::create(pin, clock, 1ms).value();
+
+    // Exercise
+    const bool initial = debounced.level().value().state;
+    pin.state = true;
+    const bool edge = debounced.level().value().state;
+    const int reads_after_edge = pin.reads;
+    pin.state = false;
+    time.advance(500us);
+    const bool bounce = debounced.level().value().state;
+    const int reads_during_lockout = pin.reads;
+    time.advance(1ms);
+    const bool released = debounced.level().value().state;
+
+    // Verify
+    expect(!initial);
+    expect(edge);
+    expect(bounce);
+    expect(that % reads_after_edge == reads_during_lockout);
+    expect(!released);
+  };
+
+  "debounced_input_pin lock-out rejects sub-tick durations"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto clock = simulated_steady_clock::create(time).value();
+    settable_pin pin;
+
+    // Exercise
+    auto result = debounced_input_pin::create(pin, clock, 100ns);
+
+    // Verify
+    expect(!bool{ result });
+  };
+
+  "vertical_debouncer needs four matching samples"_test = []() {
+    // Setup
+    vertical_debouncer debouncer;
+    std::vector<std::uint32_t> states;
+    std::vector<std::uint32_t> changes;
+    // Bit 0 and 2 go high, then bit 2 glitches once. Bit 1 keeps bouncing.
+    const std::array<std::uint32_t, 8> samples{
+      0b101, 0b111, 0b101, 0b111, 0b101, 0b001, 0b101, 0b101,
+    };
+
+    // Exercise
+    for (auto sample : samples) {
+      states.push_back(debouncer.update(sample));
+      changes.push_back(debouncer.changed());
+    }
+
+    // Verify
+    const std::vector<std::uint32_t> expected_states{
+      0b000, 0b000, 0b000, 0b101, 0b101, 0b101, 0b101, 0b101,
+    };
+    const std::vector<std::uint32_t> expected_changes{
+      0b000, 0b000, 0b000, 0b101, 0b000, 0b000, 0b000, 0b000,
+    };
+    expect(expected_states == states);
+    expect(expected_changes == changes);
+  };
+
+  "vertical_debouncer releases after four samples"_test = []() {
+    // Setup
+    vertical_debouncer debouncer(0xFFFF'FFFF);
+
+    // Exercise
+    debouncer.update(0);
+    debouncer.update(0);
+    debouncer.update(0);
+    const auto before = debouncer.state();
+    debouncer.update(0);
+
+    // Verify
+    expect(that % 0xFFFF'FFFFU == before);
+    expect(that % 0U == debouncer.state());
+    expect(that % 0xFFFF'FFFFU == debouncer.changed());
+  };
+};
+}  // namespace hal::soft
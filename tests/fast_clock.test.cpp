@@ -0,0 +1,135 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/fast_clock.hpp>
+
+#include <array>
+#include <cmath>
+
+#include <libhal-soft/simulated_time.hpp>
+
+#include <boost/ut.hpp>
+
+namespace {
+/// Steady clock with a narrow counter, set by the test
+struct narrow_clock : public hal::steady_clock
+{
+  hal::hertz frequency_hz = 1'000'000.0f;
+  std::uint64_t counter = 0;
+
+private:
+  frequency_t driver_frequency() final
+  {
+    return frequency_t{ .operating_frequency = frequency_hz };
+  }
+
+  uptime_t driver_uptime() final
+  {
+    return uptime_t{ .ticks = counter };
+  }
+};
+}  // namespace
+
+namespace hal::soft {
+void fast_clock_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "fast_clock extends a 16-bit counter"_test = []() {
+    // Setup
+    narrow_clock narrow;
+    narrow.counter = 0xFFF0;
+    auto test = fast_clock::create(narrow, 16).value();
+
+    // Exercise
+    const auto before_wrap = test.uptime().ticks;
+    narrow.counter = 0x0010;
+    const auto after_wrap = test.uptime().ticks;
+    narrow.counter = 0xFFFF;
+    const auto before_second_wrap = test.uptime().ticks;
+    narrow.counter = 0x0000;
+    const auto after_second_wrap = test.uptime().ticks;
+
+    // Verify
+    expect(that % 0xFFF0U == before_wrap);
+    expect(that % 0x1'0010U == after_wrap);
+    expect(that % 0x1'FFFFU == before_second_wrap);
+    expect(that % 0x2'0000U == after_second_wrap);
+    expect(that % 65536us == test.wrap_period());
+  };
+
+  "fast_clock conversions match division"_test = []() {
+    // Setup
+    constexpr std::array<hal::hertz, 5> frequencies{
+      32'768.0f, 1'000'000.0f, 12'000'000.0f, 48'000'000.0f, 1e9f,
+    };
+    constexpr std::array<std::uint64_t, 5> tick_counts{
+      1, 999, 123'456'789, 1ULL << 32, 1ULL << 44,
+    };
+
+    for (const auto frequency : frequencies) {
+      narrow_clock narrow;
+      narrow.frequency_hz = frequency;
+      auto test = fast_clock::create(narrow).value();
+
+      for (const auto ticks : tick_counts) {
+        // Exercise
+        const auto duration = test.to_duration(ticks);
+        const auto round_trip = test.to_ticks(duration);
+        const auto expected = static_cast<double>(ticks) * 1e9 / frequency;
+
+        // Verify
+        expect(std::abs(duration.count() - expected) <= 1.0 + expected * 1e-9)
+          << "frequency " << frequency << " ticks " << ticks;
+        expect(round_trip <= ticks && ticks - round_trip <= 1)
+          << "frequency " << frequency << " ticks " << ticks;
+      }
+    }
+  };
+
+  "fast_clock delay"_test = []() {
+    // Setup
+    auto time = simulated_time::create(48'000'000.0f, 10us).value();
+    auto clock = simulated_steady_clock::create(time).value();
+    auto test = fast_clock::create(clock).value();
+
+    // Exercise
+    const auto start = test.now();
+    test.delay(2ms);
+    const auto elapsed = test.now() - start;
+
+    // Verify
+    expect(that % 48'000'000.0f == test.frequency().operating_frequency);
+    expect(elapsed >= 2ms);
+    expect(elapsed <= 2ms + 20us);
+  };
+
+  "fast_clock rejects invalid counters"_test = []() {
+    // Setup
+    narrow_clock narrow;
+
+    // Exercise
+    auto zero_bits = fast_clock::create(narrow, 0);
+    auto too_many_bits = fast_clock::create(narrow, 65);
+    narrow.frequency_hz = 0.0f;
+    auto no_frequency = fast_clock::create(narrow);
+
+    // Verify
+    expect(!bool{ zero_bits });
+    expect(!bool{ too_many_bits });
+    expect(!bool{ no_frequency });
+  };
+}
+}  // namespace hal::soft
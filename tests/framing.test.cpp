@@ -0,0 +1,212 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/framing.hpp>
+
+#include <algorithm>
+
+#include <libhal-soft/inert_drivers/inert_serial.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+/// Decode everything in p_encoded one byte at a time and copy each completed
+/// frame into p_frames.
+template<class Decoder>
+std::size_t decode_bytewise(Decoder& p_decoder,
+                            std::span<const hal::byte> p_encoded,
+                            std::span<std::array<hal::byte, 300>> p_frames,
+                            std::span<std::size_t> p_lengths)
+{
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < p_encoded.size(); i++) {
+    auto decoded = p_decoder.decode(p_encoded.subspan(i, 1));
+    if (decoded.complete && count < p_frames.size()) {
+      std::copy(
+        decoded.frame.begin(), decoded.frame.end(), p_frames[count].begin());
+      p_lengths[count] = decoded.frame.size();
+      count++;
+    }
+  }
+  return count;
+}
+}  // namespace
+
+void framing_test()
+{
+  using namespace boost::ut;
+
+  "hal::soft::cobs round trip"_test = []() {
+    // Setup
+    std::array<hal::byte, 1024> storage{};
+    std::array<hal::byte, 1024> encoded{};
+    std::array<hal::byte, 300> frame_buffer{};
+    std::array<std::array<hal::byte, 300>, 3> frames{};
+    std::array<std::size_t, 3> lengths{};
+    std::array<hal::byte, 5> with_zeros{ 0x11, 0x00, 0x00, 0x22, 0x00 };
+    std::array<hal::byte, 0> empty{};
+    std::array<hal::byte, 300> long_run{};
+    std::fill(long_run.begin(), long_run.end(), 0xA5);
+    long_run[254] = 0x00;
+    auto port = inert_serial::create_loopback(storage).value();
+    auto decoder = cobs_decoder::create(frame_buffer).value();
+
+    // Exercise
+    auto write_result1 = write_cobs_frame(port, with_zeros);
+    auto write_result2 = write_cobs_frame(port, empty);
+    auto write_result3 = write_cobs_frame(port, long_run);
+    auto bytes = port.read(encoded).value().data;
+    auto count = decode_bytewise(decoder, bytes, frames, lengths);
+
+    // Verify
+    expect(bool{ write_result1 });
+    expect(bool{ write_result2 });
+    expect(bool{ write_result3 });
+    // Only the three delimiters may be zero
+    expect(that % 3 == std::count(bytes.begin(), bytes.end(), 0));
+    expect(that % 3U == count);
+    expect(that % with_zeros.size() == lengths[0]);
+    expect(std::equal(with_zeros.begin(), with_zeros.end(), frames[0].begin()));
+    expect(that % 0U == lengths[1]);
+    expect(that % long_run.size() == lengths[2]);
+    expect(std::equal(long_run.begin(), long_run.end(), frames[2].begin()));
+    expect(that % 0U == decoder.dropped_frames());
+  };
+
+  "hal::soft::cobs_encode"_test = []() {
+    // Setup
+    constexpr std::array<hal::byte, 4> payload{ 0x11, 0x22, 0x00, 0x33 };
+    constexpr std::array<hal::byte, 6> expected{ 0x03, 0x11, 0x22,
+                                                 0x02, 0x33, 0x00 };
+    std::array<hal::byte, cobs_max_encoded_size(payload.size())> output{};
+    std::array<hal::byte, 5> too_small{};
+
+    // Exercise
+    auto encoded = cobs_encode(payload, output);
+    auto failed = cobs_encode(payload, too_small);
+
+    // Verify
+    expect(bool{ encoded });
+    expect(!failed);
+    expect(std::equal(expected.begin(),
+                      expected.end(),
+                      encoded.value().begin(),
+                      encoded.value().end()));
+  };
+
+  "hal::soft::cobs_decoder resumes across chunks"_test = []() {
+    // Setup
+    constexpr std::array<hal::byte, 10> encoded{
+      0x02, 0x11, 0x02, 0x22, 0x00,  // frame { 0x11, 0x00, 0x22 }
+      0x03, 0x33, 0x44, 0x00,        // frame { 0x33, 0x44 }
+      0x02,                          // start of the next frame
+    };
+    std::array<hal::byte, 8> frame_buffer{};
+    auto decoder = cobs_decoder::create(frame_buffer).value();
+
+    // Exercise
+    auto decoded1 = decoder.decode(std::span(encoded).first(3));
+    auto decoded2 = decoder.decode(std::span(encoded).subspan(3));
+    auto frame2_size = decoded2.frame.size();
+    auto frame2_last = decoded2.frame.back();
+    auto decoded3 = decoder.decode(decoded2.remaining);
+    auto decoded4 = decoder.decode(decoded3.remaining);
+
+    // Verify
+    expect(!decoded1.complete);
+    expect(that % 0U == decoded1.remaining.size());
+    expect(decoded2.complete);
+    expect(that % 3U == frame2_size);
+    expect(that % 0x22 == frame2_last);
+    expect(that % 5U == decoded2.remaining.size());
+    expect(decoded3.complete);
+    expect(that % 2U == decoded3.frame.size());
+    expect(that % 1U == decoded3.remaining.size());
+    expect(!decoded4.complete);
+  };
+
+  "hal::soft::cobs_decoder drops frames"_test = []() {
+    // Setup
+    constexpr std::array<hal::byte, 12> encoded{
+      0x05, 0x01, 0x02, 0x03, 0x04, 0x00,  // too long for the buffer
+      0x04, 0x01, 0x00,                    // truncated by a delimiter
+      0x02, 0x09, 0x00,                    // valid frame { 0x09 }
+    };
+    std::array<hal::byte, 2> frame_buffer{};
+    auto decoder = cobs_decoder::create(frame_buffer).value();
+
+    // Exercise
+    auto decoded = decoder.decode(encoded);
+
+    // Verify
+    expect(decoded.complete);
+    expect(that % 1U == decoded.frame.size());
+    expect(that % 0x09 == decoded.frame[0]);
+    expect(that % 2U == decoder.dropped_frames());
+  };
+
+  "hal::soft::slip round trip"_test = []() {
+    // Setup
+    std::array<hal::byte, 1024> storage{};
+    std::array<hal::byte, 1024> encoded{};
+    std::array<hal::byte, 300> frame_buffer{};
+    std::array<std::array<hal::byte, 300>, 2> frames{};
+    std::array<std::size_t, 2> lengths{};
+    std::array<hal::byte, 9> payload1{ 0x01, 0xC0, 0x02, 0x03, 0x04,
+                                       0x05, 0x06, 0xDB, 0xC0 };
+    std::array<hal::byte, 12> payload2{ 0x10, 0x11, 0x12, 0x13, 0x14, 0x15,
+                                        0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B };
+    auto port = inert_serial::create_loopback(storage).value();
+    auto decoder = slip_decoder::create(frame_buffer).value();
+
+    // Exercise
+    auto write_result1 = write_slip_frame(port, payload1);
+    auto write_result2 = write_slip_frame(port, payload2);
+    auto bytes = port.read(encoded).value().data;
+    auto count = decode_bytewise(decoder, bytes, frames, lengths);
+    auto decoder2 = slip_decoder::create(frame_buffer).value();
+    auto whole = decoder2.decode(bytes);
+
+    // Verify
+    expect(bool{ write_result1 });
+    expect(bool{ write_result2 });
+    expect(that % 2U == count);
+    expect(that % payload1.size() == lengths[0]);
+    expect(std::equal(payload1.begin(), payload1.end(), frames[0].begin()));
+    expect(that % payload2.size() == lengths[1]);
+    expect(std::equal(payload2.begin(), payload2.end(), frames[1].begin()));
+    expect(whole.complete);
+    expect(that % payload1.size() == whole.frame.size());
+  };
+
+  "hal::soft::slip_decoder drops frames"_test = []() {
+    // Setup
+    constexpr std::array<hal::byte, 10> encoded{
+      0x01, 0xDB, 0x42, 0x02, 0xC0,  // invalid escape sequence
+      0x01, 0x02, 0x03, 0x04, 0xC0,  // too long for the buffer
+    };
+    std::array<hal::byte, 3> frame_buffer{};
+    auto decoder = slip_decoder::create(frame_buffer).value();
+
+    // Exercise
+    auto decoded = decoder.decode(encoded);
+
+    // Verify
+    expect(!decoded.complete);
+    expect(that % 0U == decoded.remaining.size());
+    expect(that % 2U == decoder.dropped_frames());
+  };
+};
+}  // namespace hal::soft
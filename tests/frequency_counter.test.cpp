@@ -0,0 +1,216 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/frequency_counter.hpp>
+
+#include <array>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+class manual_clock : public hal::steady_clock
+{
+public:
+  std::uint64_t ticks = 0;
+
+private:
+  frequency_t driver_frequency() override
+  {
+    return frequency_t{ .operating_frequency = 1'000'000.0f };
+  }
+
+  uptime_t driver_uptime() override
+  {
+    return uptime_t{ .ticks = ticks };
+  }
+};
+
+class manual_interrupt_pin : public hal::interrupt_pin
+{
+public:
+  void edge()
+  {
+    m_handler(true);
+  }
+
+  settings last_settings{};
+
+private:
+  status driver_configure(const settings& p_settings) override
+  {
+    last_settings = p_settings;
+    return hal::success();
+  }
+
+  void driver_on_trigger(hal::callback<handler> p_handler) override
+  {
+    m_handler = p_handler;
+  }
+
+  hal::callback<handler> m_handler = [](bool) {};
+};
+}  // namespace
+
+void frequency_counter_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+  using method = frequency_counter::counting_method;
+
+  "frequency_counter uses reciprocal counting at low rates"_test = []() {
+    // Setup
+    manual_clock clock;
+    manual_interrupt_pin pin;
+    std::array<std::uint64_t, 8> timestamps{};
+    auto counter =
+      frequency_counter::create(
+        pin, clock, timestamps, { .pulses_per_revolution = 2 })
+        .value();
+
+    // Exercise
+    const auto before = counter.measure();
+    for (int i = 0; i < 20; i++) {
+      clock.ticks += 100'000;
+      pin.edge();
+      (void)counter.measure();
+    }
+    clock.ticks += 1000;
+    const auto measurement = counter.measure();
+
+    // Verify
+    expect(method::none == before.method);
+    expect(that % 0.0f == before.frequency);
+    expect(method::reciprocal == measurement.method);
+    expect(that % 10.0f == measurement.frequency);
+    expect(that % 100ms == measurement.period);
+    expect(that % 300.0f == measurement.rpm);
+    expect(that % 20U == counter.edges());
+    expect(hal::interrupt_pin::trigger_edge::rising ==
+           pin.last_settings.trigger);
+  };
+
+  "frequency_counter switches to gated counting at high rates"_test = []() {
+    // Setup
+    manual_clock clock;
+    manual_interrupt_pin pin;
+    std::array<std::uint64_t, 8> timestamps{};
+    auto counter = frequency_counter::create(pin, clock, timestamps).value();
+    frequency_counter::measurement_t measurement;
+
+    // Exercise
+    // 50kHz with a little jitter, measured every millisecond for 250ms
+    for (int i = 0; i < 12'500; i++) {
+      clock.ticks += (i % 2 == 0) ? 19 : 21;
+      pin.edge();
+      if (i % 50 == 49) {
+        measurement = counter.measure();
+      }
+    }
+
+    // Verify
+    expect(method::gated == measurement.method);
+    expect(that % 50'000.0f == measurement.frequency);
+  };
+
+  "frequency_counter reports a stopped signal"_test = []() {
+    // Setup
+    manual_clock clock;
+    manual_interrupt_pin pin;
+    std::array<std::uint64_t, 4> timestamps{};
+    auto counter =
+      frequency_counter::create(pin, clock, timestamps, { .timeout = 500ms })
+        .value();
+    for (int i = 0; i < 4; i++) {
+      clock.ticks += 1000;
+      pin.edge();
+    }
+
+    // Exercise
+    const auto running = counter.measure();
+    clock.ticks += 501'000;
+    const auto stopped = counter.measure();
+
+    // Verify
+    expect(that % 1000.0f == running.frequency);
+    expect(method::none == stopped.method);
+    expect(that % 0.0f == stopped.frequency);
+    expect(that % 0.0f == stopped.rpm);
+  };
+
+  "frequency_counter keeps counting after a move"_test = []() {
+    // Setup
+    manual_clock clock;
+    manual_interrupt_pin pin;
+    std::array<std::uint64_t, 4> timestamps{};
+    auto created = frequency_counter::create(pin, clock, timestamps).value();
+    pin.edge();
+    auto counter = std::move(created);
+
+    // Exercise
+    clock.ticks += 250;
+    pin.edge();
+    const auto measurement = counter.measure();
+
+    // Verify
+    expect(that % 2U == counter.edges());
+    expect(that % 4000.0f == measurement.frequency);
+  };
+
+  "frequency_counter detaches from its pin when destroyed"_test = []() {
+    // Setup
+    manual_clock clock;
+    manual_interrupt_pin pin;
+    std::array<std::uint64_t, 4> timestamps{};
+    std::uint32_t edges = 0;
+
+    // Exercise
+    {
+      auto created = frequency_counter::create(pin, clock, timestamps).value();
+      auto counter = std::move(created);
+      pin.edge();
+      edges = counter.edges();
+    }
+    clock.ticks += 250;
+    pin.edge();
+
+    // Verify
+    expect(that % 1U == edges);
+    expect(that % 0U == timestamps[1]);
+  };
+
+  "frequency_counter rejects invalid settings"_test = []() {
+    // Setup
+    manual_clock clock;
+    manual_interrupt_pin pin;
+    std::array<std::uint64_t, 6> not_power_of_two{};
+    std::array<std::uint64_t, 2> too_small{};
+    std::array<std::uint64_t, 8> timestamps{};
+
+    // Exercise
+    auto size = frequency_counter::create(pin, clock, not_power_of_two);
+    auto small = frequency_counter::create(pin, clock, too_small);
+    auto gate =
+      frequency_counter::create(pin, clock, timestamps, { .gate_time = 10ns });
+    auto pulses = frequency_counter::create(
+      pin, clock, timestamps, { .pulses_per_revolution = 0 });
+
+    // Verify
+    expect(!bool{ size });
+    expect(!bool{ small });
+    expect(!bool{ gate });
+    expect(!bool{ pulses });
+  };
+};
+}  // namespace hal::soft
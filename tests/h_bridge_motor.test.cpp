@@ -0,0 +1,237 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/h_bridge_motor.hpp>
+
+#include <vector>
+
+#include <libhal-soft/simulated_time.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+class recording_pwm : public hal::pwm
+{
+public:
+  hal::hertz frequency_set = 0.0f;
+  std::vector<float> duty_cycles;
+
+private:
+  result<frequency_t> driver_frequency(hal::hertz p_frequency) override
+  {
+    frequency_set = p_frequency;
+    return frequency_t{};
+  }
+
+  result<duty_cycle_t> driver_duty_cycle(float p_duty_cycle) override
+  {
+    duty_cycles.push_back(p_duty_cycle);
+    return duty_cycle_t{};
+  }
+};
+
+class recording_output_pin : public hal::output_pin
+{
+public:
+  std::vector<bool> levels;
+
+private:
+  status driver_configure(const settings&) override
+  {
+    return hal::success();
+  }
+
+  result<set_level_t> driver_level(bool p_high) override
+  {
+    levels.push_back(p_high);
+    return set_level_t{};
+  }
+
+  result<level_t> driver_level() override
+  {
+    return level_t{ .state = !levels.empty() && levels.back() };
+  }
+};
+
+class recording_motor : public hal::motor
+{
+public:
+  std::vector<float> powers;
+
+private:
+  result<power_t> driver_power(float p_power) override
+  {
+    powers.push_back(p_power);
+    return power_t{};
+  }
+};
+}  // namespace
+
+void h_bridge_motor_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "h_bridge_motor drives an enable pwm and direction inputs"_test = []() {
+    // Setup
+    recording_pwm enable;
+    recording_output_pin forward;
+    recording_output_pin reverse;
+    auto motor =
+      h_bridge_motor::create(enable, forward, reverse, { .frequency = 1e3f })
+        .value();
+    const auto created = enable.duty_cycles;
+
+    // Exercise
+    (void)motor.power(0.5f);
+    (void)motor.power(0.75f);
+    (void)motor.power(0.25f);
+    const auto forward_writes = forward.levels.size();
+    (void)motor.power(-0.5f);
+    (void)motor.power(0.0f);
+
+    // Verify
+    expect(that % 1e3f == enable.frequency_set);
+    expect(std::vector<float>{ 0.0f } == created);
+    expect(std::vector<float>{ 0.0f, 0.0f, 0.5f, 0.75f, 0.25f, 0.0f, 0.5f,
+                               0.0f } == enable.duty_cycles);
+    expect(that % 2U == forward_writes);
+    expect(std::vector<bool>{ false, true, false, false } == forward.levels);
+    expect(std::vector<bool>{ false, false, true, false } == reverse.levels);
+  };
+
+  "h_bridge_motor brakes on zero with direction inputs"_test = []() {
+    // Setup
+    recording_pwm enable;
+    recording_output_pin forward;
+    recording_output_pin reverse;
+    auto motor =
+      h_bridge_motor::create(enable, forward, reverse, { .brake = true })
+        .value();
+
+    // Exercise
+    (void)motor.power(1.0f);
+    (void)motor.power(0.0f);
+    (void)motor.power(0.0f);
+
+    // Verify
+    expect(std::vector<float>{ 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f } ==
+           enable.duty_cycles);
+    expect(std::vector<bool>{ false, true, false } == forward.levels);
+    expect(std::vector<bool>{ false, false, false } == reverse.levels);
+  };
+
+  "h_bridge_motor drives a pwm on each input"_test = []() {
+    // Setup
+    recording_pwm forward;
+    recording_pwm reverse;
+    auto motor =
+      h_bridge_motor::create(forward, reverse, { .brake = true }).value();
+
+    // Exercise
+    (void)motor.power(0.5f);
+    (void)motor.power(0.75f);
+    (void)motor.power(-1.5f);
+    (void)motor.power(0.0f);
+
+    // Verify
+    expect(that % 20'000.0f == reverse.frequency_set);
+    expect(std::vector<float>{ 0.0f, 1.0f, 0.0f, 0.5f, 0.75f, 0.0f, 0.0f,
+                               1.0f } == forward.duty_cycles);
+    expect(std::vector<float>{ 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f } ==
+           reverse.duty_cycles);
+  };
+
+  "h_bridge_motor drives a locked-antiphase bridge"_test = []() {
+    // Setup
+    recording_pwm pwm;
+    recording_output_pin enable;
+    auto motor = h_bridge_motor::create(pwm, enable, {}).value();
+
+    // Exercise
+    (void)motor.power(0.5f);
+    (void)motor.power(-0.5f);
+    (void)motor.power(0.0f);
+
+    // Verify
+    expect(std::vector<float>{ 0.5f, 0.75f, 0.25f, 0.5f } == pwm.duty_cycles);
+    expect(std::vector<bool>{ false, true, false } == enable.levels);
+  };
+
+  "slew_limited_motor ramps towards the target"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_motor inner;
+    auto motor = slew_limited_motor::create(
+                   inner, timer, { .rate = 2.0f, .period = 125ms })
+                   .value();
+
+    // Exercise
+    (void)motor.power(0.75f);
+    time.advance(1s);
+    const auto rising = inner.powers;
+    inner.powers.clear();
+    (void)motor.power(-0.5f);
+    time.advance(200ms);
+    // Retarget mid ramp
+    (void)motor.power(0.5f);
+    time.advance(1s);
+
+    // Verify
+    expect(std::vector<float>{ 0.25f, 0.5f, 0.75f } == rising);
+    expect(std::vector<float>{ 0.5f, 0.25f, 0.5f } == inner.powers);
+    expect(that % 0.5f == motor.output());
+    expect(that % 0U == time.pending());
+  };
+
+  "slew_limited_motor stops ramping when destroyed"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_motor inner;
+
+    // Exercise
+    {
+      auto created = slew_limited_motor::create(
+                       inner, timer, { .rate = 2.0f, .period = 125ms })
+                       .value();
+      auto motor = std::move(created);
+      (void)motor.power(1.0f);
+      time.advance(200ms);
+    }
+    time.advance(1s);
+
+    // Verify
+    expect(std::vector<float>{ 0.25f, 0.5f } == inner.powers);
+    expect(that % 0U == time.pending());
+  };
+
+  "slew_limited_motor rejects invalid settings"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_motor inner;
+
+    // Exercise
+    auto rate = slew_limited_motor::create(inner, timer, { .rate = 0.0f });
+    auto period = slew_limited_motor::create(inner, timer, { .period = 0ms });
+
+    // Verify
+    expect(!bool{ rate });
+    expect(!bool{ period });
+  };
+};
+}  // namespace hal::soft
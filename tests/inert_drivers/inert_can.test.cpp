@@ -0,0 +1,99 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/inert_drivers/inert_can.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void inert_can_test()
+{
+  using namespace boost::ut;
+  "inert_can"_test = []() {
+    // Setup
+    constexpr hal::can::settings settings{
+      .baud_rate = 1.0_Hz,
+    };
+    constexpr hal::can::message_t message{ .id = 1, .length = 0 };
+    auto test = inert_can::create(true).value();
+    auto test2 = inert_can::create(false).value();
+
+    // Exercise
+    auto configure_result = test.configure(settings);
+    auto send_result = test.send(message);
+    auto bus_on_result = test.bus_on();
+    auto bus_off_result = test2.bus_on();
+
+    // Verify
+    expect(bool{ configure_result });
+    expect(bool{ send_result });
+    expect(bool{ bus_on_result });
+    expect(!bool{ bus_off_result });
+  };
+
+  "inert_can loopback"_test = []() {
+    // Setup
+    constexpr hal::can::message_t message{
+      .id = 0x111, .payload = { 0xAA, 0xBB }, .length = 2
+    };
+    hal::can::message_t received{};
+    int receive_count = 0;
+    auto test = inert_can::create_loopback().value();
+    test.on_receive([&](const hal::can::message_t& p_message) {
+      received = p_message;
+      receive_count++;
+    });
+
+    // Exercise
+    auto send_result = test.send(message);
+
+    // Verify
+    expect(bool{ send_result });
+    expect(that % 1 == receive_count);
+    expect(that % message.id == received.id);
+    expect(that % message.length == received.length);
+    expect(message.payload == received.payload);
+  };
+
+  "inert_can replay"_test = []() {
+    // Setup
+    constexpr hal::can::message_t request{ .id = 0x7DF, .length = 0 };
+    constexpr std::array<hal::can::message_t, 2> script{
+      hal::can::message_t{ .id = 0x7E8, .length = 1 },
+      hal::can::message_t{ .id = 0x7E9, .length = 2 },
+    };
+    hal::can::message_t received{};
+    int receive_count = 0;
+    auto test = inert_can::create_replay(script).value();
+    test.on_receive([&](const hal::can::message_t& p_message) {
+      received = p_message;
+      receive_count++;
+    });
+
+    // Exercise
+    auto send_result1 = test.send(request);
+    auto first = received;
+    auto send_result2 = test.send(request);
+    auto send_result3 = test.send(request);
+
+    // Verify
+    expect(bool{ send_result1 });
+    expect(bool{ send_result2 });
+    expect(bool{ send_result3 });
+    expect(that % 2 == receive_count);
+    expect(that % 0x7E8U == first.id);
+    expect(that % 0x7E9U == received.id);
+  };
+};
+}  // namespace hal::soft
@@ -0,0 +1,92 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/inert_drivers/inert_i2c.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void inert_i2c_test()
+{
+  using namespace boost::ut;
+  "inert_i2c"_test = []() {
+    // Setup
+    constexpr hal::i2c::settings configure_settings{ .clock_rate = 1.0_Hz };
+    constexpr hal::byte address{ 100 };
+    constexpr std::array<hal::byte, 4> data_out{ 'a', 'b' };
+    std::array<hal::byte, 4> data_in{ '1', '2' };
+    const hal::function_ref<hal::timeout_function> timeout = []() {
+      return success();
+    };
+    auto test = inert_i2c::create().value();
+
+    // Exercise
+    auto configure_result = test.configure(configure_settings);
+    auto transaction_result =
+      test.transaction(address, data_out, data_in, timeout);
+
+    // Verify
+    expect(bool{ configure_result });
+    expect(bool{ transaction_result });
+  };
+
+  "inert_i2c loopback"_test = []() {
+    // Setup
+    constexpr hal::byte address{ 100 };
+    constexpr std::array<hal::byte, 2> data_out{ 'a', 'b' };
+    std::array<hal::byte, 3> data_in{};
+    std::array<hal::byte, 4> memory{};
+    const hal::function_ref<hal::timeout_function> timeout = []() {
+      return success();
+    };
+    auto test = inert_i2c::create_loopback(memory).value();
+
+    // Exercise
+    auto write_result = test.transaction(address, data_out, {}, timeout);
+    auto read_result = test.transaction(address, {}, data_in, timeout);
+
+    // Verify
+    expect(bool{ write_result });
+    expect(bool{ read_result });
+    expect(that % 'a' == data_in[0]);
+    expect(that % 'b' == data_in[1]);
+    expect(that % inert_i2c::idle_byte == data_in[2]);
+  };
+
+  "inert_i2c replay"_test = []() {
+    // Setup
+    constexpr hal::byte address{ 100 };
+    constexpr std::array<hal::byte, 1> data_out{ 0x0F };
+    constexpr std::array<hal::byte, 3> script{ '1', '2', '3' };
+    std::array<hal::byte, 2> data_in{};
+    const hal::function_ref<hal::timeout_function> timeout = []() {
+      return success();
+    };
+    auto test = inert_i2c::create_replay(script).value();
+
+    // Exercise
+    auto result1 = test.transaction(address, data_out, data_in, timeout);
+    auto first = data_in;
+    auto result2 = test.transaction(address, data_out, data_in, timeout);
+
+    // Verify
+    expect(bool{ result1 });
+    expect(bool{ result2 });
+    expect(that % '1' == first[0]);
+    expect(that % '2' == first[1]);
+    expect(that % '3' == data_in[0]);
+    expect(that % inert_i2c::idle_byte == data_in[1]);
+  };
+};
+}  // namespace hal::soft
@@ -0,0 +1,115 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/inert_drivers/inert_serial.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void inert_serial_test()
+{
+  using namespace boost::ut;
+  "inert_serial"_test = []() {
+    // Setup
+    std::array<hal::byte, 4> buffer;
+    constexpr auto write_data = serial::write_t{};
+    constexpr auto read_data = serial::read_t{};
+    constexpr auto configure_settings = serial::settings{};
+    auto test = inert_serial::create(write_data, read_data).value();
+
+    // Exercise
+    auto configure_result = test.configure(configure_settings);
+    auto write_result = test.write(buffer);
+    auto read_result = test.read(buffer);
+    auto flush_result = test.flush();
+
+    // Verify
+    expect(bool{ configure_result });
+    expect(bool{ write_result });
+    expect(bool{ read_result });
+    expect(bool{ flush_result });
+  };
+
+  "inert_serial loopback"_test = []() {
+    // Setup
+    std::array<hal::byte, 4> storage{};
+    std::array<hal::byte, 3> first{ 'a', 'b', 'c' };
+    std::array<hal::byte, 3> second{ 'd', 'e', 'f' };
+    std::array<hal::byte, 4> buffer{};
+    auto test = inert_serial::create_loopback(storage).value();
+
+    // Exercise
+    auto write_result1 = test.write(first);
+    auto read_result1 = test.read(std::span(buffer).first(2));
+    auto write_result2 = test.write(second);
+    auto read_result2 = test.read(buffer);
+    auto read_result3 = test.read(buffer);
+
+    // Verify
+    expect(bool{ write_result1 });
+    expect(bool{ write_result2 });
+    expect(that % 2U == read_result1.value().data.size());
+    expect(that % 1U == read_result1.value().available);
+    expect(that % 4U == read_result1.value().capacity);
+    expect(that % 4U == read_result2.value().data.size());
+    expect(that % 0U == read_result2.value().available);
+    expect(that % 'c' == buffer[0]);
+    expect(that % 'd' == buffer[1]);
+    expect(that % 'e' == buffer[2]);
+    expect(that % 'f' == buffer[3]);
+    expect(that % 0U == read_result3.value().data.size());
+  };
+
+  "inert_serial loopback overrun"_test = []() {
+    // Setup
+    std::array<hal::byte, 2> storage{};
+    std::array<hal::byte, 3> data{ 'a', 'b', 'c' };
+    std::array<hal::byte, 4> buffer{};
+    auto test = inert_serial::create_loopback(storage).value();
+
+    // Exercise
+    auto write_result = test.write(data);
+    auto read_result = test.read(buffer);
+
+    // Verify
+    expect(that % 3U == write_result.value().data.size());
+    expect(that % 2U == read_result.value().data.size());
+    expect(that % 'a' == buffer[0]);
+    expect(that % 'b' == buffer[1]);
+  };
+
+  "inert_serial replay"_test = []() {
+    // Setup
+    constexpr std::array<hal::byte, 5> script{ '1', '2', '3', '4', '5' };
+    std::array<hal::byte, 3> buffer{};
+    auto test = inert_serial::create_replay(script).value();
+
+    // Exercise
+    auto read_result1 = test.read(buffer);
+    auto first = buffer;
+    auto read_result2 = test.read(buffer);
+    auto read_result3 = test.read(buffer);
+
+    // Verify
+    expect(that % 3U == read_result1.value().data.size());
+    expect(that % 2U == read_result1.value().available);
+    expect(that % '1' == first[0]);
+    expect(that % '3' == first[2]);
+    expect(that % 2U == read_result2.value().data.size());
+    expect(that % '4' == buffer[0]);
+    expect(that % '5' == buffer[1]);
+    expect(that % 0U == read_result3.value().data.size());
+  };
+};
+}  // namespace hal::soft
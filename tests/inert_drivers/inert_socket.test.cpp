@@ -0,0 +1,82 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/inert_drivers/inert_socket.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void inert_socket_test()
+{
+  using namespace boost::ut;
+  "inert_socket"_test = []() {
+    // Setup
+    hal::function_ref<timeout_function> always_succeed = []() -> hal::status {
+      return hal::success();
+    };
+    std::array<hal::byte, 4> buffer;
+    auto write_data = socket::write_t{};
+    auto read_data = socket::read_t{};
+    auto test = inert_socket::create(write_data, read_data).value();
+
+    // Exercise
+    auto write_result = test.write(buffer, always_succeed);
+    auto read_result = test.read(buffer);
+
+    // Verify
+    expect(bool{ write_result });
+    expect(bool{ read_result });
+  };
+
+  "inert_socket loopback"_test = []() {
+    // Setup
+    hal::function_ref<timeout_function> always_succeed = []() -> hal::status {
+      return hal::success();
+    };
+    std::array<hal::byte, 4> storage{};
+    std::array<hal::byte, 3> data{ 'a', 'b', 'c' };
+    std::array<hal::byte, 4> buffer{};
+    auto test = inert_socket::create_loopback(storage).value();
+
+    // Exercise
+    auto write_result1 = test.write(data, always_succeed);
+    auto write_result2 = test.write(data, always_succeed);
+    auto read_result = test.read(buffer);
+
+    // Verify
+    expect(that % 3U == write_result1.value().data.size());
+    expect(that % 1U == write_result2.value().data.size());
+    expect(that % 4U == read_result.value().data.size());
+    expect(that % 'a' == buffer[0]);
+    expect(that % 'c' == buffer[2]);
+    expect(that % 'a' == buffer[3]);
+  };
+
+  "inert_socket replay"_test = []() {
+    // Setup
+    constexpr std::array<hal::byte, 3> script{ '1', '2', '3' };
+    std::array<hal::byte, 2> buffer{};
+    auto test = inert_socket::create_replay(script).value();
+
+    // Exercise
+    auto read_result1 = test.read(buffer);
+    auto read_result2 = test.read(buffer);
+
+    // Verify
+    expect(that % 2U == read_result1.value().data.size());
+    expect(that % 1U == read_result2.value().data.size());
+    expect(that % '3' == buffer[0]);
+  };
+};
+}  // namespace hal::soft
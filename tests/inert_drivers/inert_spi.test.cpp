@@ -36,5 +36,41 @@ void inert_spi_test()
     expect(bool{ configure_result });
     expect(bool{ transfer_result });
   };
+
+  "inert_spi loopback"_test = []() {
+    // Setup
+    const std::array<hal::byte, 2> data_out{ 'a', 'b' };
+    std::array<hal::byte, 3> data_in{};
+    auto test = inert_spi::create_loopback().value();
+
+    // Exercise
+    auto transfer_result = test.transfer(data_out, data_in, ' ');
+
+    // Verify
+    expect(bool{ transfer_result });
+    expect(that % 'a' == data_in[0]);
+    expect(that % 'b' == data_in[1]);
+    expect(that % ' ' == data_in[2]);
+  };
+
+  "inert_spi replay"_test = []() {
+    // Setup
+    constexpr std::array<hal::byte, 3> script{ '1', '2', '3' };
+    std::array<hal::byte, 2> data_in{};
+    auto test = inert_spi::create_replay(script).value();
+
+    // Exercise
+    auto transfer_result1 = test.transfer({}, data_in, ' ');
+    auto first = data_in;
+    auto transfer_result2 = test.transfer({}, data_in, ' ');
+
+    // Verify
+    expect(bool{ transfer_result1 });
+    expect(bool{ transfer_result2 });
+    expect(that % '1' == first[0]);
+    expect(that % '2' == first[1]);
+    expect(that % '3' == data_in[0]);
+    expect(that % ' ' == data_in[1]);
+  };
 };
 }  // namespace hal::soft
@@ -0,0 +1,101 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/input_port.hpp>
+
+#include <queue>
+
+#include <libhal-mock/input_pin.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void input_port_test()
+{
+  using namespace boost::ut;
+
+  "input_port packs pin levels into a word"_test = []() {
+    // Setup
+    std::array<hal::mock::input_pin, 4> pins;
+    const std::array<bool, 4> levels{ true, false, true, true };
+    for (std::size_t i = 0; i < pins.size(); i++) {
+      std::queue<hal::input_pin::level_t> queue;
+      queue.push({ .state = levels[i] });
+      queue.push({ .state = levels[i] });
+      pins[i].set(queue);
+    }
+    auto port =
+      input_port<4>::create({ &pins[0], &pins[1], &pins[2], &pins[3] })
+        .value();
+
+    // Exercise
+    auto plain = port.read();
+    port.inverted(0b1001);
+    auto inverted = port.read();
+
+    // Verify
+    expect(bool{ plain });
+    expect(that % 0b1101U == plain.value());
+    expect(bool{ inverted });
+    expect(that % 0b0100U == inverted.value());
+    expect(that % 0b1001U == port.inverted());
+  };
+
+  "input_port reports pin errors"_test = []() {
+    // Setup
+    std::array<hal::mock::input_pin, 2> pins;
+    std::queue<hal::input_pin::level_t> queue;
+    queue.push({ .state = true });
+    pins[0].set(queue);
+    auto port = input_port<2>::create({ &pins[0], &pins[1] }).value();
+
+    // Exercise
+    auto result = port.read();
+
+    // Verify
+    expect(!bool{ result });
+  };
+
+  "input_port bulk read applies the inversion mask"_test = []() {
+    // Setup
+    std::uint32_t raw = 0xFFFF'00F0;
+    auto port = input_port<16>::create(
+                  [&raw]() -> result<std::uint32_t> { return raw; }, 0x00FF)
+                  .value();
+
+    // Exercise
+    auto first = port.read();
+    raw = 0x0000'FF0F;
+    auto second = port.read();
+
+    // Verify
+    expect(that % 0x000FU == first.value());
+    expect(that % 0xFFF0U == second.value());
+  };
+
+  "input_port rejects missing pins"_test = []() {
+    // Setup
+    hal::mock::input_pin pin;
+
+    // Exercise
+    auto missing_pin = input_port<2>::create({ nullptr, &pin });
+    auto missing_read =
+      input_port<2>::create(hal::callback<input_port<2>::bulk_read>{});
+
+    // Verify
+    expect(!bool{ missing_pin });
+    expect(!bool{ missing_read });
+  };
+};
+}  // namespace hal::soft
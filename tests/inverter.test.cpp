@@ -99,6 +99,35 @@ void output_pin_iverter_test()
       expect(that % false == level_result.value().state);
     };
   };
+  "hal::static_output_pin_inverter"_test = []() {
+    // Setup
+    hal::mock::output_pin mock_output_pin;
+    static_output_pin_inverter inverted_output_pin(mock_output_pin);
+    hal::output_pin& polymorphic = inverted_output_pin;
+    hal::output_pin::settings expected_settings;
+    expected_settings.open_drain = true;
+
+    // Exercise
+    auto configure_result = inverted_output_pin.configure(expected_settings);
+    auto direct_result = inverted_output_pin.level(true);
+    auto direct_level = inverted_output_pin.level();
+    auto virtual_result = polymorphic.level(false);
+    auto virtual_level = polymorphic.level();
+    const auto& history = mock_output_pin.spy_level.call_history();
+    auto result_settings =
+      std::get<0>(mock_output_pin.spy_configure.call_history().at(0));
+
+    // Verify
+    expect(bool{ configure_result });
+    expect(true == result_settings.open_drain);
+    expect(bool{ direct_result });
+    expect(bool{ virtual_result });
+    expect(that % 2U == history.size());
+    expect(that % false == std::get<0>(history.at(0)).state);
+    expect(that % true == std::get<0>(history.at(1)).state);
+    expect(that % true == direct_level.value().state);
+    expect(that % false == virtual_level.value().state);
+  };
 }
 
 void input_pin_iverter_test()
@@ -163,5 +192,29 @@ void input_pin_iverter_test()
       expect(that % true == result2.value().state);
     };
   };
+  "hal::static_input_pin_inverter"_test = []() {
+    // Setup
+    hal::mock::input_pin mock_input_pin;
+    static_input_pin_inverter inverted_input_pin(mock_input_pin);
+    hal::input_pin& polymorphic = inverted_input_pin;
+    std::deque inputs{
+      input_pin::level_t{ .state = true },
+      input_pin::level_t{ .state = false },
+    };
+    std::queue queue(inputs);
+    mock_input_pin.set(queue);
+
+    // Exercise
+    auto direct = inverted_input_pin.level();
+    auto through_interface = polymorphic.level();
+    auto exhausted = inverted_input_pin.level();
+
+    // Verify
+    expect(bool{ direct });
+    expect(bool{ through_interface });
+    expect(that % false == direct.value().state);
+    expect(that % true == through_interface.value().state);
+    expect(!bool{ exhausted });
+  };
 }
 }  // namespace hal::soft
@@ -0,0 +1,442 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/isotp.hpp>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <libhal-soft/can_router.hpp>
+#include <libhal-soft/inert_drivers/inert_can.hpp>
+
+#include <boost/ut.hpp>
+
+namespace {
+/// Timer whose scheduled callback is run by the test
+struct manual_timer : public hal::timer
+{
+  /// Run the scheduled callback, if there is one
+  bool run()
+  {
+    if (!scheduled) {
+      return false;
+    }
+    scheduled = false;
+    callback();
+    return true;
+  }
+
+  hal::callback<void(void)> callback;
+  hal::time_duration delay{};
+  bool scheduled = false;
+
+private:
+  hal::result<is_running_t> driver_is_running() final
+  {
+    return is_running_t{ .is_running = scheduled };
+  }
+
+  hal::result<cancel_t> driver_cancel() final
+  {
+    scheduled = false;
+    return cancel_t{};
+  }
+
+  hal::result<schedule_t> driver_schedule(hal::callback<void(void)> p_callback,
+                                          hal::time_duration p_delay) final
+  {
+    callback = p_callback;
+    delay = p_delay;
+    scheduled = true;
+    return schedule_t{};
+  }
+};
+
+/// CAN bus that records sent messages without delivering them
+struct recording_can : public hal::can
+{
+  std::vector<hal::can::message_t> sent{};
+
+private:
+  hal::status driver_configure(const settings&) final
+  {
+    return hal::success();
+  }
+
+  hal::status driver_bus_on() final
+  {
+    return hal::success();
+  }
+
+  hal::result<send_t> driver_send(const message_t& p_message) final
+  {
+    sent.push_back(p_message);
+    return send_t{};
+  }
+
+  void driver_on_receive(hal::callback<handler>) final
+  {
+  }
+};
+
+constexpr hal::can::id_t tester_id = 0x7E0;
+constexpr hal::can::id_t ecu_id = 0x7E8;
+
+template<std::size_t Size>
+std::array<hal::byte, Size> make_payload()
+{
+  std::array<hal::byte, Size> payload{};
+  for (std::size_t i = 0; i < payload.size(); i++) {
+    payload[i] = static_cast<hal::byte>(i * 7 + 3);
+  }
+  return payload;
+}
+}  // namespace
+
+namespace hal::soft {
+void isotp_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "isotp single frame"_test = []() {
+    // Setup
+    auto bus = inert_can::create_loopback().value();
+    auto router = can_router<2>::create(bus).value();
+    manual_timer timer;
+    std::array<hal::byte, 16> tester_buffer{};
+    std::array<hal::byte, 16> ecu_buffer{};
+    auto tester = isotp_session::create(
+                    bus,
+                    timer,
+                    tester_buffer,
+                    { .transmit_id = tester_id, .receive_id = ecu_id })
+                    .value();
+    auto ecu = isotp_session::create(
+                 bus,
+                 timer,
+                 ecu_buffer,
+                 { .transmit_id = ecu_id, .receive_id = tester_id })
+                 .value();
+    (void)router.add_route(
+      ecu_id, [&tester](const hal::can::message_t& p_m) { tester(p_m); });
+    (void)router.add_route(
+      tester_id, [&ecu](const hal::can::message_t& p_m) { ecu(p_m); });
+    std::vector<hal::byte> received;
+    ecu.on_receive([&received](std::span<const hal::byte> p_payload) {
+      received.assign(p_payload.begin(), p_payload.end());
+    });
+    constexpr std::array<hal::byte, 3> payload{ 0x22, 0xF1, 0x90 };
+
+    // Exercise
+    auto result = tester.send(payload);
+
+    // Verify
+    expect(bool{ result });
+    expect(!tester.transmitting());
+    expect(std::equal(
+      payload.begin(), payload.end(), received.begin(), received.end()));
+  };
+
+  "isotp multi frame with blocks"_test = []() {
+    // Setup
+    auto bus = inert_can::create_loopback().value();
+    auto router = can_router<2>::create(bus).value();
+    manual_timer timer;
+    std::array<hal::byte, 16> tester_buffer{};
+    std::array<hal::byte, 128> ecu_buffer{};
+    auto tester = isotp_session::create(
+                    bus,
+                    timer,
+                    tester_buffer,
+                    { .transmit_id = tester_id, .receive_id = ecu_id })
+                    .value();
+    auto ecu = isotp_session::create(bus,
+                                     timer,
+                                     ecu_buffer,
+                                     { .transmit_id = ecu_id,
+                                       .receive_id = tester_id,
+                                       .block_size = 4 })
+                 .value();
+    (void)router.add_route(
+      ecu_id, [&tester](const hal::can::message_t& p_m) { tester(p_m); });
+    (void)router.add_route(
+      tester_id, [&ecu](const hal::can::message_t& p_m) { ecu(p_m); });
+    std::span<const hal::byte> received;
+    int receive_count = 0;
+    ecu.on_receive([&](std::span<const hal::byte> p_payload) {
+      received = p_payload;
+      receive_count++;
+    });
+    const auto payload = make_payload<100>();
+
+    // Exercise
+    auto result = tester.send(payload);
+
+    // Verify
+    expect(bool{ result });
+    expect(!tester.transmitting());
+    expect(that % 1 == receive_count);
+    expect(received.data() == ecu_buffer.data());
+    expect(std::equal(
+      payload.begin(), payload.end(), received.begin(), received.end()));
+    expect(that % 0U == ecu.aborted_transfers());
+  };
+
+  "isotp escaped first frame length"_test = []() {
+    // Setup
+    auto bus = inert_can::create_loopback().value();
+    auto router = can_router<2>::create(bus).value();
+    manual_timer timer;
+    std::array<hal::byte, 16> tester_buffer{};
+    std::vector<hal::byte> ecu_buffer(5000);
+    auto tester = isotp_session::create(
+                    bus,
+                    timer,
+                    tester_buffer,
+                    { .transmit_id = tester_id, .receive_id = ecu_id })
+                    .value();
+    auto ecu = isotp_session::create(
+                 bus,
+                 timer,
+                 ecu_buffer,
+                 { .transmit_id = ecu_id, .receive_id = tester_id })
+                 .value();
+    (void)router.add_route(
+      ecu_id, [&tester](const hal::can::message_t& p_m) { tester(p_m); });
+    (void)router.add_route(
+      tester_id, [&ecu](const hal::can::message_t& p_m) { ecu(p_m); });
+    std::size_t received_size = 0;
+    ecu.on_receive([&](std::span<const hal::byte> p_payload) {
+      received_size = p_payload.size();
+    });
+    const auto payload = make_payload<5000>();
+
+    // Exercise
+    auto result = tester.send(payload);
+
+    // Verify
+    expect(bool{ result });
+    expect(that % 5000U == received_size);
+    expect(std::equal(payload.begin(), payload.end(), ecu_buffer.begin()));
+  };
+
+  "isotp separation time and flow control"_test = []() {
+    // Setup
+    recording_can bus;
+    manual_timer timer;
+    std::array<hal::byte, 16> buffer{};
+    auto tester = isotp_session::create(
+                    bus,
+                    timer,
+                    buffer,
+                    { .transmit_id = tester_id, .receive_id = ecu_id })
+                    .value();
+    const auto payload = make_payload<30>();
+    constexpr hal::can::message_t wait_frame{
+      .id = ecu_id, .payload = { 0x31, 0x00, 0x00 }, .length = 3
+    };
+    constexpr hal::can::message_t continue_frame{
+      .id = ecu_id, .payload = { 0x30, 0x02, 0xF5 }, .length = 3
+    };
+
+    // Exercise
+    auto result = tester.send(payload);
+    auto busy_result = tester.send(payload);
+    tester(wait_frame);
+    const auto sent_after_wait = bus.sent.size();
+    tester(continue_frame);
+    const auto sent_after_continue = bus.sent.size();
+    const auto first_delay = timer.delay;
+    timer.run();
+    const auto delay_after_block = timer.delay;
+    const bool waiting_after_block = tester.transmitting();
+    tester(continue_frame);
+    const auto sent_after_second_continue = bus.sent.size();
+    timer.run();
+
+    // Verify
+    expect(bool{ result });
+    expect(!bool{ busy_result });
+    expect(that % 1U == sent_after_wait);
+    expect(that % 2U == sent_after_continue);
+    expect(that % 500us == first_delay);
+    expect(that % 1000ms == delay_after_block);
+    expect(waiting_after_block);
+    expect(that % 4U == sent_after_second_continue);
+    expect(!tester.transmitting());
+    expect(that % 5U == bus.sent.size());
+    expect(that % 0x10 == bus.sent[0].payload[0]);
+    expect(that % 30 == bus.sent[0].payload[1]);
+    expect(that % 0x21 == bus.sent[1].payload[0]);
+    expect(that % 0x22 == bus.sent[2].payload[0]);
+    expect(that % 0x23 == bus.sent[3].payload[0]);
+    expect(that % 0x24 == bus.sent[4].payload[0]);
+    expect(that % payload[29] == bus.sent[4].payload[3]);
+    expect(that % 0xCC == bus.sent[4].payload[4]);
+  };
+
+  "isotp receiver overflow"_test = []() {
+    // Setup
+    auto bus = inert_can::create_loopback().value();
+    auto router = can_router<2>::create(bus).value();
+    manual_timer timer;
+    std::array<hal::byte, 16> tester_buffer{};
+    std::array<hal::byte, 16> ecu_buffer{};
+    auto tester = isotp_session::create(
+                    bus,
+                    timer,
+                    tester_buffer,
+                    { .transmit_id = tester_id, .receive_id = ecu_id })
+                    .value();
+    auto ecu = isotp_session::create(
+                 bus,
+                 timer,
+                 ecu_buffer,
+                 { .transmit_id = ecu_id, .receive_id = tester_id })
+                 .value();
+    (void)router.add_route(
+      ecu_id, [&tester](const hal::can::message_t& p_m) { tester(p_m); });
+    (void)router.add_route(
+      tester_id, [&ecu](const hal::can::message_t& p_m) { ecu(p_m); });
+    const auto payload = make_payload<32>();
+
+    // Exercise
+    auto result = tester.send(payload);
+
+    // Verify
+    expect(bool{ result });
+    expect(!tester.transmitting());
+    expect(that % 1U == tester.aborted_transfers());
+  };
+
+  "isotp times out a silent receiver"_test = []() {
+    // Setup
+    recording_can bus;
+    manual_timer timer;
+    std::array<hal::byte, 16> buffer{};
+    auto tester = isotp_session::create(bus,
+                                        timer,
+                                        buffer,
+                                        { .transmit_id = tester_id,
+                                          .receive_id = ecu_id,
+                                          .flow_control_timeout = 250ms })
+                    .value();
+    const auto payload = make_payload<20>();
+
+    // Exercise
+    auto result = tester.send(payload);
+    const auto timeout = timer.delay;
+    const bool waiting = tester.transmitting();
+    timer.run();
+    const bool timed_out = !tester.transmitting();
+    auto retry = tester.send(payload);
+
+    // Verify
+    expect(bool{ result });
+    expect(that % 250ms == timeout);
+    expect(waiting);
+    expect(timed_out);
+    expect(bool{ retry });
+    expect(that % 1U == tester.aborted_transfers());
+  };
+
+  "isotp limits wait frames and can be aborted"_test = []() {
+    // Setup
+    recording_can bus;
+    manual_timer timer;
+    std::array<hal::byte, 16> buffer{};
+    auto tester = isotp_session::create(bus,
+                                        timer,
+                                        buffer,
+                                        { .transmit_id = tester_id,
+                                          .receive_id = ecu_id,
+                                          .max_wait_frames = 2 })
+                    .value();
+    const auto payload = make_payload<20>();
+    constexpr hal::can::message_t wait_frame{
+      .id = ecu_id, .payload = { 0x31, 0x00, 0x00 }, .length = 3
+    };
+
+    // Exercise
+    (void)tester.send(payload);
+    tester(wait_frame);
+    tester(wait_frame);
+    const bool waiting_after_two = tester.transmitting();
+    tester(wait_frame);
+    const bool aborted_after_three = !tester.transmitting();
+    (void)tester.send(payload);
+    tester.abort();
+    const bool timer_cancelled = !timer.scheduled;
+
+    // Verify
+    expect(waiting_after_two);
+    expect(aborted_after_three);
+    expect(!tester.transmitting());
+    expect(timer_cancelled);
+    expect(that % 2U == tester.aborted_transfers());
+  };
+
+  "isotp ignores first frames that are not 8 bytes long"_test = []() {
+    // Setup
+    recording_can bus;
+    manual_timer timer;
+    std::array<hal::byte, 64> buffer{};
+    auto ecu = isotp_session::create(
+                 bus,
+                 timer,
+                 buffer,
+                 { .transmit_id = ecu_id, .receive_id = tester_id })
+                 .value();
+    constexpr hal::can::message_t oversized{
+      .id = tester_id, .payload = { 0x10, 0x20 }, .length = 64
+    };
+    constexpr hal::can::message_t truncated{
+      .id = tester_id, .payload = { 0x10, 0x20 }, .length = 2
+    };
+
+    // Exercise
+    ecu(oversized);
+    ecu(truncated);
+
+    // Verify
+    expect(that % 0U == bus.sent.size());
+  };
+
+  "isotp cancels its timer when destroyed"_test = []() {
+    // Setup
+    recording_can bus;
+    manual_timer timer;
+    std::array<hal::byte, 16> buffer{};
+    const auto payload = make_payload<20>();
+
+    // Exercise
+    {
+      auto created = isotp_session::create(
+                       bus,
+                       timer,
+                       buffer,
+                       { .transmit_id = tester_id, .receive_id = ecu_id })
+                       .value();
+      auto tester = std::move(created);
+      (void)tester.send(payload);
+    }
+
+    // Verify
+    expect(that % 1U == bus.sent.size());
+    expect(!timer.scheduled);
+  };
+}
+}  // namespace hal::soft
@@ -18,18 +18,47 @@ extern void minimum_speed_test();
 extern void rc_servo_test();
 extern void output_pin_iverter_test();
 extern void input_pin_iverter_test();
+extern void buffered_serial_test();
+extern void framing_test();
+extern void serial_mux_test();
+extern void soft_uart_test();
+extern void can_router_test();
+extern void can_tx_queue_test();
+extern void isotp_test();
+extern void simulated_can_test();
+extern void timer_wheel_test();
+extern void simulated_time_test();
+extern void fast_clock_test();
+extern void profiling_test();
+extern void trace_ring_test();
+extern void traced_test();
+extern void replay_test();
+extern void output_port_test();
+extern void input_port_test();
+extern void debounced_input_pin_test();
+extern void polled_interrupt_pin_test();
+extern void quadrature_encoder_test();
+extern void frequency_counter_test();
+extern void pwm_dac_test();
+extern void waveform_generator_test();
+extern void h_bridge_motor_test();
 
 extern void inert_accelerometer_test();
 extern void inert_adc_test();
+extern void inert_can_test();
 extern void inert_dac_test();
 extern void inert_distance_sensor_test();
 extern void inert_gyroscope_test();
+extern void inert_i2c_test();
 extern void inert_input_pin_test();
 extern void inert_interrupt_pin_test();
 extern void inert_magnetometer_test();
 extern void inert_motor_test();
 extern void inert_pwm_test();
 extern void inert_rotation_sensor_test();
+extern void inert_serial_test();
+extern void inert_socket_test();
+extern void inert_spi_test();
 extern void inert_steady_clock_test();
 extern void inert_temperature_sensor_test();
 extern void inert_timer_test();
@@ -42,18 +71,47 @@ int main()
   hal::soft::rc_servo_test();
   hal::soft::output_pin_iverter_test();
   hal::soft::input_pin_iverter_test();
+  hal::soft::buffered_serial_test();
+  hal::soft::framing_test();
+  hal::soft::serial_mux_test();
+  hal::soft::soft_uart_test();
+  hal::soft::can_router_test();
+  hal::soft::can_tx_queue_test();
+  hal::soft::isotp_test();
+  hal::soft::simulated_can_test();
+  hal::soft::timer_wheel_test();
+  hal::soft::simulated_time_test();
+  hal::soft::fast_clock_test();
+  hal::soft::profiling_test();
+  hal::soft::trace_ring_test();
+  hal::soft::traced_test();
+  hal::soft::replay_test();
+  hal::soft::output_port_test();
+  hal::soft::input_port_test();
+  hal::soft::debounced_input_pin_test();
+  hal::soft::polled_interrupt_pin_test();
+  hal::soft::quadrature_encoder_test();
+  hal::soft::frequency_counter_test();
+  hal::soft::pwm_dac_test();
+  hal::soft::waveform_generator_test();
+  hal::soft::h_bridge_motor_test();
 
   hal::soft::inert_accelerometer_test();
   hal::soft::inert_adc_test();
+  hal::soft::inert_can_test();
   hal::soft::inert_dac_test();
   hal::soft::inert_distance_sensor_test();
   hal::soft::inert_gyroscope_test();
+  hal::soft::inert_i2c_test();
   hal::soft::inert_input_pin_test();
   hal::soft::inert_interrupt_pin_test();
   hal::soft::inert_magnetometer_test();
   hal::soft::inert_motor_test();
   hal::soft::inert_pwm_test();
   hal::soft::inert_rotation_sensor_test();
+  hal::soft::inert_serial_test();
+  hal::soft::inert_socket_test();
+  hal::soft::inert_spi_test();
   hal::soft::inert_steady_clock_test();
   hal::soft::inert_temperature_sensor_test();
   hal::soft::inert_timer_test();
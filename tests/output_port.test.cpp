@@ -0,0 +1,158 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/output_port.hpp>
+
+#include <vector>
+
+#include <libhal-mock/output_pin.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void output_port_test()
+{
+  using namespace boost::ut;
+
+  "output_port only writes pins that change"_test = []() {
+    // Setup
+    std::array<hal::mock::output_pin, 4> pins;
+    auto port =
+      output_port<4>::create({ &pins[0], &pins[1], &pins[2], &pins[3] })
+        .value();
+    auto writes = [&pins]() {
+      std::size_t total = 0;
+      for (auto& pin : pins) {
+        total += pin.spy_level.call_history().size();
+      }
+      return total;
+    };
+
+    // Exercise
+    auto first = port.write(0b0101);
+    const auto first_writes = writes();
+    auto same = port.write(0b0101);
+    const auto same_writes = writes();
+    auto second = port.write(0b0110);
+    const auto second_writes = writes();
+
+    // Verify
+    expect(bool{ first });
+    expect(bool{ same });
+    expect(bool{ second });
+    expect(that % 4U == first_writes);
+    expect(that % 4U == same_writes);
+    expect(that % 6U == second_writes);
+    expect(that % 0b0110U == port.value());
+    expect(pins[1].level().value().state);
+    expect(pins[2].level().value().state);
+    expect(!pins[0].level().value().state);
+    expect(!pins[3].level().value().state);
+  };
+
+  "output_port masked writes leave other pins alone"_test = []() {
+    // Setup
+    std::array<hal::mock::output_pin, 3> pins;
+    auto port =
+      output_port<3>::create({ &pins[0], &pins[1], &pins[2] }).value();
+    (void)port.write(0b000);
+
+    // Exercise
+    auto result = port.write(0b111, 0b010);
+
+    // Verify
+    expect(bool{ result });
+    expect(that % 0b010U == port.value());
+    expect(that % 1U == pins[0].spy_level.call_history().size());
+    expect(that % 2U == pins[1].spy_level.call_history().size());
+    expect(that % 1U == pins[2].spy_level.call_history().size());
+  };
+
+  "output_port retries only the pins that failed"_test = []() {
+    // Setup
+    std::array<hal::mock::output_pin, 3> pins;
+    auto port =
+      output_port<3>::create({ &pins[0], &pins[1], &pins[2] }).value();
+    pins[1].spy_level.trigger_error_on_call(1);
+
+    // Exercise
+    auto failed = port.write(0b111);
+    auto retried = port.write(0b111);
+
+    // Verify
+    expect(!bool{ failed });
+    expect(bool{ retried });
+    expect(that % 1U == pins[0].spy_level.call_history().size());
+    expect(that % 2U == pins[1].spy_level.call_history().size());
+    expect(that % 1U == pins[2].spy_level.call_history().size());
+    expect(that % 0b111U == port.value());
+  };
+
+  "output_port invalidate rewrites every pin"_test = []() {
+    // Setup
+    std::array<hal::mock::output_pin, 2> pins;
+    auto port = output_port<2>::create({ &pins[0], &pins[1] }).value();
+    (void)port.write(0b11);
+
+    // Exercise
+    port.invalidate();
+    auto result = port.write(0b11);
+
+    // Verify
+    expect(bool{ result });
+    expect(that % 2U == pins[0].spy_level.call_history().size());
+    expect(that % 2U == pins[1].spy_level.call_history().size());
+  };
+
+  "output_port bulk write receives the changed pins"_test = []() {
+    // Setup
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> calls;
+    auto port = output_port<8>::create([&calls](std::uint32_t p_mask,
+                                                std::uint32_t p_value) {
+                  calls.emplace_back(p_mask, p_value);
+                  return hal::success();
+                }).value();
+
+    // Exercise
+    (void)port.write(0x0F);
+    (void)port.write(0x0F);
+    (void)port.write(0x1E);
+    (void)port.write(0x1FF);
+
+    // Verify
+    expect(that % 3U == calls.size());
+    expect(that % 0xFFU == calls[0].first);
+    expect(that % 0x0FU == calls[0].second);
+    expect(that % 0x11U == calls[1].first);
+    expect(that % 0x10U == calls[1].second);
+    expect(that % 0xE1U == calls[2].first);
+    expect(that % 0xE1U == calls[2].second);
+    expect(that % 0xFFU == port.value());
+  };
+
+  "output_port rejects missing pins"_test = []() {
+    // Setup
+    hal::mock::output_pin pin;
+
+    // Exercise
+    auto missing_pin = output_port<2>::create({ &pin, nullptr });
+    auto missing_write =
+      output_port<2>::create(hal::callback<output_port<2>::bulk_write>{});
+
+    // Verify
+    expect(!bool{ missing_pin });
+    expect(!bool{ missing_write });
+  };
+};
+}  // namespace hal::soft
@@ -0,0 +1,170 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/polled_interrupt_pin.hpp>
+
+#include <array>
+#include <vector>
+
+#include <libhal-soft/simulated_time.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+class settable_pin : public hal::input_pin
+{
+public:
+  bool state = false;
+  bool fail = false;
+  settings last_settings{};
+
+private:
+  status driver_configure(const settings& p_settings) override
+  {
+    last_settings = p_settings;
+    return hal::success();
+  }
+
+  result<level_t> driver_level() override
+  {
+    if (fail) {
+      return hal::new_error(std::errc::io_error);
+    }
+    return level_t{ .state = state };
+  }
+};
+}  // namespace
+
+void polled_interrupt_pin_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "polled_interrupt_pin fires on configured edges only"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    auto poller = pin_poller::create(timer, 1ms).value();
+    std::array<settable_pin, 3> pins;
+    auto rising = polled_interrupt_pin::create(poller, pins[0]).value();
+    auto falling = polled_interrupt_pin::create(poller, pins[1]).value();
+    auto both = polled_interrupt_pin::create(poller, pins[2]).value();
+    std::vector<std::pair<int, bool>> events;
+    auto record = [&events](int p_id) {
+      return [&events, p_id](bool p_level) {
+        events.emplace_back(p_id, p_level);
+      };
+    };
+    using edge = hal::interrupt_pin::trigger_edge;
+    (void)rising.configure({ .trigger = edge::rising });
+    (void)falling.configure(
+      { .resistor = pin_resistor::none, .trigger = edge::falling });
+    (void)both.configure({ .trigger = edge::both });
+    rising.on_trigger(record(0));
+    falling.on_trigger(record(1));
+    both.on_trigger(record(2));
+
+    // Exercise
+    for (auto& pin : pins) {
+      pin.state = true;
+    }
+    time.advance(1ms);
+    const auto after_rise = events;
+    for (auto& pin : pins) {
+      pin.state = false;
+    }
+    time.advance(1ms);
+    time.advance(5ms);
+
+    // Verify
+    expect(that % 2U == after_rise.size());
+    expect(that % 4U == events.size());
+    expect(events[0] == std::pair{ 0, true });
+    expect(events[1] == std::pair{ 2, true });
+    expect(events[2] == std::pair{ 1, false });
+    expect(events[3] == std::pair{ 2, false });
+    expect(pin_resistor::none == pins[1].last_settings.resistor);
+    expect(pin_resistor::pull_up == pins[0].last_settings.resistor);
+  };
+
+  "polled_interrupt_pin does not report the initial level"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    auto poller = pin_poller::create(timer, 1ms).value();
+    settable_pin pin;
+    pin.state = true;
+    auto interrupt = polled_interrupt_pin::create(poller, pin).value();
+    int count = 0;
+    interrupt.on_trigger([&count](bool) { count++; });
+
+    // Exercise
+    time.advance(10ms);
+    pin.fail = true;
+    time.advance(2ms);
+
+    // Verify
+    expect(that % 0 == count);
+    expect(that % 2U == poller.read_errors());
+  };
+
+  "pin_poller stops once every pin is gone"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    auto poller = pin_poller::create(timer, 1ms).value();
+    settable_pin pin;
+    int count = 0;
+
+    // Exercise
+    {
+      auto interrupt = polled_interrupt_pin::create(poller, pin).value();
+      auto moved = std::move(interrupt);
+      moved.on_trigger([&count](bool) { count++; });
+      pin.state = true;
+      time.advance(1ms);
+    }
+    const bool running = timer.is_running().value().is_running;
+    pin.state = false;
+    time.advance(5ms);
+
+    // Verify
+    expect(that % 1 == count);
+    expect(!running);
+    expect(that % 0U == time.pending());
+  };
+
+  "pin_poller limits the number of pins"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    auto poller = pin_poller::create(timer, 1ms).value();
+    settable_pin pin;
+    std::vector<polled_interrupt_pin> interrupts;
+    interrupts.reserve(pin_poller::max_pins);
+    for (std::size_t i = 0; i < pin_poller::max_pins; i++) {
+      interrupts.push_back(polled_interrupt_pin::create(poller, pin).value());
+    }
+
+    // Exercise
+    auto overflow = polled_interrupt_pin::create(poller, pin);
+    auto invalid_period = pin_poller::create(timer, 0ms);
+
+    // Verify
+    expect(!bool{ overflow });
+    expect(!bool{ invalid_period });
+  };
+};
+}  // namespace hal::soft
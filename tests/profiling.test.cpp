@@ -0,0 +1,101 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/profiling.hpp>
+
+#include <libhal-soft/simulated_time.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void profiling_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+  using histogram = latency_histogram<3, 32>;
+
+  "latency_histogram buckets contain their values"_test = []() {
+    // Setup
+    bool all_contained = true;
+
+    // Exercise
+    for (std::uint64_t value = 0; value < 100'000; value++) {
+      const auto bucket = histogram::bucket_of(value);
+      const auto upper = histogram::upper_bound(bucket);
+      const auto lower = (bucket == 0) ? 0 : histogram::upper_bound(bucket - 1);
+      if (value > upper || (bucket != 0 && value <= lower)) {
+        all_contained = false;
+      }
+      // Buckets are at most 1/8 of their values wide
+      if (upper - value > value / 8) {
+        all_contained = false;
+      }
+    }
+
+    // Verify
+    expect(all_contained);
+    expect(that % (histogram::bucket_count - 1) ==
+           histogram::bucket_of(std::uint64_t{ 1 } << 40));
+    expect(that % 0xFFFF'FFFFU ==
+           histogram::upper_bound(histogram::bucket_count - 1));
+  };
+
+  "latency_histogram summary"_test = []() {
+    // Setup
+    histogram test;
+
+    // Exercise
+    for (std::uint64_t value = 1; value <= 1000; value++) {
+      test.record(value);
+    }
+    const auto summary = test.summary();
+    test.reset();
+    const auto after_reset = test.summary();
+
+    // Verify
+    expect(that % 1000U == summary.count);
+    expect(that % 1U == summary.minimum);
+    expect(that % 1000U == summary.maximum);
+    expect(that % 500U == summary.mean);
+    expect(summary.p50 >= 500U && summary.p50 <= 500U + 500U / 8);
+    expect(summary.p90 >= 900U && summary.p90 <= 900U + 900U / 8);
+    expect(summary.p99 >= 990U && summary.p99 <= 1000U);
+    expect(that % 0U == after_reset.count);
+    expect(that % 0U == test.percentile(50.0f));
+  };
+
+  "scoped_timer records scope duration"_test = []() {
+    // Setup
+    auto time = simulated_time::create(1'000'000.0f, 1us).value();
+    auto clock = simulated_steady_clock::create(time).value();
+    histogram test;
+
+    // Exercise
+    {
+      scoped_timer timer(clock, test);
+      time.advance(250us);
+    }
+    {
+      scoped_timer timer(clock, test);
+      time.advance(10us);
+    }
+    const auto summary = test.summary();
+
+    // Verify
+    expect(that % 2U == summary.count);
+    expect(that % 11U == summary.minimum);
+    expect(that % 251U == summary.maximum);
+  };
+}
+}  // namespace hal::soft
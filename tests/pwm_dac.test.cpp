@@ -0,0 +1,203 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/pwm_dac.hpp>
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include <libhal-soft/simulated_time.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+class recording_pwm : public hal::pwm
+{
+public:
+  hal::hertz frequency_set = 0.0f;
+  std::vector<float> duty_cycles;
+
+private:
+  result<frequency_t> driver_frequency(hal::hertz p_frequency) override
+  {
+    frequency_set = p_frequency;
+    return frequency_t{};
+  }
+
+  result<duty_cycle_t> driver_duty_cycle(float p_duty_cycle) override
+  {
+    duty_cycles.push_back(p_duty_cycle);
+    return duty_cycle_t{};
+  }
+};
+}  // namespace
+
+void pwm_dac_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "pwm_dac maps percentages onto the duty cycle range"_test = []() {
+    // Setup
+    recording_pwm pwm;
+    auto dac = pwm_dac::create(pwm,
+                               { .frequency = 10'000.0f,
+                                 .minimum_duty_cycle = 0.1f,
+                                 .maximum_duty_cycle = 0.9f })
+                 .value();
+
+    // Exercise
+    (void)dac.write(0.5f);
+    (void)dac.write(0.0f);
+    (void)dac.write(2.0f);
+
+    // Verify
+    expect(that % 10'000.0f == pwm.frequency_set);
+    expect(that % 3U == pwm.duty_cycles.size());
+    expect(std::abs(0.5f - pwm.duty_cycles[0]) < 1e-6f);
+    expect(that % 0.1f == pwm.duty_cycles[1]);
+    expect(that % 0.9f == pwm.duty_cycles[2]);
+  };
+
+  "pwm_dac dithers between hardware steps"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_pwm pwm;
+    auto dac = pwm_dac::create(pwm,
+                               timer,
+                               pwm_dac::settings{},
+                               { .steps = 4, .period = 100us })
+                 .value();
+
+    // Exercise
+    // 1.25 hardware steps
+    (void)dac.write(0.3125f);
+    time.advance(1999us);
+    const auto& duty_cycles = pwm.duty_cycles;
+    const auto average =
+      std::accumulate(duty_cycles.begin(), duty_cycles.end(), 0.0f) /
+      static_cast<float>(duty_cycles.size());
+
+    // Verify
+    expect(that % 20U == duty_cycles.size());
+    expect(that % 0.3125f == average);
+    for (auto duty_cycle : duty_cycles) {
+      expect(duty_cycle == 0.25f || duty_cycle == 0.5f);
+    }
+  };
+
+  "pwm_dac stops dithering on an exact step"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_pwm pwm;
+    auto dac = pwm_dac::create(pwm,
+                               timer,
+                               pwm_dac::settings{},
+                               { .steps = 4, .period = 100us })
+                 .value();
+    (void)dac.write(0.6f);
+    time.advance(1ms);
+
+    // Exercise
+    (void)dac.write(0.75f);
+    time.advance(1ms);
+    const auto writes = pwm.duty_cycles.size();
+    time.advance(1ms);
+
+    // Verify
+    expect(that % 0U == time.pending());
+    expect(that % writes == pwm.duty_cycles.size());
+    expect(that % 0.75f == pwm.duty_cycles.back());
+  };
+
+  "pwm_dac maps the whole range of a 16-bit PWM"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_pwm pwm;
+    auto dac = pwm_dac::create(pwm,
+                               timer,
+                               { .minimum_duty_cycle = 0.75f,
+                                 .maximum_duty_cycle = 0.25f },
+                               { .steps = 65535, .period = 100us })
+                 .value();
+
+    // Exercise
+    (void)dac.write(0.0f);
+    const auto bottom = pwm.duty_cycles.back();
+    const auto bottom_pending = time.pending();
+    (void)dac.write(1.0f);
+    time.advance(100us);
+    const auto top = pwm.duty_cycles.back();
+    const auto top_pending = time.pending();
+
+    // Verify
+    // 0.75 and 0.25 of 65535 steps are 49151.25 and 16383.75 steps
+    expect(std::abs(49151.0f / 65535.0f - bottom) < 1e-6f);
+    expect(that % 1U == bottom_pending);
+    expect(std::abs(16383.0f / 65535.0f - top) < 1e-6f ||
+           std::abs(16384.0f / 65535.0f - top) < 1e-6f);
+    expect(that % 1U == top_pending);
+  };
+
+  "pwm_dac stops dithering when destroyed"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_pwm pwm;
+
+    // Exercise
+    {
+      auto created = pwm_dac::create(pwm,
+                                     timer,
+                                     pwm_dac::settings{},
+                                     { .steps = 4, .period = 100us })
+                       .value();
+      auto dac = std::move(created);
+      (void)dac.write(0.3125f);
+      time.advance(250us);
+    }
+    const auto writes = pwm.duty_cycles.size();
+    time.advance(1ms);
+
+    // Verify
+    expect(that % 3U == writes);
+    expect(that % writes == pwm.duty_cycles.size());
+    expect(that % 0U == time.pending());
+  };
+
+  "pwm_dac rejects invalid settings"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_pwm pwm;
+
+    // Exercise
+    auto duty_cycle = pwm_dac::create(pwm, { .maximum_duty_cycle = 1.5f });
+    auto steps =
+      pwm_dac::create(pwm, timer, pwm_dac::settings{}, { .steps = 0 });
+    auto too_many_steps =
+      pwm_dac::create(pwm, timer, pwm_dac::settings{}, { .steps = 1 << 16 });
+
+    // Verify
+    expect(!bool{ duty_cycle });
+    expect(!bool{ steps });
+    expect(!bool{ too_many_steps });
+  };
+};
+}  // namespace hal::soft
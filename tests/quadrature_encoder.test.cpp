@@ -0,0 +1,158 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/quadrature_encoder.hpp>
+
+#include <array>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+class manual_interrupt_pin : public hal::interrupt_pin
+{
+public:
+  void set(bool p_level)
+  {
+    m_handler(p_level);
+  }
+
+  settings last_settings{};
+
+private:
+  status driver_configure(const settings& p_settings) override
+  {
+    last_settings = p_settings;
+    return hal::success();
+  }
+
+  void driver_on_trigger(hal::callback<handler> p_handler) override
+  {
+    m_handler = p_handler;
+  }
+
+  hal::callback<handler> m_handler = [](bool) {};
+};
+}  // namespace
+
+void quadrature_encoder_test()
+{
+  using namespace boost::ut;
+
+  "quadrature_encoder counts both directions"_test = []() {
+    // Setup
+    auto encoder = quadrature_encoder::create(400).value();
+    // A leads B: 00 -> 10 -> 11 -> 01 -> 00
+    constexpr std::array<std::array<bool, 2>, 4> forward{ {
+      { true, false },
+      { true, true },
+      { false, true },
+      { false, false },
+    } };
+    // B leads A: 00 -> 01 -> 11 -> 10 -> 00
+    constexpr std::array<std::array<bool, 2>, 4> backward{ {
+      { false, true },
+      { true, true },
+      { true, false },
+      { false, false },
+    } };
+
+    // Exercise
+    for (int turn = 0; turn < 50; turn++) {
+      for (const auto& state : forward) {
+        encoder.update(state[0], state[1]);
+      }
+    }
+    const auto after_forward = encoder.count();
+    const auto angle = encoder.read().value().angle;
+    for (int turn = 0; turn < 75; turn++) {
+      for (const auto& state : backward) {
+        encoder.update(state[0], state[1]);
+      }
+    }
+
+    // Verify
+    expect(that % 200 == after_forward);
+    expect(that % 180.0f == angle);
+    expect(that % -100 == encoder.count());
+    expect(that % -90.0f == encoder.read().value().angle);
+  };
+
+  "quadrature_encoder ignores invalid and repeated states"_test = []() {
+    // Setup
+    auto encoder = quadrature_encoder::create(4).value();
+
+    // Exercise
+    encoder.update(true, true);
+    encoder.update(true, true);
+    encoder.update(false, false);
+    encoder.update(true, false);
+
+    // Verify
+    expect(that % 1 == encoder.count());
+  };
+
+  "quadrature_encoder decodes interrupt pins and survives moves"_test = []() {
+    // Setup
+    manual_interrupt_pin channel_a;
+    manual_interrupt_pin channel_b;
+    auto created = quadrature_encoder::create(channel_a, channel_b, 8).value();
+    auto encoder = std::move(created);
+
+    // Exercise
+    channel_a.set(true);
+    channel_b.set(true);
+    channel_a.set(false);
+    channel_b.set(false);
+    channel_a.set(true);
+    encoder.reset(encoder.count() + 10);
+    channel_a.set(false);
+
+    // Verify
+    expect(that % 14 == encoder.count());
+    expect(hal::interrupt_pin::trigger_edge::both ==
+           channel_a.last_settings.trigger);
+    expect(hal::interrupt_pin::trigger_edge::both ==
+           channel_b.last_settings.trigger);
+  };
+
+  "quadrature_encoder detaches from its pins when destroyed"_test = []() {
+    // Setup
+    manual_interrupt_pin channel_a;
+    manual_interrupt_pin channel_b;
+    std::int64_t count = 0;
+
+    // Exercise
+    {
+      auto encoder =
+        quadrature_encoder::create(channel_a, channel_b, 8).value();
+      channel_a.set(true);
+      count = encoder.count();
+    }
+    channel_b.set(true);
+    channel_a.set(false);
+
+    // Verify
+    expect(that % 1 == count);
+  };
+
+  "quadrature_encoder rejects zero counts per revolution"_test = []() {
+    // Exercise
+    auto result = quadrature_encoder::create(0);
+
+    // Verify
+    expect(!bool{ result });
+  };
+};
+}  // namespace hal::soft
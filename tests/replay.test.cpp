@@ -0,0 +1,293 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/replay.hpp>
+
+#include <array>
+#include <vector>
+
+#include <libhal-soft/inert_drivers/inert_accelerometer.hpp>
+#include <libhal-soft/inert_drivers/inert_adc.hpp>
+#include <libhal-soft/inert_drivers/inert_i2c.hpp>
+#include <libhal-soft/inert_drivers/inert_input_pin.hpp>
+#include <libhal-soft/inert_drivers/inert_serial.hpp>
+#include <libhal-soft/mapped_file.hpp>
+
+#if defined(__linux__)
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#endif
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+class collecting_serial : public hal::serial
+{
+public:
+  std::vector<hal::byte> bytes;
+
+private:
+  status driver_configure(const settings&) override
+  {
+    return hal::success();
+  }
+
+  result<write_t> driver_write(std::span<const hal::byte> p_data) override
+  {
+    bytes.insert(bytes.end(), p_data.begin(), p_data.end());
+    return write_t{ p_data };
+  }
+
+  result<read_t> driver_read(std::span<hal::byte> p_data) override
+  {
+    return read_t{ .data = p_data.first(0), .available = 0, .capacity = 0 };
+  }
+
+  result<flush_t> driver_flush() override
+  {
+    return flush_t{};
+  }
+};
+
+auto never_timeout()
+{
+  return []() -> status { return hal::success(); };
+}
+}  // namespace
+
+void replay_test()
+{
+  using namespace boost::ut;
+
+  "replay plays back interleaved sensor recordings"_test = []() {
+    // Setup
+    std::array<hal::byte, 256> buffer{};
+    auto recorder = trace_recorder::create(buffer).value();
+    auto real_adc = inert_adc::create(adc::read_t{ 0.75f }).value();
+    auto real_accelerometer =
+      inert_accelerometer::create({ .x = 1.0f, .y = -2.0f, .z = 9.8f })
+        .value();
+    auto recorded_adc =
+      recording<hal::adc>::create(real_adc, recorder, 1).value();
+    auto recorded_accelerometer =
+      recording<hal::accelerometer>::create(real_accelerometer, recorder, 2)
+        .value();
+
+    // Exercise
+    (void)recorded_adc.read();
+    (void)recorded_accelerometer.read();
+    (void)recorded_adc.read();
+    auto player = trace_player::create(recorder.recorded()).value();
+    auto adc = replay<hal::adc>::create(player, 1).value();
+    auto accelerometer = replay<hal::accelerometer>::create(player, 2).value();
+    auto acceleration = accelerometer.read();
+    auto first = adc.read();
+    auto second = adc.read();
+    auto exhausted = adc.read();
+    auto accelerometer_exhausted = accelerometer.read();
+
+    // Verify
+    expect(that % 0U == recorder.dropped());
+    expect(that % (trace_recorder::header_size + 3 * 6 + 4 + 12 + 4) ==
+           recorder.recorded().size());
+    expect(bool{ acceleration });
+    expect(that % 1.0f == acceleration.value().x);
+    expect(that % -2.0f == acceleration.value().y);
+    expect(that % 9.8f == acceleration.value().z);
+    expect(bool{ first });
+    expect(that % 0.75f == first.value().sample);
+    expect(bool{ second });
+    expect(that % 0.75f == second.value().sample);
+    expect(!bool{ exhausted });
+    expect(!bool{ accelerometer_exhausted });
+  };
+
+  "replay plays back bus reads"_test = []() {
+    // Setup
+    std::array<hal::byte, 256> buffer{};
+    auto recorder = trace_recorder::create(buffer).value();
+    std::array<hal::byte, 3> i2c_responses{ 0x10, 0x20, 0x30 };
+    auto real_i2c = inert_i2c::create_replay(i2c_responses).value();
+    auto real_pin = inert_input_pin::create({ .state = true }).value();
+    auto recorded_i2c =
+      recording<hal::i2c>::create(real_i2c, recorder, 1).value();
+    auto recorded_pin =
+      recording<hal::input_pin>::create(real_pin, recorder, 2).value();
+    std::array<hal::byte, 1> address{ 0x05 };
+    std::array<hal::byte, 2> first_in{};
+    std::array<hal::byte, 1> second_in{};
+
+    // Exercise
+    (void)recorded_i2c.transaction(0x50, address, first_in, never_timeout());
+    (void)recorded_pin.level();
+    (void)recorded_i2c.transaction(0x50, address, second_in, never_timeout());
+    auto player = trace_player::create(recorder.recorded()).value();
+    auto i2c = replay<hal::i2c>::create(player, 1).value();
+    auto pin = replay<hal::input_pin>::create(player, 2).value();
+    std::array<hal::byte, 2> replay_first{};
+    std::array<hal::byte, 2> wrong_size{};
+    auto first = i2c.transaction(0x50, address, replay_first, never_timeout());
+    auto mismatch = i2c.transaction(0x50, address, wrong_size, never_timeout());
+    auto level = pin.level();
+
+    // Verify
+    expect(bool{ first });
+    expect(that % 0x10 == replay_first[0]);
+    expect(that % 0x20 == replay_first[1]);
+    expect(!bool{ mismatch });
+    expect(bool{ level });
+    expect(level.value().state);
+  };
+
+  "replay plays back serial reads and recorded failures"_test = []() {
+    // Setup
+    std::array<hal::byte, 128> buffer{};
+    auto recorder = trace_recorder::create(buffer).value();
+    std::array<hal::byte, 5> message{ 'h', 'e', 'l', 'l', 'o' };
+    recorder.append(3, trace_call::serial_read, false, message);
+    recorder.append(3, trace_call::serial_read, true, {});
+    recorder.append(4, trace_call::adc_read, true, {});
+    auto player = trace_player::create(recorder.recorded()).value();
+    auto serial = replay<hal::serial>::create(player, 3).value();
+    auto adc = replay<hal::adc>::create(player, 4).value();
+    auto wrong_call = replay<hal::temperature_sensor>::create(player, 3);
+    std::array<hal::byte, 8> read_buffer{};
+
+    // Exercise
+    auto first = serial.read(read_buffer);
+    auto failed = serial.read(read_buffer);
+    auto failed_adc = adc.read();
+    auto mismatch = wrong_call.value().read();
+
+    // Verify
+    expect(bool{ first });
+    expect(that % 5U == first.value().data.size());
+    expect(that % 'o' == first.value().data[4]);
+    expect(!bool{ failed });
+    expect(!bool{ failed_adc });
+    expect(!bool{ mismatch });
+  };
+
+  "trace_recorder truncates once full"_test = []() {
+    // Setup
+    std::array<hal::byte, trace_recorder::header_size + 12> buffer{};
+    auto recorder = trace_recorder::create(buffer).value();
+    std::array<hal::byte, 4> payload{};
+    std::array<hal::byte, 3> too_small{};
+
+    // Exercise
+    const bool first = recorder.append(1, trace_call::adc_read, false, payload);
+    const bool second =
+      recorder.append(1, trace_call::adc_read, false, payload);
+    const bool after_full = recorder.append(1, trace_call::adc_read, true, {});
+    auto invalid = trace_recorder::create(too_small);
+
+    // Verify
+    expect(first);
+    expect(!second);
+    expect(!after_full);
+    expect(that % 2U == recorder.dropped());
+    expect(that % (trace_recorder::header_size + 10) ==
+           recorder.recorded().size());
+    expect(!bool{ invalid });
+  };
+
+  "trace_recorder flushes a complete trace in pieces"_test = []() {
+    // Setup
+    std::array<hal::byte, 32> buffer{};
+    auto recorder = trace_recorder::create(buffer).value();
+    collecting_serial port;
+    std::array<hal::byte, 4> payload{};
+
+    // Exercise
+    for (int i = 0; i < 6; i++) {
+      payload[0] = static_cast<hal::byte>(i);
+      if (recorder.available() < trace_recorder::entry_header_size + 4) {
+        (void)recorder.flush(port);
+      }
+      recorder.append(1, trace_call::adc_read, false, payload);
+    }
+    (void)recorder.flush(port);
+    auto player = trace_player::create(port.bytes).value();
+    std::size_t cursor = 0;
+    std::vector<hal::byte> first_bytes;
+    while (true) {
+      auto entry = player.next(1, trace_call::adc_read, cursor);
+      if (!entry) {
+        break;
+      }
+      first_bytes.push_back(entry.value().payload[0]);
+    }
+
+    // Verify
+    expect(that % 0U == recorder.dropped());
+    expect(that % 6U == first_bytes.size());
+    for (std::size_t i = 0; i < first_bytes.size(); i++) {
+      expect(that % i == first_bytes[i]);
+    }
+  };
+
+  "trace_player rejects malformed traces"_test = []() {
+    // Setup
+    std::array<hal::byte, 8> bad_magic{ 'N', 'O', 'P', 'E', 1, 0, 0, 0 };
+    std::array<hal::byte, 8> bad_version{ 'H', 'R', 'P', 'L', 9, 0, 0, 0 };
+    std::array<hal::byte, 11> truncated{ 'H', 'R', 'P', 'L', 1, 0, 0, 0,
+                                         1,   0,   0x01 };
+
+    // Exercise
+    auto magic_result = trace_player::create(bad_magic);
+    auto version_result = trace_player::create(bad_version);
+    auto player = trace_player::create(truncated).value();
+    std::size_t cursor = 0;
+    auto entry = player.next(1, trace_call::adc_read, cursor);
+
+    // Verify
+    expect(!bool{ magic_result });
+    expect(!bool{ version_result });
+    expect(!bool{ entry });
+  };
+
+#if defined(__linux__)
+  "mapped_file replays a trace from disk"_test = []() {
+    // Setup
+    std::array<hal::byte, 64> buffer{};
+    auto recorder = trace_recorder::create(buffer).value();
+    std::array<hal::byte, 4> payload{ 0x00, 0x00, 0x80, 0x3F };  // 1.0f
+    recorder.append(7, trace_call::adc_read, false, payload);
+    std::array<char, 32> path{ "/tmp/replay_testXXXXXX" };
+    const int descriptor = ::mkstemp(path.data());
+    const auto trace = recorder.recorded();
+    const auto written = ::write(descriptor, trace.data(), trace.size());
+    ::close(descriptor);
+
+    // Exercise
+    auto file = mapped_file::create(path.data());
+    auto missing = mapped_file::create("/nonexistent/replay/trace");
+    auto player = trace_player::create(file.value().data()).value();
+    auto adc = replay<hal::adc>::create(player, 7).value();
+    auto sample = adc.read();
+    ::unlink(path.data());
+
+    // Verify
+    expect(that % static_cast<long>(trace.size()) == written);
+    expect(bool{ file });
+    expect(!bool{ missing });
+    expect(bool{ sample });
+    expect(that % 1.0f == sample.value().sample);
+  };
+#endif
+};
+}  // namespace hal::soft
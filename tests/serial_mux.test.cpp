@@ -0,0 +1,204 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/serial_mux.hpp>
+
+#include <algorithm>
+#include <optional>
+
+#include <libhal-soft/inert_drivers/inert_serial.hpp>
+
+#include <boost/ut.hpp>
+
+namespace {
+/// Loops writes back to reads while counting the writes made to the port
+struct counting_serial : public hal::serial
+{
+  counting_serial(hal::serial& p_loopback)
+    : loopback(&p_loopback)
+  {
+  }
+
+  hal::serial* loopback;
+  int write_count = 0;
+
+private:
+  hal::status driver_configure(const settings& p_settings) final
+  {
+    return loopback->configure(p_settings);
+  }
+
+  hal::result<write_t> driver_write(std::span<const hal::byte> p_data) final
+  {
+    write_count++;
+    return loopback->write(p_data);
+  }
+
+  hal::result<read_t> driver_read(std::span<hal::byte> p_data) final
+  {
+    return loopback->read(p_data);
+  }
+
+  hal::result<flush_t> driver_flush() final
+  {
+    return loopback->flush();
+  }
+};
+}  // namespace
+
+namespace hal::soft {
+void serial_mux_test()
+{
+  using namespace boost::ut;
+
+  "hal::soft::serial_mux_channel::create()"_test = []() {
+    // Setup
+    std::array<hal::byte, 64> storage{};
+    std::array<hal::byte, 32> transmit_buffer{};
+    std::array<hal::byte, 32> frame_buffer{};
+    std::array<hal::byte, 8> receive0{};
+    std::array<hal::byte, 8> stage0{};
+    std::array<hal::byte, 8> stage1{};
+    std::array<hal::byte, 1> too_small{};
+    std::array<hal::byte, 64> too_large{};
+    auto port = inert_serial::create_loopback(storage).value();
+    auto mux =
+      serial_mux::create(port, transmit_buffer, frame_buffer).value();
+
+    // Exercise
+    auto channel0 = serial_mux_channel::create(mux, 0, receive0, stage0);
+    auto reused = serial_mux_channel::create(mux, 0, receive0, stage1);
+    auto out_of_range = serial_mux_channel::create(
+      mux, serial_mux::max_channels, receive0, stage1);
+    auto small = serial_mux_channel::create(mux, 1, receive0, too_small);
+    auto large = serial_mux_channel::create(mux, 1, receive0, too_large);
+
+    // Verify
+    expect(bool{ channel0 });
+    expect(!reused);
+    expect(!out_of_range);
+    expect(!small);
+    expect(!large);
+  };
+
+  "hal::soft::serial_mux routes channels"_test = []() {
+    // Setup
+    std::array<hal::byte, 256> storage{};
+    std::array<hal::byte, 64> transmit_buffer{};
+    std::array<hal::byte, 32> frame_buffer{};
+    std::array<hal::byte, 16> receive0{};
+    std::array<hal::byte, 16> receive1{};
+    std::array<hal::byte, 16> stage0{};
+    std::array<hal::byte, 16> stage1{};
+    std::array<hal::byte, 16> buffer{};
+    constexpr std::array<hal::byte, 3> telemetry{ 't', 0x00, 'm' };
+    constexpr std::array<hal::byte, 2> log{ 'l', 'g' };
+    auto loopback = inert_serial::create_loopback(storage).value();
+    auto port = counting_serial(loopback);
+    auto mux =
+      serial_mux::create(port, transmit_buffer, frame_buffer).value();
+    auto channel0 =
+      serial_mux_channel::create(mux, 0, receive0, stage0).value();
+    auto channel1 =
+      serial_mux_channel::create(mux, 1, receive1, stage1).value();
+
+    // Exercise
+    (void)channel0.write(std::span(telemetry).first(1));
+    (void)channel1.write(log);
+    (void)channel0.write(std::span(telemetry).subspan(1));
+    auto writes_before_transmit = port.write_count;
+    auto transmit_result = mux.transmit();
+    auto writes_after_transmit = port.write_count;
+    auto read1 = channel1.read(buffer).value();
+    auto read1_size = read1.data.size();
+    auto read1_first = buffer[0];
+    auto read0 = channel0.read(buffer).value();
+
+    // Verify
+    expect(bool{ transmit_result });
+    expect(that % 0 == writes_before_transmit);
+    // Both channels' frames go out in a single write
+    expect(that % 1 == writes_after_transmit);
+    expect(that % 2U == read1_size);
+    expect(that % 'l' == read1_first);
+    expect(that % 3U == read0.data.size());
+    expect(std::equal(telemetry.begin(), telemetry.end(), buffer.begin()));
+    expect(that % 0U == mux.dropped_frames());
+  };
+
+  "hal::soft::serial_mux transmits when staging fills"_test = []() {
+    // Setup
+    std::array<hal::byte, 256> storage{};
+    std::array<hal::byte, 64> transmit_buffer{};
+    std::array<hal::byte, 32> frame_buffer{};
+    std::array<hal::byte, 4> receive0{};
+    std::array<hal::byte, 4> stage0{};
+    std::array<hal::byte, 16> buffer{};
+    constexpr std::array<hal::byte, 6> data{ 1, 2, 3, 4, 5, 6 };
+    auto port = inert_serial::create_loopback(storage).value();
+    auto mux =
+      serial_mux::create(port, transmit_buffer, frame_buffer).value();
+    auto channel0 =
+      serial_mux_channel::create(mux, 0, receive0, stage0).value();
+
+    // Exercise
+    (void)channel0.write(data);
+    (void)mux.transmit();
+    auto read = channel0.read(buffer).value();
+
+    // Verify
+    // Staging holds 3 bytes, so the data went out as 3 + 3 bytes and the
+    // second frame did not fit into the 4 byte receive buffer.
+    expect(that % 3U == read.data.size());
+    expect(that % 1 == buffer[0]);
+    expect(that % 3 == buffer[2]);
+    expect(that % 1U == mux.dropped_frames());
+  };
+
+  "hal::soft::serial_mux_channel frees its slot"_test = []() {
+    // Setup
+    std::array<hal::byte, 256> storage{};
+    std::array<hal::byte, 64> transmit_buffer{};
+    std::array<hal::byte, 32> frame_buffer{};
+    std::array<hal::byte, 16> receive0{};
+    std::array<hal::byte, 16> receive1{};
+    std::array<hal::byte, 16> stage0{};
+    std::array<hal::byte, 16> stage1{};
+    std::array<hal::byte, 16> buffer{};
+    constexpr std::array<hal::byte, 2> data{ 'h', 'i' };
+    auto port = inert_serial::create_loopback(storage).value();
+    auto mux =
+      serial_mux::create(port, transmit_buffer, frame_buffer).value();
+    auto channel1 =
+      serial_mux_channel::create(mux, 1, receive1, stage1).value();
+
+    // Exercise
+    auto moved = std::optional<serial_mux_channel>(
+      serial_mux_channel::create(mux, 0, receive0, stage0).value());
+    auto taken = serial_mux_channel::create(mux, 0, receive0, stage0);
+    (void)moved->write(data);
+    (void)mux.transmit();
+    moved.reset();
+    auto read = channel1.read(buffer).value();
+    auto reused = serial_mux_channel::create(mux, 0, receive0, stage0);
+
+    // Verify
+    expect(!taken);
+    // The frame for the destroyed channel is dropped, not routed
+    expect(that % 0U == read.data.size());
+    expect(that % 1U == mux.dropped_frames());
+    expect(bool{ reused });
+  };
+};
+}  // namespace hal::soft
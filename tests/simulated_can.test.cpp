@@ -0,0 +1,154 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/simulated_can.hpp>
+
+#include <vector>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void simulated_can_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "simulated_can arbitrates by ID"_test = []() {
+    // Setup
+    auto bus = simulated_can_bus::create().value();
+    auto first = simulated_can_node::create(bus).value();
+    auto second = simulated_can_node::create(bus).value();
+    auto listener = simulated_can_node::create(bus).value();
+    std::vector<hal::can::id_t> heard;
+    int first_heard = 0;
+    (void)first.configure({});
+    (void)second.configure({});
+    (void)listener.configure({});
+    listener.on_receive([&heard](const hal::can::message_t& p_message) {
+      heard.push_back(p_message.id);
+    });
+    first.on_receive(
+      [&first_heard](const hal::can::message_t&) { first_heard++; });
+
+    // Exercise
+    (void)first.send({ .id = 0x300, .length = 0 });
+    (void)first.send({ .id = 0x100, .length = 0 });
+    (void)second.send({ .id = 0x200, .length = 0 });
+    const bool delivered_early = !heard.empty();
+    const auto transmitted = bus.run();
+
+    // Verify
+    expect(!delivered_early);
+    expect(that % 3U == transmitted);
+    expect(that % 3U == heard.size());
+    expect(that % 0x100U == heard[0]);
+    expect(that % 0x200U == heard[1]);
+    expect(that % 0x300U == heard[2]);
+    expect(that % 1 == first_heard);
+    expect(that % 0U == first.pending());
+  };
+
+  "simulated_can arbitrates on the base ID first"_test = []() {
+    // Setup
+    auto bus = simulated_can_bus::create().value();
+    auto first = simulated_can_node::create(bus).value();
+    auto second = simulated_can_node::create(bus).value();
+    auto listener = simulated_can_node::create(bus).value();
+    std::vector<hal::can::message_t> heard;
+    (void)first.configure({});
+    (void)second.configure({});
+    (void)listener.configure({});
+    listener.on_receive([&heard](const hal::can::message_t& p_message) {
+      heard.push_back(p_message);
+    });
+
+    // Exercise
+    // Extended ID with base ID 0x001
+    (void)first.send({ .id = 0x0004'0000, .length = 0 });
+    (void)second.send({ .id = 0x7FF, .length = 0 });
+    (void)first.send({ .id = 0x001, .length = 0, .is_remote_request = true });
+    (void)second.send({ .id = 0x001, .length = 0 });
+    (void)bus.run();
+
+    // Verify
+    expect(that % 4U == heard.size());
+    // Standard data, standard remote, then extended with the same base ID
+    expect(that % 0x001U == heard[0].id);
+    expect(!heard[0].is_remote_request);
+    expect(that % 0x001U == heard[1].id);
+    expect(heard[1].is_remote_request);
+    expect(that % 0x0004'0000U == heard[2].id);
+    expect(that % 0x7FFU == heard[3].id);
+  };
+
+  "simulated_can mailboxes"_test = []() {
+    // Setup
+    auto bus = simulated_can_bus::create().value();
+    auto node = simulated_can_node::create(bus).value();
+    auto offline = simulated_can_node::create(bus).value();
+    (void)node.bus_on();
+
+    // Exercise
+    auto offline_result = offline.send({ .id = 0x1, .length = 0 });
+    for (std::size_t i = 0; i < simulated_can_node::mailbox_count; i++) {
+      (void)node.send({ .id = 0x10, .length = 0 });
+    }
+    auto full_result = node.send({ .id = 0x10, .length = 0 });
+    bus.step();
+    auto freed_result = node.send({ .id = 0x10, .length = 0 });
+
+    // Verify
+    expect(!bool{ offline_result });
+    expect(!bool{ full_result });
+    expect(bool{ freed_result });
+    expect(that % simulated_can_node::mailbox_count == node.pending());
+  };
+
+  "simulated_can bus timing"_test = []() {
+    // Setup
+    auto bus = simulated_can_bus::create(1'000'000.0f).value();
+    auto ping = simulated_can_node::create(bus).value();
+    auto pong = simulated_can_node::create(bus).value();
+    (void)ping.configure({});
+    (void)pong.configure({});
+    // 8 byte standard frames are 111 bits, so 111us at 1 Mbit/s
+    static constexpr hal::can::message_t message{ .id = 0x10, .length = 8 };
+    ping.on_receive([&ping](const hal::can::message_t&) {
+      (void)ping.send(message);
+    });
+    pong.on_receive([&pong](const hal::can::message_t&) {
+      (void)pong.send(message);
+    });
+    (void)ping.send(message);
+
+    // Exercise
+    const auto transmitted = bus.run_for(1ms);
+    const auto transmitted_later = bus.run_for(1ms);
+
+    // Verify
+    expect(that % 9U == transmitted);
+    expect(that % 9U == transmitted_later);
+    expect(that % 18U == bus.frames_transmitted());
+    expect(that % 2ms == bus.now());
+  };
+
+  "simulated_can rejects negative bitrate"_test = []() {
+    // Exercise
+    auto result = simulated_can_bus::create(-1.0f);
+
+    // Verify
+    expect(!bool{ result });
+  };
+}
+}  // namespace hal::soft
@@ -0,0 +1,138 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/simulated_time.hpp>
+
+#include <vector>
+
+#include <libhal-util/steady_clock.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void simulated_time_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "simulated_time fires timers in deadline order"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto first = simulated_timer::create(time).value();
+    auto second = simulated_timer::create(time).value();
+    auto third = simulated_timer::create(time).value();
+    std::vector<int> order;
+    std::vector<hal::time_duration> fired_at;
+    auto record = [&](int p_id) {
+      return [&, p_id]() {
+        order.push_back(p_id);
+        fired_at.push_back(time.now());
+      };
+    };
+
+    // Exercise
+    (void)first.schedule(record(1), 30ms);
+    (void)second.schedule(record(2), 10ms);
+    (void)third.schedule(record(3), 10ms);
+    time.advance(5ms);
+    const auto fired_early = order.size();
+    time.advance(20ms);
+    const bool first_running = first.is_running().value().is_running;
+    time.advance(1s);
+
+    // Verify
+    expect(that % 0U == fired_early);
+    expect(first_running);
+    expect(that % 3U == order.size());
+    expect(that % 2 == order[0]);
+    expect(that % 3 == order[1]);
+    expect(that % 1 == order[2]);
+    expect(that % 10ms == fired_at[0]);
+    expect(that % 10ms == fired_at[1]);
+    expect(that % 30ms == fired_at[2]);
+    expect(that % 1025ms == time.now());
+    expect(that % 0U == time.pending());
+  };
+
+  "simulated_time run_next and periodic timers"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto periodic = simulated_timer::create(time).value();
+    int count = 0;
+    hal::callback<void(void)> tick = [&]() {
+      count++;
+      (void)periodic.schedule(tick, 20ms);
+    };
+    (void)periodic.schedule(tick, 20ms);
+
+    // Exercise
+    for (int i = 0; i < 100; i++) {
+      time.run_next();
+    }
+
+    // Verify
+    expect(that % 100 == count);
+    expect(that % 2s == time.now());
+  };
+
+  "simulated_time clock reads advance time"_test = []() {
+    // Setup
+    auto time = simulated_time::create(10'000'000.0f, 100ns).value();
+    auto clock = simulated_steady_clock::create(time).value();
+    auto timer = simulated_timer::create(time).value();
+    hal::time_duration fired_at{};
+    (void)timer.schedule([&]() { fired_at = time.now(); }, 300ns);
+
+    // Exercise
+    hal::delay(clock, 500ns);
+
+    // Verify
+    expect(that % 10'000'000.0f == clock.frequency().operating_frequency);
+    expect(that % 300ns == fired_at);
+    expect(that % 600ns == time.now());
+  };
+
+  "simulated_time cancel and destruction"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto cancelled = simulated_timer::create(time).value();
+    int fired = 0;
+
+    // Exercise
+    (void)cancelled.schedule([&fired]() { fired++; }, 1ms);
+    (void)cancelled.cancel();
+    {
+      auto destroyed = simulated_timer::create(time).value();
+      (void)destroyed.schedule([&fired]() { fired++; }, 1ms);
+    }
+    auto original = simulated_timer::create(time).value();
+    (void)original.schedule([&fired]() { fired++; }, 1ms);
+    auto moved = std::move(original);
+    const bool ran = time.run_next();
+
+    // Verify
+    expect(ran);
+    expect(that % 1 == fired);
+    expect(!time.run_next());
+  };
+
+  "simulated_time rejects invalid frequency"_test = []() {
+    // Exercise
+    auto result = simulated_time::create(0.0f);
+
+    // Verify
+    expect(!bool{ result });
+  };
+}
+}  // namespace hal::soft
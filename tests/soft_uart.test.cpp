@@ -0,0 +1,228 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/soft_uart.hpp>
+
+#include <queue>
+
+#include <libhal-mock/input_pin.hpp>
+#include <libhal-mock/output_pin.hpp>
+
+#include <boost/ut.hpp>
+
+namespace {
+/// Timer whose scheduled callback is run by the test
+struct manual_timer : public hal::timer
+{
+  /// Run the scheduled callback, if there is one
+  bool run()
+  {
+    if (!scheduled) {
+      return false;
+    }
+    scheduled = false;
+    callback();
+    return true;
+  }
+
+  hal::callback<void(void)> callback;
+  hal::time_duration delay{};
+  bool scheduled = false;
+
+private:
+  hal::result<is_running_t> driver_is_running() final
+  {
+    return is_running_t{ .is_running = scheduled };
+  }
+
+  hal::result<cancel_t> driver_cancel() final
+  {
+    scheduled = false;
+    return cancel_t{};
+  }
+
+  hal::result<schedule_t> driver_schedule(hal::callback<void(void)> p_callback,
+                                          hal::time_duration p_delay) final
+  {
+    callback = p_callback;
+    delay = p_delay;
+    scheduled = true;
+    return schedule_t{};
+  }
+};
+
+/// Interrupt pin whose handler is triggered by the test
+struct manual_interrupt_pin : public hal::interrupt_pin
+{
+  hal::callback<handler> handler_callback = [](bool) {};
+  settings configured{};
+
+private:
+  hal::status driver_configure(const settings& p_settings) final
+  {
+    configured = p_settings;
+    return hal::success();
+  }
+
+  void driver_on_trigger(hal::callback<handler> p_callback) final
+  {
+    handler_callback = p_callback;
+  }
+};
+
+/// Queue the line levels of a frame, least significant bit first
+void queue_frame(std::queue<hal::input_pin::level_t>& p_queue,
+                 std::uint16_t p_frame,
+                 int p_bits)
+{
+  for (int i = 0; i < p_bits; i++) {
+    p_queue.push(hal::input_pin::level_t{ .state = bool(p_frame & (1 << i)) });
+  }
+}
+}  // namespace
+
+namespace hal::soft {
+void soft_uart_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "hal::soft::soft_uart transmit"_test = []() {
+    // Setup
+    hal::mock::output_pin tx;
+    manual_interrupt_pin rx_edge;
+    hal::mock::input_pin rx;
+    manual_timer tx_timer;
+    manual_timer rx_timer;
+    std::array<hal::byte, 4> transmit_buffer{};
+    std::array<hal::byte, 4> receive_buffer{};
+    constexpr std::array<hal::byte, 2> data{ 0x35, 0xC3 };
+    auto uart = soft_uart::create(tx,
+                                  rx_edge,
+                                  rx,
+                                  tx_timer,
+                                  rx_timer,
+                                  transmit_buffer,
+                                  receive_buffer)
+                  .value();
+
+    // Exercise
+    auto configure_result = uart.configure({ .baud_rate = 1'000'000 });
+    auto write_result = uart.write(data);
+    int callbacks = 0;
+    while (tx_timer.run()) {
+      callbacks++;
+    }
+
+    // Verify
+    expect(bool{ configure_result });
+    expect(that % 2U == write_result.value().data.size());
+    expect(that % 1000 == tx_timer.delay.count());
+    // 2 frames of 10 bits plus the callback that finds the queue empty
+    expect(that % 20 == callbacks);
+    const auto& history = tx.spy_level.call_history();
+    expect(that % 21U == history.size());
+    // Idle high from configure(), then start bit and 0x35 LSB first, then stop
+    constexpr std::array<bool, 11> expected{ true,  false, true,  false,
+                                             true,  false, true,  true,
+                                             false, false, true };
+    for (std::size_t i = 0; i < expected.size(); i++) {
+      expect(that % expected[i] == std::get<0>(history.at(i)).state);
+    }
+  };
+
+  "hal::soft::soft_uart receive"_test = []() {
+    // Setup
+    hal::mock::output_pin tx;
+    manual_interrupt_pin rx_edge;
+    hal::mock::input_pin rx;
+    manual_timer tx_timer;
+    manual_timer rx_timer;
+    std::array<hal::byte, 4> transmit_buffer{};
+    std::array<hal::byte, 4> receive_buffer{};
+    std::array<hal::byte, 4> buffer{};
+    std::queue<hal::input_pin::level_t> levels;
+    // 0xA7 with even parity (5 ones, so parity is 1) and one stop bit
+    queue_frame(levels, 0b1'1'1010'0111'0, 11);
+    // 0x12 with a bad parity bit
+    queue_frame(levels, 0b1'1'0001'0010'0, 11);
+    rx.set(levels);
+    auto uart = soft_uart::create(tx,
+                                  rx_edge,
+                                  rx,
+                                  tx_timer,
+                                  rx_timer,
+                                  transmit_buffer,
+                                  receive_buffer)
+                  .value();
+    using parity = decltype(hal::serial::settings::parity);
+
+    // Exercise
+    auto configure_result =
+      uart.configure({ .baud_rate = 9600, .parity = parity::even });
+    rx_edge.handler_callback(false);
+    auto first_delay = rx_timer.delay;
+    // Further edges within the frame are ignored
+    rx_edge.handler_callback(false);
+    while (rx_timer.run()) {
+    }
+    rx_edge.handler_callback(false);
+    while (rx_timer.run()) {
+    }
+    auto read_result = uart.read(buffer);
+
+    // Verify
+    expect(bool{ configure_result });
+    expect(hal::interrupt_pin::trigger_edge::falling ==
+           rx_edge.configured.trigger);
+    expect(that % 52083 == first_delay.count());
+    expect(that % 104166 == rx_timer.delay.count());
+    expect(that % 1U == read_result.value().data.size());
+    expect(that % 0xA7 == buffer[0]);
+    expect(that % 1U == uart.receive_errors());
+  };
+
+  "hal::soft::soft_uart stops when destroyed"_test = []() {
+    // Setup
+    hal::mock::output_pin tx;
+    manual_interrupt_pin rx_edge;
+    hal::mock::input_pin rx;
+    manual_timer tx_timer;
+    manual_timer rx_timer;
+    std::array<hal::byte, 4> transmit_buffer{};
+    std::array<hal::byte, 4> receive_buffer{};
+    constexpr std::array<hal::byte, 1> data{ 0x35 };
+
+    // Exercise
+    {
+      auto uart = soft_uart::create(tx,
+                                    rx_edge,
+                                    rx,
+                                    tx_timer,
+                                    rx_timer,
+                                    transmit_buffer,
+                                    receive_buffer)
+                    .value();
+      (void)uart.configure({ .baud_rate = 9600 });
+      (void)uart.write(data);
+      rx_edge.handler_callback(false);
+    }
+    rx_edge.handler_callback(false);
+
+    // Verify
+    expect(!tx_timer.scheduled);
+    expect(!rx_timer.scheduled);
+  };
+};
+}  // namespace hal::soft
@@ -0,0 +1,307 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/timer_wheel.hpp>
+
+#include <array>
+#include <vector>
+
+#include <boost/ut.hpp>
+
+namespace {
+/// Timer whose scheduled callback is run by the test
+struct manual_timer : public hal::timer
+{
+  /// Run the scheduled callback, if there is one
+  bool run()
+  {
+    if (!scheduled) {
+      return false;
+    }
+    scheduled = false;
+    callback();
+    return true;
+  }
+
+  hal::callback<void(void)> callback;
+  hal::time_duration delay{};
+  bool scheduled = false;
+
+private:
+  hal::result<is_running_t> driver_is_running() final
+  {
+    return is_running_t{ .is_running = scheduled };
+  }
+
+  hal::result<cancel_t> driver_cancel() final
+  {
+    scheduled = false;
+    return cancel_t{};
+  }
+
+  hal::result<schedule_t> driver_schedule(hal::callback<void(void)> p_callback,
+                                          hal::time_duration p_delay) final
+  {
+    callback = p_callback;
+    delay = p_delay;
+    scheduled = true;
+    return schedule_t{};
+  }
+};
+
+/// 1 MHz steady clock advanced by the test
+struct manual_clock : public hal::steady_clock
+{
+  std::uint64_t ticks = 0;
+
+private:
+  frequency_t driver_frequency() final
+  {
+    return frequency_t{ .operating_frequency = 1'000'000.0f };
+  }
+
+  uptime_t driver_uptime() final
+  {
+    return uptime_t{ .ticks = ticks };
+  }
+};
+
+/// Let time pass until the hardware timer fires, then run its callback
+bool fire(manual_timer& p_timer, manual_clock& p_clock)
+{
+  if (!p_timer.scheduled) {
+    return false;
+  }
+  p_clock.ticks += static_cast<std::uint64_t>(p_timer.delay.count() / 1000);
+  return p_timer.run();
+}
+}  // namespace
+
+namespace hal::soft {
+void timer_wheel_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "timer_wheel arms for nearest deadline"_test = []() {
+    // Setup
+    manual_timer hardware;
+    manual_clock clock;
+    auto wheel = timer_wheel::create(hardware, clock, 1ms).value();
+    auto slow = wheel_timer::create(wheel).value();
+    auto fast = wheel_timer::create(wheel).value();
+    std::vector<std::uint64_t> slow_fired;
+    std::vector<std::uint64_t> fast_fired;
+
+    // Exercise
+    (void)slow.schedule([&]() { slow_fired.push_back(clock.ticks); }, 5ms);
+    const auto first_delay = hardware.delay;
+    (void)fast.schedule([&]() { fast_fired.push_back(clock.ticks); }, 2ms);
+    const auto second_delay = hardware.delay;
+    fire(hardware, clock);
+    const auto third_delay = hardware.delay;
+    fire(hardware, clock);
+    const bool idle = !hardware.scheduled;
+
+    // Verify
+    expect(that % 5ms == first_delay);
+    expect(that % 2ms == second_delay);
+    expect(that % 3ms == third_delay);
+    expect(idle);
+    expect(that % 1U == fast_fired.size());
+    expect(that % 1U == slow_fired.size());
+    expect(that % 2000U == fast_fired[0]);
+    expect(that % 5000U == slow_fired[0]);
+    expect(!bool{ slow.is_running().value().is_running });
+  };
+
+  "timer_wheel cancel"_test = []() {
+    // Setup
+    manual_timer hardware;
+    manual_clock clock;
+    auto wheel = timer_wheel::create(hardware, clock, 1ms).value();
+    auto test = wheel_timer::create(wheel).value();
+    int fired = 0;
+
+    // Exercise
+    (void)test.schedule([&fired]() { fired++; }, 3ms);
+    const bool running = test.is_running().value().is_running;
+    (void)test.cancel();
+    const bool running_after_cancel = test.is_running().value().is_running;
+    fire(hardware, clock);
+
+    // Verify
+    expect(running);
+    expect(!running_after_cancel);
+    expect(that % 0 == fired);
+    expect(!hardware.scheduled);
+  };
+
+  "timer_wheel cascades long delays"_test = []() {
+    // Setup
+    manual_timer hardware;
+    manual_clock clock;
+    auto wheel = timer_wheel::create(hardware, clock, 1ms).value();
+    auto test = wheel_timer::create(wheel).value();
+    std::uint64_t fired_at = 0;
+    int wakeups = 0;
+
+    // Exercise
+    (void)test.schedule([&]() { fired_at = clock.ticks; }, 300'123ms);
+    while (fire(hardware, clock)) {
+      wakeups++;
+    }
+
+    // Verify
+    expect(that % 300'123'000U == fired_at);
+    expect(that % wakeups <= 4);
+  };
+
+  "timer_wheel periodic rescheduling"_test = []() {
+    // Setup
+    manual_timer hardware;
+    manual_clock clock;
+    auto wheel = timer_wheel::create(hardware, clock, 1ms).value();
+    auto test = wheel_timer::create(wheel).value();
+    std::vector<std::uint64_t> fired;
+    hal::callback<void(void)> periodic = [&]() {
+      fired.push_back(clock.ticks);
+      if (fired.size() < 50) {
+        (void)test.schedule(periodic, 3ms);
+      }
+    };
+
+    // Exercise
+    (void)test.schedule(periodic, 3ms);
+    while (fire(hardware, clock)) {
+    }
+
+    // Verify
+    expect(that % 50U == fired.size());
+    for (std::size_t i = 0; i < fired.size(); i++) {
+      expect(that % ((i + 1) * 3000U) == fired[i]);
+    }
+  };
+
+  "timer_wheel many timers fire in order"_test = []() {
+    // Setup
+    manual_timer hardware;
+    manual_clock clock;
+    auto wheel = timer_wheel::create(hardware, clock, 1ms).value();
+    std::vector<wheel_timer> timers;
+    std::vector<std::uint64_t> deadlines;
+    std::vector<std::uint64_t> fired;
+    std::vector<std::uint64_t> fired_deadlines;
+    for (std::uint64_t i = 0; i < 200; i++) {
+      timers.push_back(wheel_timer::create(wheel).value());
+    }
+
+    // Exercise
+    for (std::uint64_t i = 0; i < timers.size(); i++) {
+      const std::uint64_t delay_ms = 1 + (i * 7919) % 20'000;
+      deadlines.push_back(delay_ms * 1000);
+      (void)timers[i].schedule(
+        [&, delay_ms]() {
+          fired.push_back(clock.ticks);
+          fired_deadlines.push_back(delay_ms * 1000);
+        },
+        std::chrono::milliseconds(delay_ms));
+    }
+    while (fire(hardware, clock)) {
+    }
+
+    // Verify
+    expect(that % timers.size() == fired.size());
+    for (std::size_t i = 0; i < fired.size(); i++) {
+      expect(that % fired_deadlines[i] == fired[i]);
+      if (i > 0) {
+        expect(fired[i - 1] <= fired[i]);
+      }
+    }
+  };
+
+  "timer_wheel moving a scheduled timer"_test = []() {
+    // Setup
+    manual_timer hardware;
+    manual_clock clock;
+    auto wheel = timer_wheel::create(hardware, clock, 1ms).value();
+    auto original = wheel_timer::create(wheel).value();
+    auto neighbour = wheel_timer::create(wheel).value();
+    int fired = 0;
+    (void)neighbour.schedule([&fired]() { fired++; }, 4ms);
+    (void)original.schedule([&fired]() { fired++; }, 4ms);
+
+    // Exercise
+    auto moved = std::move(original);
+    const bool original_running = original.is_running().value().is_running;
+    const bool moved_running = moved.is_running().value().is_running;
+    fire(hardware, clock);
+
+    // Verify
+    expect(!original_running);
+    expect(moved_running);
+    expect(that % 2 == fired);
+  };
+
+  "timer_wheel rejects out of range delays"_test = []() {
+    // Setup
+    manual_timer hardware;
+    manual_clock clock;
+    auto wheel = timer_wheel::create(hardware, clock, 1ms).value();
+    auto test = wheel_timer::create(wheel).value();
+
+    // Exercise
+    auto in_range = test.schedule([]() {}, wheel.max_delay());
+    auto out_of_range = test.schedule([]() {}, wheel.max_delay() + 1ms);
+    auto bad_wheel = timer_wheel::create(hardware, clock, 1ns);
+
+    // Verify
+    expect(bool{ in_range });
+    expect(!bool{ out_of_range });
+    expect(!bool{ bad_wheel });
+  };
+
+  "timer_wheel schedules short delays after idling"_test = []() {
+    // Setup
+    manual_timer hardware;
+    manual_clock clock;
+    auto wheel = timer_wheel::create(hardware, clock, 10us).value();
+    auto test = wheel_timer::create(wheel).value();
+    int fired = 0;
+    (void)test.schedule([&]() { fired++; }, 100us);
+    fire(hardware, clock);
+
+    // Exercise
+    clock.ticks += 200'000'000;
+    const bool idle_longer = wheel.max_delay() < 200s;
+    auto after_idle = test.schedule([&]() { fired++; }, 100us);
+    const auto delay = hardware.delay;
+    fire(hardware, clock);
+    // Wake up to a cancelled timer, then idle again
+    (void)test.schedule([&]() { fired++; }, 100us);
+    (void)test.cancel();
+    fire(hardware, clock);
+    clock.ticks += 200'000'000;
+    auto after_cancel = test.schedule([&]() { fired++; }, 100us);
+    fire(hardware, clock);
+
+    // Verify
+    expect(idle_longer);
+    expect(bool{ after_idle });
+    expect(that % 100us == delay);
+    expect(bool{ after_cancel });
+    expect(that % 3 == fired);
+  };
+}
+}  // namespace hal::soft
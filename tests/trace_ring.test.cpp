@@ -0,0 +1,189 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/trace_ring.hpp>
+
+#include <array>
+#include <vector>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+class recording_serial : public hal::serial
+{
+public:
+  std::vector<hal::byte> bytes;
+  std::size_t writes = 0;
+
+private:
+  status driver_configure(const settings&) override
+  {
+    return hal::success();
+  }
+
+  result<write_t> driver_write(std::span<const hal::byte> p_data) override
+  {
+    writes++;
+    bytes.insert(bytes.end(), p_data.begin(), p_data.end());
+    return write_t{ p_data };
+  }
+
+  result<read_t> driver_read(std::span<hal::byte> p_data) override
+  {
+    return read_t{ .data = p_data.first(0), .available = 0, .capacity = 0 };
+  }
+
+  result<flush_t> driver_flush() override
+  {
+    return flush_t{};
+  }
+};
+
+trace_record make_record(std::uint32_t p_argument)
+{
+  return trace_record{
+    .start = 1000U * p_argument,
+    .duration = p_argument + 1,
+    .argument = p_argument,
+    .source = 7,
+    .call = trace_call::serial_write,
+    .status = static_cast<std::uint8_t>(p_argument % 2),
+  };
+}
+}  // namespace
+
+void trace_ring_test()
+{
+  using namespace boost::ut;
+
+  "trace_ring rejects storage that is not a power of two"_test = []() {
+    // Setup
+    std::array<trace_record, 6> storage{};
+    std::array<trace_record, 0> empty{};
+
+    // Exercise
+    auto result = trace_ring::create(storage);
+    auto empty_result = trace_ring::create(empty);
+
+    // Verify
+    expect(!bool{ result });
+    expect(!bool{ empty_result });
+  };
+
+  "trace_ring keeps records in order"_test = []() {
+    // Setup
+    std::array<trace_record, 8> storage{};
+    auto ring = trace_ring::create(storage).value();
+    std::array<trace_record, 8> output{};
+
+    // Exercise
+    for (std::uint32_t i = 0; i < 3; i++) {
+      ring.push(make_record(i));
+    }
+    auto records = ring.snapshot(output);
+
+    // Verify
+    expect(that % 3U == ring.pushed());
+    expect(that % 3U == records.size());
+    for (std::uint32_t i = 0; i < records.size(); i++) {
+      expect(that % (i + 1) == records[i].sequence);
+      expect(that % i == records[i].argument);
+      expect(that % (1000U * i) == records[i].start);
+      expect(that % 7 == records[i].source);
+    }
+  };
+
+  "trace_ring overwrites the oldest records"_test = []() {
+    // Setup
+    std::array<trace_record, 4> storage{};
+    auto ring = trace_ring::create(storage).value();
+    std::array<trace_record, 2> small_output{};
+    std::array<trace_record, 8> output{};
+
+    // Exercise
+    for (std::uint32_t i = 0; i < 10; i++) {
+      ring.push(make_record(i));
+    }
+    auto records = ring.snapshot(output);
+    auto oldest = ring.snapshot(small_output);
+    ring.clear();
+    auto cleared = ring.snapshot(output);
+
+    // Verify
+    expect(that % 4U == records.size());
+    expect(that % 7U == records[0].sequence);
+    expect(that % 6U == records[0].argument);
+    expect(that % 10U == records[3].sequence);
+    expect(that % 9U == records[3].argument);
+    expect(that % 2U == oldest.size());
+    expect(that % 7U == oldest[0].sequence);
+    expect(that % 0U == cleared.size());
+    expect(that % 0U == ring.pushed());
+  };
+
+  "trace_ring dump round trips through decode"_test = []() {
+    // Setup
+    std::array<trace_record, 16> storage{};
+    auto ring = trace_ring::create(storage).value();
+    recording_serial port;
+    for (std::uint32_t i = 0; i < 20; i++) {
+      ring.push(make_record(i));
+    }
+
+    // Exercise
+    auto result = ring.dump(port, 1'000'000.0f);
+    auto header = trace_ring::decode_header(
+      std::span(port.bytes).first<trace_ring::header_size>());
+
+    // Verify
+    expect(bool{ result });
+    expect(bool{ header });
+    constexpr auto dump_size =
+      trace_ring::header_size + 16 * trace_ring::record_size;
+    expect(that % dump_size == port.bytes.size());
+    // One header write then two batches of eight records
+    expect(that % 3U == port.writes);
+    expect(that % trace_ring::format_version == header.value().version);
+    expect(that % trace_ring::record_size == header.value().record_size);
+    expect(that % 1'000'000.0f == header.value().frequency);
+    expect(that % 16U == header.value().record_count);
+    for (std::size_t i = 0; i < 16; i++) {
+      auto record = trace_ring::decode(
+        std::span(port.bytes)
+          .subspan(trace_ring::header_size + i * trace_ring::record_size)
+          .first<trace_ring::record_size>());
+      const auto expected = make_record(static_cast<std::uint32_t>(i + 4));
+      expect(that % (i + 5) == record.sequence);
+      expect(that % expected.start == record.start);
+      expect(that % expected.duration == record.duration);
+      expect(that % expected.argument == record.argument);
+      expect(that % expected.source == record.source);
+      expect(expected.call == record.call);
+      expect(that % expected.status == record.status);
+    }
+  };
+
+  "trace_ring decode_header rejects bad magic"_test = []() {
+    // Setup
+    std::array<hal::byte, trace_ring::header_size> bytes{ 'N', 'O', 'P', 'E' };
+
+    // Exercise
+    auto result = trace_ring::decode_header(bytes);
+
+    // Verify
+    expect(!bool{ result });
+  };
+};
+}  // namespace hal::soft
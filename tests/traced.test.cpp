@@ -0,0 +1,166 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/traced.hpp>
+
+#include <array>
+#include <bit>
+
+#include <libhal-soft/inert_drivers/inert_adc.hpp>
+#include <libhal-soft/inert_drivers/inert_can.hpp>
+#include <libhal-soft/inert_drivers/inert_i2c.hpp>
+#include <libhal-soft/simulated_time.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+void traced_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "traced<adc> records the sample read"_test = []() {
+    // Setup
+    std::array<trace_record, 8> storage{};
+    auto ring = trace_ring::create(storage).value();
+    auto time = simulated_time::create().value();
+    auto clock = simulated_steady_clock::create(time).value();
+    auto inner = inert_adc::create(adc::read_t{ 0.25f }).value();
+    auto adc = traced<hal::adc>::create(inner, tracer(ring, clock, 3)).value();
+    std::array<trace_record, 8> output{};
+
+    // Exercise
+    auto result = adc.read();
+    auto records = ring.snapshot(output);
+
+    // Verify
+    expect(bool{ result });
+    expect(that % 0.25f == result.value().sample);
+    expect(that % 1U == records.size());
+    expect(trace_call::adc_read == records[0].call);
+    expect(that % 0.25f == std::bit_cast<float>(records[0].argument));
+    expect(that % 3 == records[0].source);
+    expect(that % 0 == records[0].status);
+    expect(that % 1U == records[0].duration);
+  };
+
+  "traced<i2c> summarizes transactions"_test = []() {
+    // Setup
+    std::array<trace_record, 8> storage{};
+    auto ring = trace_ring::create(storage).value();
+    auto time = simulated_time::create().value();
+    auto clock = simulated_steady_clock::create(time).value();
+    std::array<hal::byte, 1> responses{ 0xAA };
+    auto inner = inert_i2c::create_replay(responses).value();
+    auto i2c = traced<hal::i2c>::create(inner, tracer(ring, clock, 1)).value();
+    std::array<hal::byte, 2> out{ 0x01, 0x02 };
+    std::array<hal::byte, 1> in{};
+    std::array<trace_record, 8> output{};
+    auto timeout = []() -> status { return hal::success(); };
+
+    // Exercise
+    auto first = i2c.transaction(0x42, out, in, timeout);
+    const auto first_byte = in[0];
+    auto second = i2c.transaction(0x42, out, in, timeout);
+    auto records = ring.snapshot(output);
+
+    // Verify
+    expect(bool{ first });
+    expect(bool{ second });
+    expect(that % 0xAA == first_byte);
+    expect(that % 2U == records.size());
+    expect(trace_call::i2c_transaction == records[0].call);
+    expect(that % 0x42'02'01U == records[0].argument);
+    expect(that % 0 == records[0].status);
+    expect(records[0].start < records[1].start);
+  };
+
+  "traced<can> traces sends and receive handlers"_test = []() {
+    // Setup
+    std::array<trace_record, 8> storage{};
+    auto ring = trace_ring::create(storage).value();
+    auto time = simulated_time::create().value();
+    auto clock = simulated_steady_clock::create(time).value();
+    auto inner = inert_can::create_loopback().value();
+    auto can = traced<hal::can>::create(inner, tracer(ring, clock, 2)).value();
+    int received = 0;
+    can.on_receive([&received](const can::message_t&) { received++; });
+    std::array<trace_record, 8> output{};
+
+    // Exercise
+    auto result = can.send(can::message_t{ .id = 0x123, .length = 0 });
+    auto records = ring.snapshot(output);
+
+    // Verify
+    expect(bool{ result });
+    expect(that % 1 == received);
+    expect(that % 2U == records.size());
+    // The receive handler runs, and finishes, inside of send()
+    expect(trace_call::can_receive == records[0].call);
+    expect(that % 0x123U == records[0].argument);
+    expect(trace_call::can_send == records[1].call);
+    expect(that % 0x123U == records[1].argument);
+    expect(records[1].start < records[0].start);
+    expect(records[1].duration > records[0].duration);
+  };
+
+  "traced records failed calls"_test = []() {
+    // Setup
+    std::array<trace_record, 8> storage{};
+    auto ring = trace_ring::create(storage).value();
+    auto time = simulated_time::create().value();
+    auto clock = simulated_steady_clock::create(time).value();
+    auto inner = inert_can::create(false).value();
+    auto can = traced<hal::can>::create(inner, tracer(ring, clock, 5)).value();
+    std::array<trace_record, 8> output{};
+
+    // Exercise
+    auto result = can.bus_on();
+    auto records = ring.snapshot(output);
+
+    // Verify
+    expect(!bool{ result });
+    expect(that % 1U == records.size());
+    expect(trace_call::can_bus_on == records[0].call);
+    expect(that % 1 == records[0].status);
+  };
+
+  "traced<timer> traces the scheduled callback"_test = []() {
+    // Setup
+    std::array<trace_record, 8> storage{};
+    auto ring = trace_ring::create(storage).value();
+    auto time = simulated_time::create().value();
+    auto clock = simulated_steady_clock::create(time).value();
+    auto inner = simulated_timer::create(time).value();
+    auto timer =
+      traced<hal::timer>::create(inner, tracer(ring, clock, 4)).value();
+    int fired = 0;
+    std::array<trace_record, 8> output{};
+
+    // Exercise
+    auto result = timer.schedule([&fired]() { fired++; }, 10ms);
+    time.advance(20ms);
+    auto records = ring.snapshot(output);
+
+    // Verify
+    expect(bool{ result });
+    expect(that % 1 == fired);
+    expect(that % 2U == records.size());
+    expect(trace_call::timer_schedule == records[0].call);
+    expect(that % 10'000U == records[0].argument);
+    expect(trace_call::timer_callback == records[1].call);
+    expect(that % 4 == records[1].source);
+  };
+};
+}  // namespace hal::soft
@@ -0,0 +1,234 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libhal-soft/waveform_generator.hpp>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <libhal-soft/simulated_time.hpp>
+
+#include <boost/ut.hpp>
+
+namespace hal::soft {
+namespace {
+class recording_dac : public hal::dac
+{
+public:
+  std::vector<std::uint16_t> samples;
+
+private:
+  result<write_t> driver_write(float p_percentage) override
+  {
+    samples.push_back(
+      static_cast<std::uint16_t>(std::lround(p_percentage * 65535.0f)));
+    return write_t{};
+  }
+};
+
+constexpr auto quarter_sine = make_sine_table<4>();
+static_assert(quarter_sine[0] == 32768 && quarter_sine[1] == 65535 &&
+              quarter_sine[2] == 32768 && quarter_sine[3] == 0);
+constexpr auto eighth_triangle = make_triangle_table<8>();
+static_assert(eighth_triangle[1] == 49151 && eighth_triangle[2] == 65535 &&
+              eighth_triangle[6] == 0 && eighth_triangle[7] == 16384);
+}  // namespace
+
+void waveform_generator_test()
+{
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "make_sine_table matches std::sin"_test = []() {
+    // Setup
+    constexpr auto table = make_sine_table<256>();
+    double worst = 0.0;
+
+    // Exercise
+    for (std::size_t i = 0; i < table.size(); i++) {
+      const auto angle = 2.0 * std::numbers::pi * static_cast<double>(i) /
+                         static_cast<double>(table.size());
+      const auto expected = 32767.5 + 32767.5 * std::sin(angle);
+      worst = std::max(worst, std::abs(expected - table[i]));
+    }
+
+    // Verify
+    expect(worst <= 0.5) << worst;
+  };
+
+  "waveform_generator steps through the table"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_dac dac;
+    auto generator = waveform_generator::create(
+                       dac,
+                       timer,
+                       quarter_sine,
+                       { .sample_rate = 1'000.0f, .frequency = 250.0f })
+                       .value();
+
+    // Exercise
+    (void)generator.start();
+    time.advance(8ms);
+
+    // Verify
+    const std::vector<std::uint16_t> expected{
+      32768, 65535, 32768, 0, 32768, 65535, 32768, 0
+    };
+    expect(expected == dac.samples);
+    expect(that % 0U == generator.phase());
+  };
+
+  "waveform_generator interpolates between entries"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_dac dac;
+    constexpr std::array<std::uint16_t, 2> ramp{ 0, 65535 };
+    auto generator = waveform_generator::create(dac,
+                                                timer,
+                                                ramp,
+                                                { .sample_rate = 1'000.0f,
+                                                  .frequency = 250.0f,
+                                                  .interpolate = true })
+                       .value();
+
+    // Exercise
+    (void)generator.start();
+    time.advance(4ms);
+
+    // Verify
+    const std::vector<std::uint16_t> expected{ 0, 32767, 65535, 32767 };
+    expect(expected == dac.samples);
+  };
+
+  "waveform_generator plays blocks and counts underruns"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_dac dac;
+    std::array<std::uint16_t, 4> block{};
+    auto generator = waveform_generator::create(
+                       dac,
+                       timer,
+                       quarter_sine,
+                       { .sample_rate = 1'000.0f, .frequency = 250.0f },
+                       block)
+                       .value();
+
+    // Exercise
+    const auto filled = generator.fill();
+    const auto refilled = generator.fill();
+    (void)generator.start();
+    time.advance(6ms);
+    const auto after_underrun = generator.fill();
+
+    // Verify
+    expect(that % 4U == filled);
+    expect(that % 0U == refilled);
+    expect(that % 4U == after_underrun);
+    expect(that % 2U == generator.underruns());
+    const std::vector<std::uint16_t> expected{ 32768, 65535, 32768, 0, 0, 0 };
+    expect(expected == dac.samples);
+  };
+
+  "waveform_generator keeps its phase across changes"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_dac dac;
+    constexpr auto table = make_sine_table<8>();
+    auto generator = waveform_generator::create(
+                       dac,
+                       timer,
+                       table,
+                       { .sample_rate = 1'000.0f, .frequency = 125.0f })
+                       .value();
+    (void)generator.start();
+    time.advance(2ms);
+
+    // Exercise
+    auto fast = generator.frequency(250.0f);
+    time.advance(1ms);
+    (void)generator.stop();
+    time.advance(5ms);
+    const auto stopped_writes = dac.samples.size();
+    (void)generator.start();
+    time.advance(1ms);
+
+    // Verify
+    expect(bool{ fast });
+    expect(that % 3U == stopped_writes);
+    expect(that % 4U == dac.samples.size());
+    // Phases 0 and 1/8 at 125Hz, then 1/4 and 1/2 at 250Hz
+    expect(that % 65535 == dac.samples[2]);
+    expect(that % 32768 == dac.samples[3]);
+  };
+
+  "waveform_generator stops when destroyed after a move"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_dac dac;
+
+    // Exercise
+    {
+      auto created = waveform_generator::create(
+                       dac,
+                       timer,
+                       quarter_sine,
+                       { .sample_rate = 1'000.0f, .frequency = 250.0f })
+                       .value();
+      (void)created.start();
+      auto generator = std::move(created);
+      time.advance(2ms);
+    }
+    time.advance(2ms);
+
+    // Verify
+    const std::vector<std::uint16_t> expected{ 32768, 65535 };
+    expect(expected == dac.samples);
+  };
+
+  "waveform_generator rejects invalid settings"_test = []() {
+    // Setup
+    auto time = simulated_time::create().value();
+    auto timer = simulated_timer::create(time).value();
+    recording_dac dac;
+    constexpr std::array<std::uint16_t, 3> odd_table{};
+    std::array<std::uint16_t, 3> odd_block{};
+
+    // Exercise
+    auto table = waveform_generator::create(dac, timer, odd_table, {});
+    auto nyquist = waveform_generator::create(
+      dac, timer, quarter_sine, { .sample_rate = 100.0f, .frequency = 50.0f });
+    auto rate = waveform_generator::create(
+      dac, timer, quarter_sine, { .sample_rate = 0.0f });
+    auto block = waveform_generator::create(
+      dac, timer, quarter_sine, waveform_generator::settings{}, odd_block);
+    auto generator =
+      waveform_generator::create(dac, timer, quarter_sine, {}).value();
+    auto negative = generator.frequency(-1.0f);
+
+    // Verify
+    expect(!bool{ table });
+    expect(!bool{ nyquist });
+    expect(!bool{ rate });
+    expect(!bool{ block });
+    expect(!bool{ negative });
+  };
+};
+}  // namespace hal::soft